@@ -0,0 +1,151 @@
+// Headless benchmark for frustum culling (whole scene, single vs multi-threaded), and for the AABB vs frustum kernels (scalar vs SIMD).
+// Does not need a window or a render core: the model assets are constructed directly with bounds, but no vertex or index buffers.
+//
+// Usage: CullingBenchmark [iterations]
+
+#include "Pikzel/Components/Model.h"
+#include "Pikzel/Core/ThreadPool.h"
+#include "Pikzel/Scene/AssetCache.h"
+#include "Pikzel/Scene/Culling.h"
+#include "Pikzel/Scene/Frustum.h"
+#include "Pikzel/Scene/Scene.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+
+using namespace Pikzel;
+
+
+std::unique_ptr<Scene> CreateBenchmarkScene(const size_t numObjects, const Id modelId) {
+   auto scene = std::make_unique<Scene>();
+
+   // scatter objects uniformly in a cube centred on the origin, sized so that density is the same regardless of object count
+   const float halfExtent = 10.0f * std::cbrt(static_cast<float>(numObjects));
+   std::mt19937 rng {12345};
+   std::uniform_real_distribution<float> position {-halfExtent, halfExtent};
+   std::uniform_real_distribution<float> angle {0.0f, glm::two_pi<float>()};
+
+   for (size_t i = 0; i < numObjects; ++i) {
+      Object object = scene->CreateEmptyObject();
+      glm::mat4 transform = glm::translate(glm::identity<glm::mat4>(), {position(rng), position(rng), position(rng)});
+      transform = glm::rotate(transform, angle(rng), glm::vec3 {0.0f, 1.0f, 0.0f});
+      scene->AddComponent<glm::mat4>(object, transform);
+      scene->AddComponent<Model>(object, modelId);
+   }
+   return scene;
+}
+
+
+std::shared_ptr<ModelAsset> CreateBenchmarkModel() {
+   // four meshes in a row, each a unit box
+   auto modelAsset = std::make_shared<ModelAsset>();
+   for (int i = 0; i < 4; ++i) {
+      Mesh& mesh = modelAsset->Meshes.emplace_back();
+      mesh.AABB = {glm::vec3 {i * 1.0f, 0.0f, 0.0f}, glm::vec3 {i * 1.0f + 1.0f, 1.0f, 1.0f}};
+      modelAsset->AABB = {glm::min(modelAsset->AABB.first, mesh.AABB.first), glm::max(modelAsset->AABB.second, mesh.AABB.second)};
+   }
+   return modelAsset;
+}
+
+
+// returns average milliseconds per call, and number of visible boxes
+template<typename Kernel>
+std::pair<double, size_t> BenchmarkKernel(Kernel kernel, const Frustum& frustum, const Culling::AABBs& aabbs, std::vector<uint8_t>& visible, const int iterations) {
+   visible.resize(aabbs.Size());
+   kernel(frustum, aabbs, 0, aabbs.Size(), visible.data());
+
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; ++i) {
+      kernel(frustum, aabbs, 0, aabbs.Size(), visible.data());
+   }
+   std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+   size_t count = 0;
+   for (const auto v : visible) {
+      count += v;
+   }
+   return {elapsed.count() / iterations, count};
+}
+
+
+// returns average milliseconds per cull, and number of visible meshes
+std::pair<double, size_t> Benchmark(Scene& scene, const glm::mat4& vp, ThreadPool& pool, const int iterations) {
+   std::vector<Culling::VisibleList> lists;
+   Culling::CullScene(scene, vp, lists, pool); // warm up (and allocate list storage)
+
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; ++i) {
+      Culling::CullScene(scene, vp, lists, pool);
+   }
+   std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+   size_t visible = 0;
+   for (const auto& list : lists) {
+      visible += list.meshes.size();
+   }
+   return {elapsed.count() / iterations, visible};
+}
+
+
+int main(int argc, const char* argv[]) {
+   Log::Init(argc, argv);
+
+   const int iterations = (argc > 1) ? std::max(std::atoi(argv[1]), 1) : 20;
+
+   const Id modelId = AssetCache::AddModelAsset("CullingBenchmark/Model", CreateBenchmarkModel());
+
+   const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 10000.0f, 0.1f); // reverse-Z
+   const glm::mat4 view = glm::lookAt(glm::vec3 {0.0f, 0.0f, 0.0f}, glm::vec3 {0.0f, 0.0f, -1.0f}, glm::vec3 {0.0f, 1.0f, 0.0f});
+   const glm::mat4 vp = projection * view;
+
+   ThreadPool singleThreaded {0};
+   ThreadPool& multiThreaded = ThreadPool::Get();
+
+   PKZL_LOG_INFO("Frustum culling benchmark. {} iterations, {} worker threads", iterations, multiThreaded.GetThreadCount());
+   PKZL_LOG_INFO("{:>10} {:>12} {:>12} {:>8} {:>10}", "objects", "1 thread ms", "N thread ms", "speedup", "visible");
+   for (const size_t numObjects : {10'000, 100'000, 1'000'000}) {
+      auto scene = CreateBenchmarkScene(numObjects, modelId);
+      auto [singleMs, singleVisible] = Benchmark(*scene, vp, singleThreaded, iterations);
+      auto [multiMs, multiVisible] = Benchmark(*scene, vp, multiThreaded, iterations);
+      if (singleVisible != multiVisible) {
+         PKZL_LOG_ERROR("Visible mesh counts differ! ({} vs {})", singleVisible, multiVisible);
+         return EXIT_FAILURE;
+      }
+      PKZL_LOG_INFO("{:>10} {:>12.3f} {:>12.3f} {:>7.2f}x {:>10}", numObjects, singleMs, multiMs, singleMs / multiMs, multiVisible);
+   }
+
+   PKZL_LOG_INFO("");
+   PKZL_LOG_INFO("AABB vs frustum kernel. SIMD instruction set: {}", Culling::GetSIMDName());
+   PKZL_LOG_INFO("{:>10} {:>12} {:>12} {:>8} {:>10}", "boxes", "scalar ms", "SIMD ms", "speedup", "visible");
+   const Frustum frustum {vp};
+   for (const size_t numBoxes : {10'000, 100'000, 1'000'000}) {
+      const float halfExtent = 10.0f * std::cbrt(static_cast<float>(numBoxes));
+      std::mt19937 rng {12345};
+      std::uniform_real_distribution<float> position {-halfExtent, halfExtent};
+      std::uniform_real_distribution<float> size {0.1f, 10.0f};
+      Culling::AABBs aabbs;
+      aabbs.Reserve(numBoxes);
+      for (size_t i = 0; i < numBoxes; ++i) {
+         glm::vec3 min = {position(rng), position(rng), position(rng)};
+         aabbs.Add({min, min + glm::vec3 {size(rng), size(rng), size(rng)}});
+      }
+
+      std::vector<uint8_t> scalarVisible;
+      std::vector<uint8_t> simdVisible;
+      auto [scalarMs, scalarCount] = BenchmarkKernel(Culling::TestAABBsScalar, frustum, aabbs, scalarVisible, iterations);
+      auto [simdMs, simdCount] = BenchmarkKernel(Culling::TestAABBs, frustum, aabbs, simdVisible, iterations);
+      if (scalarVisible != simdVisible) {
+         PKZL_LOG_ERROR("Scalar and SIMD kernels disagree! ({} vs {} visible)", scalarCount, simdCount);
+         return EXIT_FAILURE;
+      }
+      PKZL_LOG_INFO("{:>10} {:>12.3f} {:>12.3f} {:>7.2f}x {:>10}", numBoxes, scalarMs, simdMs, scalarMs / simdMs, simdCount);
+   }
+
+   AssetCache::Clear();
+   return EXIT_SUCCESS;
+}
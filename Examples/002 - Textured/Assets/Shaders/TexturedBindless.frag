@@ -0,0 +1,19 @@
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inTexCoord;
+
+layout(push_constant) uniform PC {
+   mat4 mvp;
+   uint textureIndex;
+} constants;
+
+layout (location = 0) out vec4 outFragColor;
+
+// The global texture table.  There is nothing to bind, the texture is fetched by its index in the table.
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+
+void main() {
+   outFragColor = texture(textures[constants.textureIndex], inTexCoord) * inColor;
+}
@@ -15,7 +15,11 @@ public:
    virtual void Render() override {
       Pikzel::GraphicsContext& gc = GetWindow().GetGraphicsContext();
       gc.Bind(*m_Pipeline);
-      gc.Bind("uTexture"_hs, *m_Texture);   // Technically, we don't have to bind the texture every frame (once it's bound, it stays bound).
+      if (m_IsBindless) {
+         gc.PushConstant("constants.textureIndex"_hs, m_Texture->GetBindlessIndex());
+      } else {
+         gc.Bind("uTexture"_hs, *m_Texture);   // Technically, we don't have to bind the texture every frame (once it's bound, it stays bound).
+      }
       gc.PushConstant("constants.mvp"_hs, glm::identity<glm::mat4>());
       gc.DrawTriangles(*m_VertexBuffer, 3);
    }
@@ -54,10 +58,13 @@ private:
 
 
    void CreatePipeline() {
+      // Where supported, textures are also in a global texture table, and a shader can fetch them from there by index instead of
+      // having them bound.  (useful when a draw needs lots of different textures, e.g. one per material)
+      m_IsBindless = Pikzel::RenderCore::SupportsBindlessTextures() && (m_Texture->GetBindlessIndex() != Pikzel::Texture::InvalidBindlessIndex);
       Pikzel::PipelineSettings settings {
          .shaders = {
             { Pikzel::ShaderType::Vertex, "Assets/" APP_NAME "/Shaders/Textured.vert.spv" },
-            { Pikzel::ShaderType::Fragment, "Assets/" APP_NAME "/Shaders/Textured.frag.spv" }
+            { Pikzel::ShaderType::Fragment, m_IsBindless ? "Assets/" APP_NAME "/Shaders/TexturedBindless.frag.spv" : "Assets/" APP_NAME "/Shaders/Textured.frag.spv" }
          },
          .bufferLayout = m_VertexBuffer->GetLayout()
       };
@@ -70,6 +77,7 @@ private:
    std::shared_ptr<Pikzel::VertexBuffer> m_VertexBuffer;
    std::unique_ptr<Pikzel::Texture> m_Texture;
    std::unique_ptr<Pikzel::Pipeline> m_Pipeline;
+   bool m_IsBindless = false;
 
 };
 
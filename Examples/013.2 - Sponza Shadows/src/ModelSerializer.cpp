@@ -1,6 +1,7 @@
 #include "ModelSerializer.h"
 
 #include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -120,6 +121,11 @@ namespace SponzaShadows {
             }
          }
 
+         // This demo is dominated by depth-only shadow passes, which are vertex bound, so reordering for the vertex cache is well worth it
+         if (pmesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+            indices = Pikzel::MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+         }
+
          Mesh mesh;
          mesh.VertexBuffer = Pikzel::RenderCore::CreateVertexBuffer(
             {
@@ -5,6 +5,7 @@
 
 #include <array>
 #include <format>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -145,13 +146,28 @@ protected:
 
          glm::mat4 transform = glm::identity<glm::mat4>();
          gc.PushConstant("constants.model"_hs, transform);
-         for (const auto& mesh : m_Model->Meshes) {
+
+         // POI: sort the meshes by material, and then front-to-back
+         m_RenderQueue.Clear();
+         for (uint32_t i = 0; i < m_Model->Meshes.size(); ++i) {
+            const auto& mesh = m_Model->Meshes[i];
+            const glm::vec3 centre = glm::vec3 {transform * mesh.Transform * glm::vec4 {(mesh.AABB.first + mesh.AABB.second) * 0.5f, 1.0f}};
+            m_RenderQueue.Add(Pikzel::RenderQueue::MakeKey(0, m_MeshMaterials[i], i, glm::distance(centre, m_Camera.position)), i);
+         }
+         m_RenderQueue.Sort();
+
+         uint32_t material = ~0;
+         for (const auto& item : m_RenderQueue.GetItems()) {
+            const auto& mesh = m_Model->Meshes[item.index];
             gc.PushConstant("constants.model"_hs, transform * mesh.Transform);
-            gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
-            gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
-            gc.Bind("uNormals"_hs, *mesh.NormalTexture);
-            gc.Bind("uAmbientOcclusion"_hs, *mesh.AmbientOcclusionTexture);
-            gc.Bind("uHeightMap"_hs, *mesh.HeightTexture);
+            if (Pikzel::RenderQueue::GetMaterial(item.key) != material) {
+               material = Pikzel::RenderQueue::GetMaterial(item.key);
+               gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
+               gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
+               gc.Bind("uNormals"_hs, *mesh.NormalTexture);
+               gc.Bind("uAmbientOcclusion"_hs, *mesh.AmbientOcclusionTexture);
+               gc.Bind("uHeightMap"_hs, *mesh.HeightTexture);
+            }
             gc.DrawIndexed(*mesh.VertexBuffer, *mesh.IndexBuffer);
          }
 
@@ -359,6 +375,15 @@ private:
 
       // POI: load model
       m_Model = SponzaPBR::ModelSerializer::Import("Assets/Models/Sponza/Sponza.gltf");
+
+      // POI: meshes that use the same set of textures share a material.
+      // The render queue sorts by material so that textures need only be bound when the material changes.
+      std::map<std::array<const Pikzel::Texture*, 5>, uint32_t> materials;
+      m_MeshMaterials.reserve(m_Model->Meshes.size());
+      for (const auto& mesh : m_Model->Meshes) {
+         const auto [material, inserted] = materials.try_emplace({mesh.AlbedoTexture.get(), mesh.MetallicRoughnessTexture.get(), mesh.NormalTexture.get(), mesh.AmbientOcclusionTexture.get(), mesh.HeightTexture.get()}, static_cast<uint32_t>(materials.size()));
+         m_MeshMaterials.emplace_back(material->second);
+      }
    }
 
 
@@ -621,6 +646,8 @@ private:
 
 
    std::unique_ptr<SponzaPBR::Model> m_Model;
+   std::vector<uint32_t> m_MeshMaterials;  // m_MeshMaterials[i] = material id of m_Model->Meshes[i]
+   Pikzel::RenderQueue m_RenderQueue;
    std::unique_ptr<Pikzel::VertexBuffer> m_VertexBuffer;
    std::unique_ptr<Pikzel::VertexBuffer> m_VertexBufferCube;
    std::unique_ptr<Pikzel::UniformBuffer> m_BufferMatrices;
@@ -2,6 +2,7 @@
 #include "Log.h"
 #include "Pikzel/Events/EventDispatcher.h"
 #include "Pikzel/Scene/AssetCache.h"
+#include "Pikzel/Scene/GeometryPool.h"
 
 namespace Pikzel {
 
@@ -39,6 +40,7 @@ namespace Pikzel {
       EventDispatcher::Disconnect<WindowCloseEvent, &Application::OnWindowClose>(*this);
       EventDispatcher::Disconnect<WindowResizeEvent, &Application::OnWindowResize>(*this);
       AssetCache::Clear();
+      GeometryPool::ReleaseAll(); // must be before RenderCore is shut down
    }
 
 
@@ -52,6 +54,9 @@ namespace Pikzel {
             glfwPollEvents();
          }
 
+         // pick up any models that have finished loading in the background
+         AssetCache::Update();
+
          if (!m_IsPaused) {
             const auto currentTime = std::chrono::steady_clock::now();
             {
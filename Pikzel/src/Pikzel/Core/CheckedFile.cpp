@@ -0,0 +1,50 @@
+#include "CheckedFile.h"
+
+#if defined(PKZL_PLATFORM_WINDOWS)
+#include <process.h>
+#elif defined(PKZL_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <stdexcept>
+
+namespace Pikzel {
+
+   static int CurrentProcessId() {
+#if defined(PKZL_PLATFORM_WINDOWS)
+      return _getpid();
+#else
+      return static_cast<int>(getpid());
+#endif
+   }
+
+
+   void WriteFileAtomic(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write) {
+      static std::atomic<uint32_t> s_TempCount = 0;
+      std::filesystem::path tempPath = path;
+      tempPath += std::format(".{}.{}.tmp", CurrentProcessId(), s_TempCount++);
+
+      if (path.has_parent_path()) {
+         std::filesystem::create_directories(path.parent_path());
+      }
+      try {
+         {
+            std::ofstream file {tempPath, std::ios::binary | std::ios::trunc};
+            if (!file) {
+               throw std::runtime_error {std::format("Could not open '{}' for writing", tempPath.string())};
+            }
+            write(file);
+            if (!file) {
+               throw std::runtime_error {std::format("Error writing '{}'", tempPath.string())};
+            }
+         }
+         std::filesystem::rename(tempPath, path);
+      } catch (...) {
+         std::error_code ec;
+         std::filesystem::remove(tempPath, ec);
+         throw;
+      }
+   }
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core.h"
+#include "Hash.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace Pikzel {
+
+   // Write a file by passing write() a stream to a temporary file next to path, and then renaming the temporary to path.
+   // A reader never sees a partially written file.  The temporary's name is unique to the writer, so processes (or threads)
+   // writing the same path at once do not clobber each other's output (the last rename wins).
+   // Throws std::runtime_error if the file cannot be written.
+   PKZL_API void WriteFileAtomic(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write);
+
+
+   // Files of derived data (e.g. caches) that are only used if they are intact are a fixed size Header followed by data.
+   // Header must have uint64_t dataSize and checksum members, which WriteCheckedFile() fills in.
+   template<typename Header>
+   void WriteCheckedFile(const std::filesystem::path& path, Header header, const std::span<const std::byte> data) {
+      header.dataSize = data.size();
+      header.checksum = HashBytes(data);
+      WriteFileAtomic(path, [&header, data] (std::ostream& file) {
+         file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+         file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+      });
+   }
+
+
+   // Read a file written by WriteCheckedFile(), filling in header.
+   // Returns the data, or nothing if the file does not exist, isHeaderValid(header) returns false (e.g. the file was written
+   // by a different version), or the file is corrupt (which is logged).
+   template<typename Header, typename IsHeaderValid>
+   std::optional<std::vector<uint8_t>> ReadCheckedFile(const std::filesystem::path& path, Header& header, IsHeaderValid&& isHeaderValid) {
+      std::ifstream file {path, std::ios::binary};
+      if (!file.is_open()) {
+         return {};
+      }
+      if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))) {
+         PKZL_CORE_LOG_WARN("'{0}' is truncated.  It will be rebuilt", path.string());
+         return {};
+      }
+      if (!isHeaderValid(header)) {
+         return {};
+      }
+
+      // the checksum does not cover the header, so check dataSize before trusting it with an allocation
+      std::error_code ec;
+      const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+      if (ec || (header.dataSize != fileSize - sizeof(Header))) {
+         PKZL_CORE_LOG_WARN("'{0}' is corrupt.  It will be rebuilt", path.string());
+         return {};
+      }
+
+      std::vector<uint8_t> data(header.dataSize);
+      if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())) || (HashBytes(std::as_bytes(std::span {data})) != header.checksum)) {
+         PKZL_CORE_LOG_WARN("'{0}' is corrupt.  It will be rebuilt", path.string());
+         return {};
+      }
+      return data;
+   }
+
+}
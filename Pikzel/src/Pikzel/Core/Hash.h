@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace Pikzel {
+
+   // FNV-1a, but taken a 64-bit word at a time (rather than a byte at a time) so that hashing large files is cheap.
+   // Used to detect that the source of a cooked asset has changed.  It is not trying to be a good general purpose hash.
+   inline uint64_t HashBytes(const std::span<const std::byte> bytes, uint64_t hash = 14695981039346656037ull) {
+      constexpr uint64_t prime = 1099511628211ull;
+      size_t i = 0;
+      for (; i + sizeof(uint64_t) <= bytes.size(); i += sizeof(uint64_t)) {
+         uint64_t word;
+         std::memcpy(&word, bytes.data() + i, sizeof(uint64_t));
+         hash = (hash ^ word) * prime;
+      }
+      for (; i < bytes.size(); ++i) {
+         hash = (hash ^ static_cast<uint64_t>(bytes[i])) * prime;
+      }
+      return hash;
+   }
+
+
+   template<typename T>
+   uint64_t HashValue(const T& value, const uint64_t hash) {
+      return HashBytes(std::as_bytes(std::span {&value, 1}), hash);
+   }
+
+}
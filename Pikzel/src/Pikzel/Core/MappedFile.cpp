@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+
+#if defined(PKZL_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdexcept>
+
+namespace Pikzel {
+
+#if defined(PKZL_PLATFORM_WINDOWS)
+
+   MappedFile::MappedFile(const std::filesystem::path& path) {
+      m_File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (m_File == INVALID_HANDLE_VALUE) {
+         throw std::runtime_error {std::format("Could not open file '{}'", path)};
+      }
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(m_File, &size)) {
+         CloseHandle(m_File);
+         throw std::runtime_error {std::format("Could not get size of file '{}'", path)};
+      }
+      m_Size = static_cast<size_t>(size.QuadPart);
+      if (m_Size == 0) {
+         return; // cannot map an empty file.  GetData() returns nullptr
+      }
+      m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (m_Mapping) {
+         m_Data = static_cast<const std::byte*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+      }
+      if (!m_Data) {
+         if (m_Mapping) {
+            CloseHandle(m_Mapping);
+         }
+         CloseHandle(m_File);
+         throw std::runtime_error {std::format("Could not map file '{}'", path)};
+      }
+   }
+
+
+   MappedFile::~MappedFile() {
+      if (m_Data) {
+         UnmapViewOfFile(m_Data);
+      }
+      if (m_Mapping) {
+         CloseHandle(m_Mapping);
+      }
+      CloseHandle(m_File);
+   }
+
+#elif defined(PKZL_PLATFORM_LINUX)
+
+   MappedFile::MappedFile(const std::filesystem::path& path) {
+      const int fd = open(path.c_str(), O_RDONLY);
+      if (fd == -1) {
+         throw std::runtime_error {std::format("Could not open file '{}'", path)};
+      }
+      struct stat info;
+      if (fstat(fd, &info) == -1) {
+         close(fd);
+         throw std::runtime_error {std::format("Could not get size of file '{}'", path)};
+      }
+      m_Size = static_cast<size_t>(info.st_size);
+      if (m_Size > 0) {
+         void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error {std::format("Could not map file '{}'", path)};
+         }
+         m_Data = static_cast<const std::byte*>(data);
+      }
+      close(fd); // the mapping keeps its own reference to the file
+   }
+
+
+   MappedFile::~MappedFile() {
+      if (m_Data) {
+         munmap(const_cast<std::byte*>(m_Data), m_Size);
+      }
+   }
+
+#endif
+
+
+   const std::byte* MappedFile::GetData() const {
+      return m_Data;
+   }
+
+
+   size_t MappedFile::GetSize() const {
+      return m_Size;
+   }
+
+
+   std::span<const std::byte> MappedFile::GetBytes() const {
+      return {m_Data, m_Data ? m_Size : 0};
+   }
+
+}
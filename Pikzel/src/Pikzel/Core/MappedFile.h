@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Core.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Pikzel {
+
+   // A read-only memory mapping of an entire file.
+   // Pages are brought in by the OS as they are touched, so there is no up-front read of the whole file.
+   class PKZL_API MappedFile final {
+   public:
+      // throws std::runtime_error if the file cannot be opened or mapped
+      MappedFile(const std::filesystem::path& path);
+      PKZL_NO_COPYMOVE(MappedFile);
+      ~MappedFile();
+
+      const std::byte* GetData() const;
+      size_t GetSize() const;
+
+      std::span<const std::byte> GetBytes() const;
+
+   private:
+      const std::byte* m_Data = nullptr;
+      size_t m_Size = 0;
+#if defined(PKZL_PLATFORM_WINDOWS)
+      HANDLE m_File = INVALID_HANDLE_VALUE;
+      HANDLE m_Mapping = nullptr;
+#endif
+   };
+
+}
@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace Pikzel {
+
+   ThreadPool::ThreadPool(const uint32_t numThreads) {
+      m_Threads.reserve(numThreads);
+      for (uint32_t i = 0; i < numThreads; ++i) {
+         m_Threads.emplace_back(&ThreadPool::WorkerThread, this);
+      }
+   }
+
+
+   ThreadPool::~ThreadPool() {
+      {
+         std::scoped_lock lock {m_Mutex};
+         m_Stop = true;
+      }
+      m_Condition.notify_all();
+      for (auto& thread : m_Threads) {
+         thread.join();
+      }
+   }
+
+
+   ThreadPool& ThreadPool::Get() {
+      // one thread per core, less one for the main thread.  hardware_concurrency() can be 1 (single core), or 0 (unknown)
+      static ThreadPool pool {std::max(std::thread::hardware_concurrency(), 2u) - 1};
+      return pool;
+   }
+
+
+   uint32_t ThreadPool::GetThreadCount() const {
+      return static_cast<uint32_t>(m_Threads.size());
+   }
+
+
+   size_t ThreadPool::ParallelFor(const size_t count, const size_t minChunkSize, const std::function<void(size_t, size_t, size_t)>& func) {
+      PKZL_PROFILE_FUNCTION();
+      if (count == 0) {
+         return 0;
+      }
+
+      const size_t minSize = std::max(minChunkSize, size_t(1));
+      const size_t maxChunks = std::min((count + minSize - 1) / minSize, static_cast<size_t>(GetThreadCount()) + 1);
+      const size_t chunkSize = (count + maxChunks - 1) / maxChunks;
+      const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+
+      std::vector<std::future<void>> futures;
+      futures.reserve(numChunks - 1);
+      for (size_t chunk = 1; chunk < numChunks; ++chunk) {
+         const size_t begin = chunk * chunkSize;
+         const size_t end = std::min(begin + chunkSize, count);
+         futures.emplace_back(Submit([&func, chunk, begin, end] { func(chunk, begin, end); }));
+      }
+
+      // all chunks must be finished before returning (they reference func), even if one of them throws
+      std::exception_ptr exception;
+      try {
+         func(0, 0, std::min(chunkSize, count));
+      } catch (...) {
+         exception = std::current_exception();
+      }
+      for (auto& future : futures) {
+         try {
+            future.get();
+         } catch (...) {
+            if (!exception) {
+               exception = std::current_exception();
+            }
+         }
+      }
+      if (exception) {
+         std::rethrow_exception(exception);
+      }
+      return numChunks;
+   }
+
+
+   void ThreadPool::Enqueue(std::function<void()> task) {
+      // a pool with no workers would never run the task (and callers waiting on Submit()ed work would hang), so run it here instead
+      if (m_Threads.empty()) {
+         task();
+         return;
+      }
+      {
+         std::scoped_lock lock {m_Mutex};
+         m_Tasks.emplace(std::move(task));
+      }
+      m_Condition.notify_one();
+   }
+
+
+   void ThreadPool::WorkerThread() {
+      for (;;) {
+         std::function<void()> task;
+         {
+            std::unique_lock lock {m_Mutex};
+            m_Condition.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
+            if (m_Stop && m_Tasks.empty()) {
+               return;
+            }
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop();
+         }
+         task();
+      }
+   }
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Pikzel {
+
+   // A fixed size pool of worker threads.
+   // Work is submitted as callables, and results are returned via std::future.
+   // A pool of zero threads runs submitted work immediately, on the submitting thread.
+   class PKZL_API ThreadPool final {
+   public:
+      ThreadPool(const uint32_t numThreads);
+      PKZL_NO_COPYMOVE(ThreadPool);
+      ~ThreadPool();
+
+      // The engine-wide shared pool.  Has one thread per hardware core, less one (for the main thread)
+      static ThreadPool& Get();
+
+      uint32_t GetThreadCount() const;
+
+      template<typename Func>
+      auto Submit(Func&& func) -> std::future<std::invoke_result_t<Func>> {
+         using result_type = std::invoke_result_t<Func>;
+         auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Func>(func));
+         std::future<result_type> result = task->get_future();
+         Enqueue([task] { (*task)(); });
+         return result;
+      }
+
+      // Splits the range [0, count) into (at most GetThreadCount() + 1) chunks of at least minChunkSize elements, and calls
+      // func(chunkIndex, begin, end) for each chunk.  The calling thread processes one of the chunks itself, and then
+      // blocks until all chunks are done.
+      // Returns the number of chunks (chunk indices are 0 to return value - 1)
+      // Do not call this from within a task running on the pool (it could deadlock)
+      size_t ParallelFor(const size_t count, const size_t minChunkSize, const std::function<void(size_t, size_t, size_t)>& func);
+
+   private:
+      void Enqueue(std::function<void()> task);
+      void WorkerThread();
+
+   private:
+      std::vector<std::thread> m_Threads;
+      std::queue<std::function<void()>> m_Tasks;
+      std::mutex m_Mutex;
+      std::condition_variable m_Condition;
+      bool m_Stop = false;
+   };
+
+}
@@ -11,8 +11,10 @@
 #include "Pikzel/Core/Application.h"
 #include "Pikzel/Core/Core.h"
 #include "Pikzel/Core/FileSystem.h"
+#include "Pikzel/Core/Hash.h"
 #include "Pikzel/Core/Instrumentor.h"
 #include "Pikzel/Core/Log.h"
+#include "Pikzel/Core/MappedFile.h"
 #include "Pikzel/Core/PlatformUtility.h"
 #include "Pikzel/Core/Utility.h"
 #include "Pikzel/Core/Window.h"
@@ -36,17 +38,22 @@
 #include "Pikzel/Renderer/GraphicsContext.h"
 #include "Pikzel/Renderer/Pipeline.h"
 #include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Renderer/RenderQueue.h"
 #include "Pikzel/Renderer/sRGB.h"
 #include "Pikzel/Renderer/Texture.h"
 
 #include "Pikzel/Scene/AssetCache.h"
 #include "Pikzel/Scene/Camera.h"
+#include "Pikzel/Scene/CookedModelAsset.h"
+#include "Pikzel/Scene/GeometryPool.h"
 #include "Pikzel/Scene/Light.h"
 #include "Pikzel/Scene/Mesh.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
 #include "Pikzel/Scene/ModelAsset.h"
 #include "Pikzel/Scene/ModelAssetLoader.h"
 #include "Pikzel/Scene/Scene.h"
 #include "Pikzel/Scene/SceneRenderer.h"
+#include "Pikzel/Scene/VertexPacking.h"
 #include "Pikzel/Serialization/SceneSerializer.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -48,14 +48,25 @@ namespace Pikzel {
 
 
    OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t count, const uint32_t* indices)
+   : OpenGLIndexBuffer(count, IndexType::UInt32, indices)
+   {}
+
+
+   OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t count, const uint16_t* indices)
+   : OpenGLIndexBuffer(count, IndexType::UInt16, indices)
+   {}
+
+
+   OpenGLIndexBuffer::OpenGLIndexBuffer(const uint32_t count, const IndexType indexType, const void* indices)
    : m_Count(count)
+   , m_IndexType(indexType)
    {
       glCreateBuffers(1, &m_RendererID);
 
       // GL_ELEMENT_ARRAY_BUFFER is not valid without an actively bound VAO
       // Binding with GL_ARRAY_BUFFER allows the data to be loaded regardless of VAO state. 
       glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-      glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+      glBufferData(GL_ARRAY_BUFFER, count * IndexTypeSize(indexType), indices, GL_STATIC_DRAW);
    }
 
 
@@ -65,7 +76,9 @@ namespace Pikzel {
 
 
    void OpenGLIndexBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
-      PKZL_CORE_ASSERT(false, "Cannot SetData() on an OpenGLIndexBuffer - it is static data, set at construction!")
+      PKZL_CORE_ASSERT(offset + size <= m_Count * IndexTypeSize(m_IndexType), "OpenGLIndexBuffer::CopyFromHost() buffer overrun!");
+      glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+      glBufferSubData(GL_ARRAY_BUFFER, offset, size, pData);
    }
 
 
@@ -74,11 +87,21 @@ namespace Pikzel {
    }
 
 
+   GLenum OpenGLIndexBuffer::GetGLType() const {
+      return (m_IndexType == IndexType::UInt16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+   }
+
+
    uint32_t OpenGLIndexBuffer::GetCount() const {
       return m_Count;
    }
 
 
+   IndexType OpenGLIndexBuffer::GetIndexType() const {
+      return m_IndexType;
+   }
+
+
    OpenGLUniformBuffer::OpenGLUniformBuffer(const uint32_t size) {
       glCreateBuffers(1, &m_RendererID);
       glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
@@ -109,4 +132,74 @@ namespace Pikzel {
       return m_RendererID;
    }
 
+
+
+   OpenGLStorageBuffer::OpenGLStorageBuffer(const uint32_t size) {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLStorageBuffer::OpenGLStorageBuffer(const uint32_t size, const void* data) {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLStorageBuffer::~OpenGLStorageBuffer() {
+      glDeleteBuffers(1, &m_RendererID);
+   }
+
+
+   void OpenGLStorageBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_RendererID);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, pData);
+   }
+
+
+   GLuint OpenGLStorageBuffer::GetRendererId() const {
+      return m_RendererID;
+   }
+
+
+   OpenGLIndirectBuffer::OpenGLIndirectBuffer(const uint32_t count)
+   : m_Count {count}
+   {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+      glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawIndexedIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLIndirectBuffer::OpenGLIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands)
+   : m_Count {count}
+   {
+      glCreateBuffers(1, &m_RendererID);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+      glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawIndexedIndirectCommand), commands, GL_DYNAMIC_DRAW);
+   }
+
+
+   OpenGLIndirectBuffer::~OpenGLIndirectBuffer() {
+      glDeleteBuffers(1, &m_RendererID);
+   }
+
+
+   void OpenGLIndirectBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+      glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, size, pData);
+   }
+
+
+   uint32_t OpenGLIndirectBuffer::GetCount() const {
+      return m_Count;
+   }
+
+
+   GLuint OpenGLIndirectBuffer::GetRendererId() const {
+      return m_RendererID;
+   }
+
 }
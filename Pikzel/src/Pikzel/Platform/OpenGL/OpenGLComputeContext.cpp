@@ -20,7 +20,10 @@ namespace Pikzel {
    void OpenGLComputeContext::Begin() {}
 
 
-   void OpenGLComputeContext::End() {}
+   void OpenGLComputeContext::End() {
+      // make results of compute visible to whatever comes next (which might be reading them as textures, vertex data, or draw commands)
+      glMemoryBarrier(GL_ALL_BARRIER_BITS);
+   }
 
 
    void OpenGLComputeContext::Bind(const Id resourceId, const UniformBuffer& buffer) {
@@ -31,6 +34,27 @@ namespace Pikzel {
    void OpenGLComputeContext::Unbind(const UniformBuffer&) {}
 
 
+   void OpenGLComputeContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Pipeline->GetStorageBufferBinding(resourceId), static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId());
+   }
+
+
+   void OpenGLComputeContext::Unbind(const StorageBuffer&) {}
+
+
+   void OpenGLComputeContext::Bind(const Id resourceId, const IndirectBuffer& buffer) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Pipeline->GetStorageBufferBinding(resourceId), static_cast<const OpenGLIndirectBuffer&>(buffer).GetRendererId());
+   }
+
+
+   void OpenGLComputeContext::Unbind(const IndirectBuffer&) {}
+
+
+   void OpenGLComputeContext::Fill(const StorageBuffer& buffer, const uint32_t value) {
+      glClearNamedBufferData(static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &value);
+   }
+
+
    void OpenGLComputeContext::Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) {
       GLuint samplerBinding = m_Pipeline->GetSamplerBinding(resourceId, false);
       if (samplerBinding != ~0) {
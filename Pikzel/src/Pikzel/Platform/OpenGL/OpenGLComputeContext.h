@@ -21,6 +21,14 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
+      virtual void Bind(const Id resourceId, const IndirectBuffer& buffer) override;
+      virtual void Unbind(const IndirectBuffer& buffer) override;
+
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -77,6 +77,14 @@ namespace Pikzel {
    void OpenGLGraphicsContext::Unbind(const UniformBuffer&) {}
 
 
+   void OpenGLGraphicsContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_Pipeline->GetStorageBufferBinding(resourceId), static_cast<const OpenGLStorageBuffer&>(buffer).GetRendererId());
+   }
+
+
+   void OpenGLGraphicsContext::Unbind(const StorageBuffer&) {}
+
+
    void OpenGLGraphicsContext::Bind(const Id resourceId, const Texture& texture) {
       glBindTextureUnit(m_Pipeline->GetSamplerBinding(resourceId), static_cast<const OpenGLTexture&>(texture).GetRendererId());
    }
@@ -339,12 +347,67 @@ namespace Pikzel {
    }
 
 
-   void OpenGLGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/) {
+   void OpenGLGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
+      PKZL_PROFILE_FUNCTION();
+      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount() - firstIndex;
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      glDrawElementsBaseVertex(GL_TRIANGLES, count, static_cast<const OpenGLIndexBuffer&>(indexBuffer).GetGLType(), reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * IndexTypeSize(indexBuffer.GetIndexType())), vertexOffset);
+   }
+
+
+   void OpenGLGraphicsContext::DrawIndexedInstanced(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t instanceCount, const uint32_t firstInstance/*= 0*/, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
       PKZL_PROFILE_FUNCTION();
-      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount();
+      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount() - firstIndex;
       Bind(vertexBuffer);
       Bind(indexBuffer);
-      glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, vertexOffset);
+      glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, count, static_cast<const OpenGLIndexBuffer&>(indexBuffer).GetGLType(), reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * IndexTypeSize(indexBuffer.GetIndexType())), instanceCount, vertexOffset, firstInstance);
+   }
+
+
+   void OpenGLGraphicsContext::DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t commandIndex/*= 0*/) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(commandIndex < indirectBuffer.GetCount(), "DrawIndexedIndirect() command index out of range!");
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<const OpenGLIndirectBuffer&>(indirectBuffer).GetRendererId());
+      glDrawElementsIndirect(GL_TRIANGLES, static_cast<const OpenGLIndexBuffer&>(indexBuffer).GetGLType(), reinterpret_cast<const void*>(commandIndex * sizeof(DrawIndexedIndirectCommand)));
+   }
+
+
+   void OpenGLGraphicsContext::MultiDrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t drawCount, const uint32_t firstCommand/*= 0*/) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(firstCommand + drawCount <= indirectBuffer.GetCount(), "MultiDrawIndexedIndirect() command range out of range!");
+      if (drawCount == 0) {
+         return;
+      }
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<const OpenGLIndirectBuffer&>(indirectBuffer).GetRendererId());
+      glMultiDrawElementsIndirect(GL_TRIANGLES, static_cast<const OpenGLIndexBuffer&>(indexBuffer).GetGLType(), reinterpret_cast<const void*>(firstCommand * sizeof(DrawIndexedIndirectCommand)), drawCount, 0);
+   }
+
+
+   void OpenGLGraphicsContext::DrawIndexedIndirectCount(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const StorageBuffer& countBuffer, const uint32_t maxDrawCount, const uint32_t firstCommand/*= 0*/, const uint32_t countIndex/*= 0*/) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(firstCommand + maxDrawCount <= indirectBuffer.GetCount(), "DrawIndexedIndirectCount() command range out of range!");
+      if (!GLAD_GL_VERSION_4_6 && !GLAD_GL_ARB_indirect_parameters) {
+         throw std::runtime_error {"DrawIndexedIndirectCount() requires OpenGL 4.6 or GL_ARB_indirect_parameters, which is not supported!"};
+      }
+      if (maxDrawCount == 0) {
+         return;
+      }
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<const OpenGLIndirectBuffer&>(indirectBuffer).GetRendererId());
+      glBindBuffer(GL_PARAMETER_BUFFER, static_cast<const OpenGLStorageBuffer&>(countBuffer).GetRendererId());
+      const GLenum type = static_cast<const OpenGLIndexBuffer&>(indexBuffer).GetGLType();
+      const void* indirect = reinterpret_cast<const void*>(firstCommand * sizeof(DrawIndexedIndirectCommand));
+      if (GLAD_GL_VERSION_4_6) {
+         glMultiDrawElementsIndirectCount(GL_TRIANGLES, type, indirect, countIndex * sizeof(uint32_t), maxDrawCount, 0);
+      } else {
+         glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, type, indirect, countIndex * sizeof(uint32_t), maxDrawCount, 0);
+      }
    }
 
 
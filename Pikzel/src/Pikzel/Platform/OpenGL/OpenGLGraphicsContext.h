@@ -41,6 +41,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -89,7 +92,11 @@ namespace Pikzel {
       virtual void PushConstant(const Id id, const glm::dmat4& value) override;
 
       virtual void DrawTriangles(const VertexBuffer& vertexBuffer, const uint32_t vertexCount, const uint32_t vertexOffset = 0) override;
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) override;
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedInstanced(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t instanceCount, const uint32_t firstInstance = 0, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t commandIndex = 0) override;
+      virtual void MultiDrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t drawCount, const uint32_t firstCommand = 0) override;
+      virtual void DrawIndexedIndirectCount(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const StorageBuffer& countBuffer, const uint32_t maxDrawCount, const uint32_t firstCommand = 0, const uint32_t countIndex = 0) override;
 
    private:
       OpenGLPipeline* m_Pipeline;
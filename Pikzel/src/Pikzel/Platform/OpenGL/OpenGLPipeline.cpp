@@ -1,13 +1,19 @@
 #include "OpenGLPipeline.h"
 #include "OpenGLBuffer.h"
+#include "OpenGLShaderCache.h"
+#include "OpenGLTextureTable.h"
 
+#include "Pikzel/Core/Hash.h"
 #include "Pikzel/Core/Utility.h"
 
 #include <GL/gl.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <spirv_cross/spirv_glsl.hpp>
 
+#include <algorithm>
 #include <format>
+#include <regex>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -38,6 +44,12 @@ namespace Pikzel {
          case DataType::DVec2:    return GL_DOUBLE;
          case DataType::DVec3:    return GL_DOUBLE;
          case DataType::DVec4:    return GL_DOUBLE;
+         case DataType::SNorm16Vec2: return GL_SHORT;
+         case DataType::SNorm16Vec4: return GL_SHORT;
+         case DataType::UNorm16Vec2: return GL_UNSIGNED_SHORT;
+         case DataType::UNorm16Vec4: return GL_UNSIGNED_SHORT;
+         case DataType::HVec2:    return GL_HALF_FLOAT;
+         case DataType::HVec4:    return GL_HALF_FLOAT;
       }
 
       PKZL_CORE_ASSERT(false, "Unknown DataType!");
@@ -141,11 +153,62 @@ namespace Pikzel {
 
    }
 
+   // Unbounded sampler arrays are the bindless texture table
+   static bool IsTextureTable(const spirv_cross::Compiler& compiler, const spirv_cross::Resource& resource) {
+      const auto& type = compiler.get_type(resource.type_id);
+      return (type.array.size() == 1) && (type.array[0] == 0);
+   }
+
+
    void OpenGLPipeline::ParseResourceBindings(spirv_cross::Compiler& compiler) {
       spirv_cross::ShaderResources resources = compiler.get_shader_resources();
-      ParseResourceBindings_Internal("uniform buffer", compiler, m_UniformBufferBindingMap, m_UniformBufferResources, {&m_SamplerResources, &m_StorageImageResources}, resources.uniform_buffers);
-      ParseResourceBindings_Internal("sampler", compiler, m_SamplerBindingMap, m_SamplerResources, {&m_UniformBufferResources, &m_StorageImageResources}, resources.sampled_images);
-      ParseResourceBindings_Internal("storage image", compiler, m_StorageImageBindingMap, m_StorageImageResources, {&m_UniformBufferResources, &m_SamplerResources}, resources.storage_images);
+
+      // In OpenGL, texture tables become a storage buffer of texture handles, and so take their binding numbers from the storage buffers
+      spirv_cross::SmallVector<spirv_cross::Resource> samplers;
+      spirv_cross::SmallVector<spirv_cross::Resource> textureTables;
+      for (const auto& resource : resources.sampled_images) {
+         if (IsTextureTable(compiler, resource)) {
+            textureTables.emplace_back(resource);
+         } else {
+            samplers.emplace_back(resource);
+         }
+      }
+      if (!textureTables.empty()) {
+         if (!OpenGLTextureTable::IsSupported()) {
+            throw std::runtime_error {"Shader uses the bindless texture table, but bindless textures are not supported (GL_ARB_bindless_texture not available)!"};
+         }
+         compiler.require_extension("GL_ARB_bindless_texture");
+      }
+
+      ParseResourceBindings_Internal("uniform buffer", compiler, m_UniformBufferBindingMap, m_UniformBufferResources, {&m_SamplerResources, &m_StorageImageResources, &m_StorageBufferResources, &m_TextureTableResources}, resources.uniform_buffers);
+      ParseResourceBindings_Internal("sampler", compiler, m_SamplerBindingMap, m_SamplerResources, {&m_UniformBufferResources, &m_StorageImageResources, &m_StorageBufferResources, &m_TextureTableResources}, samplers);
+      ParseResourceBindings_Internal("storage image", compiler, m_StorageImageBindingMap, m_StorageImageResources, {&m_UniformBufferResources, &m_SamplerResources, &m_StorageBufferResources, &m_TextureTableResources}, resources.storage_images);
+      ParseResourceBindings_Internal("storage buffer", compiler, m_StorageBufferBindingMap, m_StorageBufferResources, {&m_UniformBufferResources, &m_SamplerResources, &m_StorageImageResources, &m_TextureTableResources}, resources.storage_buffers);
+      ParseResourceBindings_Internal("texture table", compiler, m_StorageBufferBindingMap, m_TextureTableResources, {&m_UniformBufferResources, &m_SamplerResources, &m_StorageImageResources, &m_StorageBufferResources}, textureTables);
+   }
+
+
+   // spirv-cross emits the texture table as an unbounded array of samplers, e.g.
+   //    layout(binding = 3) uniform sampler2D textures[];
+   // With GL_ARB_bindless_texture, that becomes a storage buffer of handles, e.g.
+   //    layout(binding = 3, std430) readonly buffer PikzelTextureTable_textures { sampler2D textures[]; };
+   // and the shader's indexing of the array (textures[i]) is then unchanged.
+   // This relies on the exact form of spirv-cross's output, so it is an error if any of the shader's texture tables is not found.
+   // OpenGL does not have nonuniformEXT(), so that is defined away (the index must be dynamically uniform, see OpenGLTextureTable)
+   static std::string RewriteTextureTables(const spirv_cross::Compiler& compiler, std::string glsl) {
+      for (const auto& resource : compiler.get_shader_resources().sampled_images) {
+         if (!IsTextureTable(compiler, resource)) {
+            continue;
+         }
+         const std::regex textureTable {std::format(R"(layout\(binding = (\d+)\) uniform (\w+) {}\[\];)", resource.name)};
+         std::string rewritten = std::regex_replace(glsl, textureTable, std::format("layout(binding = $1, std430) readonly buffer PikzelTextureTable_{0} {{ $2 {0}[]; }};", resource.name));
+         if (rewritten == glsl) {
+            throw std::runtime_error {std::format("Could not find the declaration of bindless texture table '{}' in generated GLSL.  Cannot convert it to GL_ARB_bindless_texture handles!", resource.name)};
+         }
+         glsl = std::move(rewritten);
+      }
+      static const std::regex nonuniformExtension {R"(#extension GL_EXT_nonuniform_qualifier : require)"};
+      return std::regex_replace(glsl, nonuniformExtension, "#define nonuniformEXT(x) x");
    }
 
 
@@ -180,15 +243,50 @@ namespace Pikzel {
    }
 
 
+   // Key for OpenGLShaderCache: everything that the generated GLSL depends on.
+   // (the program binary also depends on the driver, but OpenGLShaderCache takes care of that)
+   static uint64_t ShaderCacheKey(const std::vector<std::pair<ShaderType, std::vector<uint32_t>>>& shaderSrcs, const SpecializationConstantsMap& specializationConstants) {
+      constexpr uint32_t keyVersion = 1;  // bump if the way that GLSL is generated changes
+      uint64_t key = HashBytes(std::as_bytes(std::span {&keyVersion, 1}));
+      key = HashValue(OpenGLTextureTable::IsSupported(), key);  // texture tables are rewritten only if bindless is supported
+      for (const auto& [shaderType, src] : shaderSrcs) {
+         key = HashValue(shaderType, key);
+         key = HashBytes(std::as_bytes(std::span {src}), key);
+      }
+
+      // specialization constants map is unordered, so sort it for a stable key
+      std::vector<std::pair<std::string, int>> constants {specializationConstants.begin(), specializationConstants.end()};
+      std::sort(constants.begin(), constants.end());
+      for (const auto& [name, value] : constants) {
+         key = HashBytes(std::as_bytes(std::span {name}), key);
+         key = HashValue(value, key);
+      }
+      return key;
+   }
+
+
    OpenGLPipeline::OpenGLPipeline(const PipelineSettings& settings)
    : m_EnableBlend {settings.enableBlend}
    {
-      std::vector<GLuint> shaders;
-      for (const auto& [shaderType, src] : settings.shaders) {
-         AppendShader(shaderType, src, settings.specializationConstants);
+      std::vector<std::pair<ShaderType, std::vector<uint32_t>>> shaderSrcs;
+      for (const auto& [shaderType, path] : settings.shaders) {
+         PKZL_CORE_LOG_TRACE("Appending shader '{}'", path.string());
+         shaderSrcs.emplace_back(shaderType, ReadFile<uint32_t>(path));
       }
 
-      LinkShaderProgram();
+      // If there is a cached program binary, then shaders are only reflected (for their bindings and push constants),
+      // not compiled
+      const uint64_t key = ShaderCacheKey(shaderSrcs, settings.specializationConstants);
+      m_RendererId = OpenGLShaderCache::LoadProgram(key);
+
+      for (uint32_t i = 0; i < shaderSrcs.size(); ++i) {
+         AppendShader(shaderSrcs[i].first, shaderSrcs[i].second, settings.specializationConstants, HashValue(i, key));
+      }
+
+      if (m_RendererId == 0) {
+         LinkShaderProgram();
+         OpenGLShaderCache::SaveProgram(key, m_RendererId);
+      }
       DeleteShaders();
       FindUniformLocations();
 
@@ -218,6 +316,12 @@ namespace Pikzel {
             case DataType::DVec2:
             case DataType::DVec3:
             case DataType::DVec4:
+            case DataType::SNorm16Vec2:
+            case DataType::SNorm16Vec4:
+            case DataType::UNorm16Vec2:
+            case DataType::UNorm16Vec4:
+            case DataType::HVec2:
+            case DataType::HVec4:
             {
                glEnableVertexAttribArray(vertexAttributeIndex);
                glVertexAttribFormat(vertexAttributeIndex, element.GetComponentCount(), DataTypeToOpenGLType(element.dataType), element.normalized ? GL_TRUE : GL_FALSE, element.offset);
@@ -536,6 +640,16 @@ namespace Pikzel {
    }
 
 
+   GLuint OpenGLPipeline::GetStorageBufferBinding(const Id resourceId, bool exceptionIfNotFound) const {
+      const auto resource = m_StorageBufferResources.find(resourceId);
+      GLuint retVal = (resource == m_StorageBufferResources.end()) ? ~0 : resource->second.Binding;
+      if (exceptionIfNotFound && retVal == ~0) {
+         throw std::invalid_argument {std::format("OpenGLPipeline::GetStorageBufferBinding() failed to find resource with id {}!", resourceId)};
+      }
+      return retVal;
+   }
+
+
    void OpenGLPipeline::SetGLState() const {
       glUseProgram(GetRendererId());
       glBindVertexArray(GetVAORendererId());
@@ -544,19 +658,33 @@ namespace Pikzel {
       } else {
          glDisable(GL_BLEND);
       }
+      for (const auto& [id, resource] : m_TextureTableResources) {
+         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, resource.Binding, OpenGLTextureTable::GetRendererId());
+      }
    }
 
 
-   void OpenGLPipeline::AppendShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants) {
-      PKZL_CORE_LOG_TRACE("Appending shader '{}'", path.string());
-
-      std::vector<uint32_t> src = ReadFile<uint32_t>(path);
-
+   void OpenGLPipeline::AppendShader(ShaderType type, const std::vector<uint32_t>& src, const SpecializationConstantsMap& specializationConstants, const uint64_t glslKey) {
       spirv_cross::CompilerGLSL compiler(src);
       ParsePushConstants(compiler);
       ParseResourceBindings(compiler);
       SetSpecializationConstants(compiler, specializationConstants);
-      std::string glsl = compiler.compile();
+
+      // program was loaded from the shader cache, nothing to compile
+      if (m_RendererId != 0) {
+         return;
+      }
+
+      std::string glsl;
+      if (auto cachedGLSL = OpenGLShaderCache::LoadGLSL(glslKey)) {
+         glsl = std::move(*cachedGLSL);
+      } else {
+         glsl = compiler.compile();
+         if (!m_TextureTableResources.empty()) {
+            glsl = RewriteTextureTables(compiler, std::move(glsl));
+         }
+         OpenGLShaderCache::SaveGLSL(glslKey, glsl);
+      }
 
       GLuint shader = glCreateShader(ShaderTypeToOpenGLType(type));
       const GLchar* srcC = glsl.data();
@@ -588,6 +716,7 @@ namespace Pikzel {
          m_RendererId = 0;
       }
       m_RendererId = glCreateProgram();
+      glProgramParameteri(m_RendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
       for (const auto shaderId : m_ShaderIds) {
          glAttachShader(m_RendererId, shaderId);
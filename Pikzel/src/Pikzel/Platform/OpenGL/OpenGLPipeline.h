@@ -82,11 +82,12 @@ namespace Pikzel {
       GLuint GetSamplerBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
       GLuint GetStorageImageBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
       GLuint GetUniformBufferBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
+      GLuint GetStorageBufferBinding(const Id resourceId, const bool exceptionIfNotFound = true) const;
 
       void SetGLState() const;
 
    private:
-      void AppendShader(ShaderType type, const std::filesystem::path path, const SpecializationConstantsMap& specializationConstants);
+      void AppendShader(ShaderType type, const std::vector<uint32_t>& src, const SpecializationConstantsMap& specializationConstants, const uint64_t glslKey);
       void ParsePushConstants(spirv_cross::Compiler& compiler);
       void ParseResourceBindings(spirv_cross::Compiler& compiler);
       void SetSpecializationConstants(spirv_cross::Compiler& compiler, const SpecializationConstantsMap& specializationConstants);
@@ -104,6 +105,9 @@ namespace Pikzel {
       OpenGLResourceMap m_SamplerResources;                        // maps resource id (essentially the name of the resource) -> its opengl binding
       OpenGLBindingMap m_StorageImageBindingMap;
       OpenGLResourceMap m_StorageImageResources;                   // maps resource id (essentially the name of the resource) -> its opengl binding
+      OpenGLBindingMap m_StorageBufferBindingMap;
+      OpenGLResourceMap m_StorageBufferResources;                  // maps resource id (essentially the name of the resource) -> its opengl binding
+      OpenGLResourceMap m_TextureTableResources;                   // bindless texture tables.  These are storage buffers in OpenGL (see OpenGLTextureTable)
 
       uint32_t m_RendererId = 0;
       uint32_t m_VAORendererId = 0;
@@ -3,7 +3,9 @@
 #include "OpenGLComputeContext.h"
 #include "OpenGLGraphicsContext.h"
 #include "OpenGLPipeline.h"
+#include "OpenGLShaderCache.h"
 #include "OpenGLTexture.h"
+#include "OpenGLTextureTable.h"
 
 #include <GL/gl.h>
 
@@ -96,10 +98,21 @@ namespace Pikzel {
 
       glEnable(GL_MULTISAMPLE);
       glEnable(GL_FRAMEBUFFER_SRGB);
+
+      OpenGLShaderCache::Init();
+      OpenGLTextureTable::Init();
+      if (!OpenGLTextureTable::IsSupported()) {
+         PKZL_CORE_LOG_INFO("  GL_ARB_bindless_texture not available: textures must be bound individually");
+      }
+      if (!SupportsIndirectCount()) {
+         PKZL_CORE_LOG_INFO("  OpenGL 4.6 or GL_ARB_indirect_parameters not available: draw counts cannot be read from buffers");
+      }
    }
 
 
-   OpenGLRenderCore::~OpenGLRenderCore() {}
+   OpenGLRenderCore::~OpenGLRenderCore() {
+      OpenGLTextureTable::DeInit();
+   }
 
 
    void OpenGLRenderCore::UploadImGuiFonts() {}
@@ -110,6 +123,22 @@ namespace Pikzel {
    }
 
 
+   bool OpenGLRenderCore::SupportsBindlessTextures() const {
+      return OpenGLTextureTable::IsSupported();
+   }
+
+
+   // baseInstance of indirect commands is core since OpenGL 4.2
+   bool OpenGLRenderCore::SupportsIndirectFirstInstance() const {
+      return true;
+   }
+
+
+   bool OpenGLRenderCore::SupportsIndirectCount() const {
+      return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_indirect_parameters;
+   }
+
+
    std::unique_ptr<ComputeContext> OpenGLRenderCore::CreateComputeContext() {
       return std::make_unique<OpenGLComputeContext>();
    }
@@ -135,6 +164,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> OpenGLRenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return std::make_unique<OpenGLIndexBuffer>(count, indices);
+   }
+
+
    std::unique_ptr<UniformBuffer> OpenGLRenderCore::CreateUniformBuffer(const uint32_t size) {
       return std::make_unique<OpenGLUniformBuffer>(size);
    }
@@ -145,6 +179,26 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<StorageBuffer> OpenGLRenderCore::CreateStorageBuffer(const uint32_t size) {
+      return std::make_unique<OpenGLStorageBuffer>(size);
+   }
+
+
+   std::unique_ptr<StorageBuffer> OpenGLRenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return std::make_unique<OpenGLStorageBuffer>(size, data);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> OpenGLRenderCore::CreateIndirectBuffer(const uint32_t count) {
+      return std::make_unique<OpenGLIndirectBuffer>(count);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> OpenGLRenderCore::CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands) {
+      return std::make_unique<OpenGLIndirectBuffer>(count, commands);
+   }
+
+
    std::unique_ptr<Framebuffer> OpenGLRenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       return std::make_unique<OpenGLFramebuffer>(settings);
    }
@@ -0,0 +1,136 @@
+#include "OpenGLShaderCache.h"
+
+#include "Pikzel/Core/CheckedFile.h"
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Core/Hash.h"
+
+#include <GL/gl.h>
+
+#include <cstring>
+#include <format>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Pikzel {
+
+   // Each cache file is this header followed by the data (GLSL source, or program binary)
+   struct ShaderCacheFileHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t binaryFormat;   // program binaries only
+      uint64_t key;
+      uint64_t driverId;       // program binaries only
+      uint64_t dataSize;
+      uint64_t checksum;
+   };
+
+   static constexpr char ShaderCacheMagic[8] = {'P', 'K', 'Z', 'L', 'G', 'L', 'S', 'C'};
+   static constexpr uint32_t ShaderCacheVersion = 1;
+
+
+   // Program binaries for different drivers get different files, so that switching between them does not thrash the cache
+   static std::filesystem::path ShaderCachePath(const std::filesystem::path& dir, const uint64_t key, const uint64_t driverId, const std::string_view extension) {
+      return dir / std::format("{:016x}{}", driverId ? HashValue(driverId, key) : key, extension);
+   }
+
+
+   static std::optional<std::vector<uint8_t>> ReadShaderCacheFile(const std::filesystem::path& path, const uint64_t key, const uint64_t driverId, ShaderCacheFileHeader& header) {
+      return ReadCheckedFile(path, header, [key, driverId] (const ShaderCacheFileHeader& fileHeader) {
+         return
+            (std::memcmp(fileHeader.magic, ShaderCacheMagic, sizeof(ShaderCacheMagic)) == 0) &&
+            (fileHeader.version == ShaderCacheVersion) &&
+            (fileHeader.key == key) &&
+            (fileHeader.driverId == driverId);
+      });
+   }
+
+
+   static void WriteShaderCacheFile(const std::filesystem::path& path, ShaderCacheFileHeader header, const std::span<const std::byte> data) {
+      std::memcpy(header.magic, ShaderCacheMagic, sizeof(ShaderCacheMagic));
+      header.version = ShaderCacheVersion;
+      WriteCheckedFile(path, header, data);
+   }
+
+
+   void OpenGLShaderCache::Init() {
+      const std::string driver = std::format("{}|{}|{}", (const char*)glGetString(GL_VENDOR), (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+      m_DriverId = HashBytes(std::as_bytes(std::span {driver}));
+
+      GLint numFormats = 0;
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+      m_ProgramBinariesSupported = numFormats > 0;
+      if (!m_ProgramBinariesSupported) {
+         PKZL_CORE_LOG_INFO("  Driver does not support program binaries: only GLSL will be cached");
+      }
+   }
+
+
+   std::optional<std::string> OpenGLShaderCache::LoadGLSL(const uint64_t key) {
+      ShaderCacheFileHeader header;
+      auto data = ReadShaderCacheFile(ShaderCachePath(m_Dir, key, 0, ".glsl"), key, 0, header);
+      if (!data) {
+         return {};
+      }
+      return std::string {data->begin(), data->end()};
+   }
+
+
+   void OpenGLShaderCache::SaveGLSL(const uint64_t key, const std::string& glsl) {
+      const auto path = ShaderCachePath(m_Dir, key, 0, ".glsl");
+      try {
+         WriteShaderCacheFile(path, {.key = key}, std::as_bytes(std::span {glsl}));
+      } catch (const std::exception& err) {
+         PKZL_CORE_LOG_WARN("Could not save shader cache file '{0}': {1}", path.string(), err.what());
+      }
+   }
+
+
+   uint32_t OpenGLShaderCache::LoadProgram(const uint64_t key) {
+      if (!m_ProgramBinariesSupported) {
+         return 0;
+      }
+      ShaderCacheFileHeader header;
+      auto data = ReadShaderCacheFile(ShaderCachePath(m_Dir, key, m_DriverId, ".bin"), key, m_DriverId, header);
+      if (!data) {
+         return 0;
+      }
+
+      GLuint program = glCreateProgram();
+      glProgramBinary(program, header.binaryFormat, data->data(), static_cast<GLsizei>(data->size()));
+
+      GLint isLinked = 0;
+      glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+      if (isLinked == GL_FALSE) {
+         PKZL_CORE_LOG_INFO("Driver rejected cached program binary '{0}'.  It will be rebuilt", ShaderCachePath(m_Dir, key, m_DriverId, ".bin").string());
+         glDeleteProgram(program);
+         return 0;
+      }
+      return program;
+   }
+
+
+   void OpenGLShaderCache::SaveProgram(const uint64_t key, const uint32_t program) {
+      if (!m_ProgramBinariesSupported) {
+         return;
+      }
+
+      GLint length = 0;
+      glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+      if (length <= 0) {
+         return;
+      }
+      std::vector<char> data(length);
+      GLenum binaryFormat = 0;
+      glGetProgramBinary(program, length, &length, &binaryFormat, data.data());
+      data.resize(length);
+
+      const auto path = ShaderCachePath(m_Dir, key, m_DriverId, ".bin");
+      try {
+         WriteShaderCacheFile(path, {.binaryFormat = binaryFormat, .key = key, .driverId = m_DriverId}, std::as_bytes(std::span {data}));
+      } catch (const std::exception& err) {
+         PKZL_CORE_LOG_WARN("Could not save shader cache file '{0}': {1}", path.string(), err.what());
+      }
+   }
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace Pikzel {
+
+   // On-disk cache of the GLSL that OpenGLPipeline cross-compiles from SPIR-V, and of linked program binaries
+   // (glGetProgramBinary / glProgramBinary), so that a warm start skips both spirv-cross and the driver's compiler.
+   //
+   // Entries are keyed by the caller (OpenGLPipeline hashes the SPIR-V, specialization constants, etc.).
+   // Program binaries are additionally tied to the driver (vendor, renderer, and version strings), and are ignored if
+   // they were written by a different one.  The driver can also reject a binary (e.g. after an update that does not change
+   // its version string), in which case LoadProgram() fails and the caller should compile from source again.
+   class OpenGLShaderCache {
+      OpenGLShaderCache() = delete;
+   public:
+      // Call once the GL context is current
+      static void Init();
+
+      static std::optional<std::string> LoadGLSL(const uint64_t key);
+      static void SaveGLSL(const uint64_t key, const std::string& glsl);
+
+      // Returns a linked program, or 0 if there is no (usable) binary for key
+      static uint32_t LoadProgram(const uint64_t key);
+      static void SaveProgram(const uint64_t key, const uint32_t program);
+
+   private:
+      inline static std::filesystem::path m_Dir = "OpenGLShaderCache";
+      inline static uint64_t m_DriverId = 0;
+      inline static bool m_ProgramBinariesSupported = false;
+   };
+
+}
@@ -2,6 +2,7 @@
 
 #include "OpenGLComputeContext.h"
 #include "OpenGLPipeline.h"
+#include "OpenGLTextureTable.h"
 
 #include <GL/gl.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -136,6 +137,9 @@ namespace Pikzel {
 
 
    OpenGLTexture::~OpenGLTexture() {
+      if (m_BindlessIndex != InvalidBindlessIndex) {
+         OpenGLTextureTable::Remove(m_BindlessIndex);
+      }
       glDeleteTextures(1, &m_RendererId);
    }
 
@@ -244,6 +248,11 @@ namespace Pikzel {
          }
       }
       SetTextureParameters(settings);
+
+      // The texture's state is fixed once it has a handle, so this must come last
+      if ((GetType() == TextureType::Texture2D) && OpenGLTextureTable::IsSupported()) {
+         m_BindlessIndex = OpenGLTextureTable::Add(m_RendererId);
+      }
    }
 
 
@@ -343,13 +352,29 @@ namespace Pikzel {
    void OpenGLTexture::Commit(const uint32_t baseMipLevel) {
       if (baseMipLevel < GetMIPLevels() - 1) {
          GLenum target = TextureTypeToGLTarget(GetType());
-         glTextureParameteri(m_RendererId, GL_TEXTURE_BASE_LEVEL, baseMipLevel);
-         glGenerateTextureMipmap(m_RendererId);
-         glTextureParameteri(m_RendererId, GL_TEXTURE_BASE_LEVEL, 0);
+         if (m_BindlessIndex == InvalidBindlessIndex) {
+            glTextureParameteri(m_RendererId, GL_TEXTURE_BASE_LEVEL, baseMipLevel);
+            glGenerateTextureMipmap(m_RendererId);
+            glTextureParameteri(m_RendererId, GL_TEXTURE_BASE_LEVEL, 0);
+         } else {
+            // Texture has a bindless handle, so its base level cannot be changed.
+            // Generate the mipmaps via a view that starts at baseMipLevel instead
+            // (only 2D textures are in the bindless table, so the view is always of one layer)
+            uint32_t view = 0;
+            glGenTextures(1, &view);
+            glTextureView(view, target, m_RendererId, TextureFormatToInternalFormat(m_Format), baseMipLevel, GetMIPLevels() - baseMipLevel, 0, 1);
+            glGenerateTextureMipmap(view);
+            glDeleteTextures(1, &view);
+         }
       }
    }
 
 
+   uint32_t OpenGLTexture::GetBindlessIndex() const {
+      return m_BindlessIndex;
+   }
+
+
    uint32_t OpenGLTexture::GetRendererId() const {
       return m_RendererId;
    }
@@ -28,6 +28,8 @@ namespace Pikzel {
 
       virtual void Commit(const uint32_t generateMipmapAfterLevel) override;
 
+      virtual uint32_t GetBindlessIndex() const override;
+
       bool operator==(const Texture& that) override;
 
    public:
@@ -54,6 +56,7 @@ namespace Pikzel {
       uint32_t m_Layers = {};
       uint32_t m_MIPLevels = {};
       uint32_t m_RendererId = {};
+      uint32_t m_BindlessIndex = InvalidBindlessIndex;
    };
 
 
@@ -0,0 +1,69 @@
+#include "OpenGLTextureTable.h"
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Texture.h"
+
+#include <GL/gl.h>
+
+namespace Pikzel {
+
+   void OpenGLTextureTable::Init() {
+      DeInit();
+      if (GLAD_GL_ARB_bindless_texture) {
+         glCreateBuffers(1, &m_RendererId);
+         glNamedBufferStorage(m_RendererId, MaxTextures * sizeof(GLuint64), nullptr, GL_DYNAMIC_STORAGE_BIT);
+      }
+   }
+
+
+   void OpenGLTextureTable::DeInit() {
+      if (m_RendererId) {
+         glDeleteBuffers(1, &m_RendererId);
+         m_RendererId = 0;
+      }
+      m_Next = 0;
+      m_FreeIndices.clear();
+   }
+
+
+   bool OpenGLTextureTable::IsSupported() {
+      return m_RendererId != 0;
+   }
+
+
+   uint32_t OpenGLTextureTable::GetRendererId() {
+      return m_RendererId;
+   }
+
+
+   uint32_t OpenGLTextureTable::Add(const uint32_t texture) {
+      PKZL_CORE_ASSERT(IsSupported(), "Bindless textures are not supported!");
+      uint32_t index = Texture::InvalidBindlessIndex;
+      if (!m_FreeIndices.empty()) {
+         index = m_FreeIndices.back();
+         m_FreeIndices.pop_back();
+      } else if (m_Next < MaxTextures) {
+         index = m_Next++;
+      } else {
+         PKZL_CORE_LOG_WARN("Bindless texture table is full ({0} textures).  Texture will not be available to bindless shaders!", MaxTextures);
+         return index;
+      }
+
+      GLuint64 handle = glGetTextureHandleARB(texture);
+      glMakeTextureHandleResidentARB(handle);
+      glNamedBufferSubData(m_RendererId, index * sizeof(GLuint64), sizeof(GLuint64), &handle);
+      return index;
+   }
+
+
+   void OpenGLTextureTable::Remove(const uint32_t index) {
+      // The handle goes when the texture is deleted (which GL defers until draws already issued are done with it).
+      // Similarly, writing a new handle into the slot does not affect draws already issued, so the slot can be reused straight away.
+      // Textures that outlive the table (i.e. destroyed after DeInit()) have nothing to free.
+      if (m_RendererId) {
+         PKZL_CORE_ASSERT(index < m_Next, "Bindless texture index out of range!");
+         m_FreeIndices.emplace_back(index);
+      }
+   }
+
+}
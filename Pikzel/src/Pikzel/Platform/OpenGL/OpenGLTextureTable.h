@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Pikzel {
+
+   // The global ("bindless") texture table, via GL_ARB_bindless_texture.
+   // A shader storage buffer of resident texture handles, which every 2D texture is added to when it is created.
+   // Shaders declare the table in the same way as for the Vulkan back-end (as an unbounded array of sampler2D, see VulkanTextureTable),
+   // and OpenGLPipeline rewrites that declaration as a storage buffer of handles, bound at the table's binding.
+   // Unlike Vulkan, the index that a shader uses should be dynamically uniform (e.g. supplied via push constant).
+   //
+   // If the extension is not available (e.g. llvmpipe) then there is no table: textures have no bindless index, and have to be
+   // bound (glBindTextureUnit) as usual.
+   class OpenGLTextureTable {
+      OpenGLTextureTable() = delete;
+   public:
+      static constexpr uint32_t MaxTextures = 16384;
+
+      // Create the table, if GL_ARB_bindless_texture is supported
+      static void Init();
+      static void DeInit();
+
+      static bool IsSupported();
+
+      // Storage buffer holding the handles
+      static uint32_t GetRendererId();
+
+      // Make a handle for texture (whose state, e.g. filtering and base mip level, cannot change from here on), make it resident,
+      // and store it in a free slot of the table.  Returns the slot's index (or Texture::InvalidBindlessIndex if the table is full)
+      static uint32_t Add(const uint32_t texture);
+
+      // Free the slot at index.  Call when the texture is deleted (which also deletes its handle)
+      static void Remove(const uint32_t index);
+
+   private:
+      inline static uint32_t m_RendererId = 0;
+      inline static uint32_t m_Next = 0;                  // slots [m_Next, MaxTextures) have never been used
+      inline static std::vector<uint32_t> m_FreeIndices;  // slots below m_Next that have been removed
+   };
+
+}
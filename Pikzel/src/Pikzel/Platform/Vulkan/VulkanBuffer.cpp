@@ -1,6 +1,8 @@
 #include "VulkanBuffer.h"
 #include "VulkanUtility.h"
 
+#include <algorithm>
+
 namespace Pikzel {
 
    VulkanBuffer::VulkanBuffer(std::shared_ptr<VulkanDevice> device, const vk::DeviceSize size, const vk::BufferUsageFlags usage, const vma::MemoryUsage memoryUsage)
@@ -18,6 +20,7 @@ namespace Pikzel {
       auto [buffer, allocation] = VulkanMemoryAllocator::Get().createBuffer(bufferInfo, allocInfo);
       m_Buffer = buffer;
       m_Allocation = allocation;
+      m_Serial = device->NewSerial();
 
       m_Descriptor.buffer = m_Buffer;
       m_Descriptor.offset = 0;
@@ -32,31 +35,44 @@ namespace Pikzel {
 
    VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& that) noexcept {
       if (this != &that) {
-         if (m_Device && m_Buffer) {
-            VulkanMemoryAllocator::Get().destroyBuffer(m_Buffer, m_Allocation);
-            m_Buffer = nullptr;
-            m_Allocation = nullptr;
-         }
+         Destroy();
          m_Device = that.m_Device;
          m_Buffer = that.m_Buffer;
          m_Allocation = that.m_Allocation;
          m_Descriptor = that.m_Descriptor;
          m_Size = that.m_Size;
          m_Usage = that.m_Usage;
+         m_Serial = that.m_Serial;
+         m_WrittenEnd = that.m_WrittenEnd;
+         m_InUseEnd = that.m_InUseEnd;
+         m_InUseValue = that.m_InUseValue;
          that.m_Device = nullptr;
          that.m_Buffer = nullptr;
          that.m_Allocation = nullptr;
          that.m_Descriptor = vk::DescriptorBufferInfo{};
          that.m_Size = 0;
          that.m_Usage = {};
+         that.m_Serial = 0;
+         that.m_WrittenEnd = 0;
+         that.m_InUseEnd = 0;
+         that.m_InUseValue = 0;
       }
       return *this;
    }
 
 
    VulkanBuffer::~VulkanBuffer() {
+      Destroy();
+   }
+
+
+   void VulkanBuffer::Destroy() {
       if (m_Device && m_Buffer) {
-         VulkanMemoryAllocator::Get().destroyBuffer(m_Buffer, m_Allocation);
+         // Submitted work (or staged copies into the buffer) may still be using it, so destroy it once that has completed.
+         // (staged copies are always submitted ahead of the next graphics queue submission, so are covered too)
+         m_Device->DeferDestroy([buffer = m_Buffer, allocation = m_Allocation] {
+            VulkanMemoryAllocator::Get().destroyBuffer(buffer, allocation);
+         });
          m_Buffer = nullptr;
          m_Allocation = nullptr;
       }
@@ -64,15 +80,16 @@ namespace Pikzel {
 
 
    void VulkanBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      PKZL_CORE_ASSERT(offset + size <= m_Size, "VulkanBuffer::CopyFromHost() buffer overrun!");
       void* pDataDst = VulkanMemoryAllocator::Get().mapMemory(m_Allocation);
-      memcpy(pDataDst, pData, static_cast<size_t>(size));
+      memcpy(static_cast<std::byte*>(pDataDst) + offset, pData, static_cast<size_t>(size));
       VulkanMemoryAllocator::Get().unmapMemory(m_Allocation);
    }
 
 
    void VulkanBuffer::CopyFromBuffer(vk::Buffer src, const vk::DeviceSize srcOffset, const vk::DeviceSize dstOffset, const vk::DeviceSize size) {
       PKZL_ASSERT(dstOffset + size <= m_Size, "VulkanBuffer::CopyFromBuffer() buffer overrun!");
-      m_Device->SubmitSingleTimeCommands(m_Device->GetTransferQueue(), [this, src, srcOffset, dstOffset, size] (vk::CommandBuffer cmd) {
+      m_Device->SubmitSingleTimeCommands(m_Device->GetGraphicsQueue(), [this, src, srcOffset, dstOffset, size] (vk::CommandBuffer cmd) {
          vk::BufferCopy copyRegion = {
             srcOffset,
             dstOffset,
@@ -80,6 +97,27 @@ namespace Pikzel {
          };
          cmd.copyBuffer(src, m_Buffer, copyRegion);
       });
+      m_WrittenEnd = std::max(m_WrittenEnd, dstOffset + size);
+   }
+
+
+   void VulkanBuffer::CopyFromHostStaged(const uint64_t offset, const uint64_t size, const void* pData) {
+      PKZL_CORE_ASSERT(offset + size <= m_Size, "VulkanBuffer::CopyFromHostStaged() buffer overrun!");
+
+      // Graphics work that has been submitted can only be reading bytes that were written before it was submitted.
+      // Copies to anywhere else (e.g. appending to a buffer, or filling a new one) do not need to wait for it.
+      const uint64_t submittedValue = m_Device->GetTimeline().GetSubmittedValue();
+      if (m_InUseValue != submittedValue) {
+         m_InUseValue = submittedValue;
+         m_InUseEnd = m_WrittenEnd;
+      }
+      m_WrittenEnd = std::max(m_WrittenEnd, offset + size);
+      m_Device->GetUploader().CopyToBuffer(m_Buffer, offset, size, pData, offset < m_InUseEnd ? m_InUseValue : 0);
+   }
+
+
+   uint64_t VulkanBuffer::GetSerial() const {
+      return m_Serial;
    }
 
 
@@ -98,9 +136,7 @@ namespace Pikzel {
 
 
    void VulkanVertexBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
-      VulkanBuffer stagingBuffer(m_Buffer.m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
-      stagingBuffer.CopyFromHost(0, size, pData);
-      m_Buffer.CopyFromBuffer(stagingBuffer.m_Buffer, 0, offset, size);
+      m_Buffer.CopyFromHostStaged(offset, size, pData);
    }
 
 
@@ -121,17 +157,26 @@ namespace Pikzel {
 
 
    VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint32_t* indices)
-   : m_Buffer {device, sizeof(uint32_t) * count, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vma::MemoryUsage::eGpuOnly}
+   : VulkanIndexBuffer {device, count, IndexType::UInt32, indices}
+   {}
+
+
+   VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint16_t* indices)
+   : VulkanIndexBuffer {device, count, IndexType::UInt16, indices}
+   {}
+
+
+   VulkanIndexBuffer::VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const IndexType indexType, const void* indices)
+   : m_Buffer {device, IndexTypeSize(indexType) * count, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vma::MemoryUsage::eGpuOnly}
    , m_Count {count}
+   , m_IndexType {indexType}
    {
-      CopyFromHost(0, sizeof(uint32_t) * count, indices);
+      CopyFromHost(0, IndexTypeSize(indexType) * count, indices);
    }
 
 
    void VulkanIndexBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
-      VulkanBuffer stagingBuffer(m_Buffer.m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
-      stagingBuffer.CopyFromHost(0, size, pData);
-      m_Buffer.CopyFromBuffer(stagingBuffer.m_Buffer, 0, offset, size);
+      m_Buffer.CopyFromHostStaged(offset, size, pData);
    }
 
 
@@ -140,11 +185,21 @@ namespace Pikzel {
    }
 
 
+   IndexType VulkanIndexBuffer::GetIndexType() const {
+      return m_IndexType;
+   }
+
+
    vk::Buffer VulkanIndexBuffer::GetVkBuffer() const {
       return m_Buffer.m_Buffer;
    }
 
 
+   vk::IndexType VulkanIndexBuffer::GetVkIndexType() const {
+      return (m_IndexType == IndexType::UInt16) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+   }
+
+
    VulkanUniformBuffer::VulkanUniformBuffer(std::shared_ptr<VulkanDevice> device, uint32_t size)
    : m_Buffer {device, size, vk::BufferUsageFlagBits::eUniformBuffer, vma::MemoryUsage::eCpuToGpu}
    {}
@@ -158,7 +213,7 @@ namespace Pikzel {
 
 
    void VulkanUniformBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
-      m_Buffer.CopyFromHost(0, size, pData);
+      m_Buffer.CopyFromHost(offset, size, pData);
    }
 
 
@@ -166,4 +221,74 @@ namespace Pikzel {
       return m_Buffer.m_Buffer;
    }
 
+
+   uint64_t VulkanUniformBuffer::GetSerial() const {
+      return m_Buffer.GetSerial();
+   }
+
+
+
+   // Storage buffers are host visible (like uniform buffers) so that they can be updated every frame without a staging copy.
+   // They are also transfer destinations, so that they can be filled on the GPU (see ComputeContext::Fill())
+   VulkanStorageBuffer::VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, uint32_t size)
+   : m_Buffer {device, size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eCpuToGpu}
+   {}
+
+
+   VulkanStorageBuffer::VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size, const void* data)
+   : m_Buffer {device, size, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eCpuToGpu}
+   {
+      CopyFromHost(0, size, data);
+   }
+
+
+   void VulkanStorageBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      m_Buffer.CopyFromHost(offset, size, pData);
+   }
+
+
+   vk::Buffer VulkanStorageBuffer::GetVkBuffer() const {
+      return m_Buffer.m_Buffer;
+   }
+
+
+   uint64_t VulkanStorageBuffer::GetSerial() const {
+      return m_Buffer.GetSerial();
+   }
+
+
+   // Indirect buffers are also usable as storage buffers, so that the draw commands can be written by a compute shader
+   VulkanIndirectBuffer::VulkanIndirectBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count)
+   : m_Buffer {device, sizeof(DrawIndexedIndirectCommand) * count, vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, vma::MemoryUsage::eCpuToGpu}
+   , m_Count {count}
+   {}
+
+
+   VulkanIndirectBuffer::VulkanIndirectBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const DrawIndexedIndirectCommand* commands)
+   : m_Buffer {device, sizeof(DrawIndexedIndirectCommand) * count, vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, vma::MemoryUsage::eCpuToGpu}
+   , m_Count {count}
+   {
+      CopyFromHost(0, sizeof(DrawIndexedIndirectCommand) * count, commands);
+   }
+
+
+   void VulkanIndirectBuffer::CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) {
+      m_Buffer.CopyFromHost(offset, size, pData);
+   }
+
+
+   uint32_t VulkanIndirectBuffer::GetCount() const {
+      return m_Count;
+   }
+
+
+   vk::Buffer VulkanIndirectBuffer::GetVkBuffer() const {
+      return m_Buffer.m_Buffer;
+   }
+
+
+   uint64_t VulkanIndirectBuffer::GetSerial() const {
+      return m_Buffer.GetSerial();
+   }
+
 }
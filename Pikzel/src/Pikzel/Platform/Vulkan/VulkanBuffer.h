@@ -27,6 +27,17 @@ namespace Pikzel {
       // Copy memory from GPU buffer
       void CopyFromBuffer(vk::Buffer src, const vk::DeviceSize srcOffset, const vk::DeviceSize dstOffset, const vk::DeviceSize size);
 
+      // Copy memory from host (pData) to the GPU buffer via the device's staging ring (see VulkanUploader).
+      // The copy happens on the GPU the next time the uploader is flushed.
+      // Buffer must have been created with eTransferDst usage
+      void CopyFromHostStaged(const uint64_t offset, const uint64_t size, const void* pData);
+
+      // Identifies this buffer (see VulkanDevice::NewSerial())
+      uint64_t GetSerial() const;
+
+   private:
+      void Destroy();
+
    public:
       vk::DescriptorBufferInfo m_Descriptor;
       std::shared_ptr<VulkanDevice> m_Device;
@@ -34,6 +45,12 @@ namespace Pikzel {
       vk::BufferUsageFlags m_Usage;
       vk::Buffer m_Buffer;
       vma::Allocation m_Allocation;
+      uint64_t m_Serial = 0;
+
+      // Staged copies only have to wait for graphics work that might be reading the range that they overwrite (see CopyFromHostStaged())
+      vk::DeviceSize m_WrittenEnd = 0;     // bytes [0, m_WrittenEnd) have been written by the GPU
+      vk::DeviceSize m_InUseEnd = 0;       // bytes [0, m_InUseEnd) were written before graphics submission m_InUseValue (of the device timeline), so it may be reading them
+      uint64_t m_InUseValue = 0;
    };
 
 
@@ -59,18 +76,24 @@ namespace Pikzel {
    class VulkanIndexBuffer : public IndexBuffer {
    public:
 
-      // TODO: support 64 bit indices (?)
       VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint32_t* indices);
+      VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const uint16_t* indices);
 
       virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
 
       virtual uint32_t GetCount() const override;
+      virtual IndexType GetIndexType() const override;
 
       vk::Buffer GetVkBuffer() const;
+      vk::IndexType GetVkIndexType() const;
+
+   private:
+      VulkanIndexBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const IndexType indexType, const void* indices);
 
    private:
       VulkanBuffer m_Buffer;
       uint32_t m_Count;
+      IndexType m_IndexType;
    };
 
 
@@ -83,9 +106,45 @@ namespace Pikzel {
       virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
 
       vk::Buffer GetVkBuffer() const;
+      uint64_t GetSerial() const;
+
+   private:
+      VulkanBuffer m_Buffer;
+   };
+
+
+   class VulkanStorageBuffer : public StorageBuffer {
+   public:
+
+      VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size);
+      VulkanStorageBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t size, const void* data);
+
+      virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
+
+      vk::Buffer GetVkBuffer() const;
+      uint64_t GetSerial() const;
 
    private:
       VulkanBuffer m_Buffer;
    };
 
+
+   class VulkanIndirectBuffer : public IndirectBuffer {
+   public:
+
+      VulkanIndirectBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count);
+      VulkanIndirectBuffer(std::shared_ptr<VulkanDevice> device, const uint32_t count, const DrawIndexedIndirectCommand* commands);
+
+      virtual void CopyFromHost(const uint64_t offset, const uint64_t size, const void* pData) override;
+
+      virtual uint32_t GetCount() const override;
+
+      vk::Buffer GetVkBuffer() const;
+      uint64_t GetSerial() const;
+
+   private:
+      VulkanBuffer m_Buffer;
+      uint32_t m_Count;
+   };
+
 }
@@ -13,7 +13,6 @@ namespace Pikzel {
       CreateCommandPool();
       CreateCommandBuffers(1);
       CreateSyncObjects();
-      CreatePipelineCache();
    }
 
 
@@ -23,7 +22,6 @@ namespace Pikzel {
          if (m_Pipeline) {
             Unbind(*m_Pipeline);
          }
-         DestroyPipelineCache();
          DestroySyncObjects();
          DestroyCommandBuffers();
          DestroyCommandPool();
@@ -32,19 +30,43 @@ namespace Pikzel {
 
 
    void VulkanComputeContext::Begin() {
-      auto result = m_Device->GetVkDevice().waitForFences(GetFence()->GetVkFence(), true, UINT64_MAX);
+      m_Timeline->Wait(m_Timeline->GetSubmittedValue());
       GetVkCommandBuffer().begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
+
+      // compute (or a Fill()) must not overwrite buffers that previously submitted work (e.g. last frame's draws) is still reading as draw commands, vertex data, or in shaders
+      vk::MemoryBarrier barrier = {
+         vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eShaderRead /*srcAccessMask*/,
+         vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite                                                 /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, {}, barrier, nullptr, nullptr);
    }
 
 
    void VulkanComputeContext::End() {
+      // make compute results visible to subsequently submitted work that reads them as draw commands, vertex data, or in shaders.
+      vk::MemoryBarrier barrier = {
+         vk::AccessFlagBits::eShaderWrite                                                                                    /*srcAccessMask*/,
+         vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eShaderRead /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllCommands, {}, barrier, nullptr, nullptr);
       GetVkCommandBuffer().end();
 
-      vk::SubmitInfo si;
-      si.commandBufferCount = 1;
-      si.pCommandBuffers = m_CommandBuffers.data();
-      m_Device->GetVkDevice().resetFences(GetFence()->GetVkFence());
-      m_Device->GetComputeQueue().submit(si, GetFence()->GetVkFence());
+      // Staged uploads must be submitted before the work that uses them.
+      // Uploads are made visible to (and owned by) the graphics queue, so if that is not also the compute queue, they have to be waited for.
+      if (m_Device->GetComputeQueueFamilyIndex() == m_Device->GetGraphicsQueueFamilyIndex()) {
+         m_Device->GetUploader().Flush();
+      } else {
+         m_Device->GetUploader().WaitIdle();
+      }
+
+      m_Device->Submit(m_Device->GetComputeQueue(), GetVkCommandBuffer(), *m_Timeline);
+
+      // The barriers above only order work that is submitted to the same queue.
+      // If compute and graphics queues are different, then the only way to be sure that compute results are ready is to wait.
+      // (which is also what makes it safe to destroy resources used by the compute work without waiting for the graphics queue's timeline)
+      if (m_Device->GetComputeQueueFamilyIndex() != m_Device->GetGraphicsQueueFamilyIndex()) {
+         m_Timeline->Wait(m_Timeline->GetSubmittedValue());
+      }
    }
 
 
@@ -57,22 +79,55 @@ namespace Pikzel {
          VK_WHOLE_SIZE                                                 /*range*/
       };
 
-      vk::WriteDescriptorSet uniformBufferWrite = {
-         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
-         resource.Binding                                        /*dstBinding*/,
-         0                                                       /*dstArrayElement*/,
-         resource.GetCount()                                     /*descriptorCount*/,
-         resource.Type                                           /*descriptorType*/,
-         nullptr                                                 /*pImageInfo*/,
-         &uniformBufferDescriptor                                /*pBufferInfo*/,
-         nullptr                                                 /*pTexelBufferView*/
+      m_Pipeline->SetDescriptor(resource, uniformBufferDescriptor, static_cast<const VulkanUniformBuffer&>(buffer).GetSerial());
+   }
+
+
+   void VulkanComputeContext::Unbind(const UniformBuffer&) {}
+
+
+   void VulkanComputeContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+
+      vk::DescriptorBufferInfo storageBufferDescriptor = {
+         static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer() /*buffer*/,
+         0                                                             /*offset*/,
+         VK_WHOLE_SIZE                                                 /*range*/
       };
 
-      m_Device->GetVkDevice().updateDescriptorSets(uniformBufferWrite, nullptr);
+      m_Pipeline->SetDescriptor(resource, storageBufferDescriptor, static_cast<const VulkanStorageBuffer&>(buffer).GetSerial());
    }
 
 
-   void VulkanComputeContext::Unbind(const UniformBuffer&) {}
+   void VulkanComputeContext::Unbind(const StorageBuffer&) {}
+
+
+   void VulkanComputeContext::Bind(const Id resourceId, const IndirectBuffer& buffer) {
+      const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+
+      vk::DescriptorBufferInfo indirectBufferDescriptor = {
+         static_cast<const VulkanIndirectBuffer&>(buffer).GetVkBuffer() /*buffer*/,
+         0                                                              /*offset*/,
+         VK_WHOLE_SIZE                                                  /*range*/
+      };
+
+      m_Pipeline->SetDescriptor(resource, indirectBufferDescriptor, static_cast<const VulkanIndirectBuffer&>(buffer).GetSerial());
+   }
+
+
+   void VulkanComputeContext::Unbind(const IndirectBuffer&) {}
+
+
+   void VulkanComputeContext::Fill(const StorageBuffer& buffer, const uint32_t value) {
+      GetVkCommandBuffer().fillBuffer(static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer(), 0, VK_WHOLE_SIZE, value);
+
+      // compute shaders dispatched after this must see the filled values
+      vk::MemoryBarrier barrier = {
+         vk::AccessFlagBits::eTransferWrite                                  /*srcAccessMask*/,
+         vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite  /*dstAccessMask*/
+      };
+      GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, barrier, nullptr, nullptr);
+   }
 
 
    void VulkanComputeContext::Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) {
@@ -86,18 +141,7 @@ namespace Pikzel {
          resource.Type == vk::DescriptorType::eStorageImage? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal
       };
 
-      vk::WriteDescriptorSet textureSamplersWrite = {
-         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
-         resource.Binding                                        /*dstBinding*/,
-         0                                                       /*dstArrayElement*/,
-         resource.GetCount()                                     /*descriptorCount*/,
-         resource.Type                                           /*descriptorType*/,
-         &textureImageDescriptor                                 /*pImageInfo*/,
-         nullptr                                                 /*pBufferInfo*/,
-         nullptr                                                 /*pTexelBufferView*/
-      };
-
-      m_Device->GetVkDevice().updateDescriptorSets(textureSamplersWrite, nullptr);
+      m_Pipeline->SetDescriptor(resource, textureImageDescriptor, static_cast<const VulkanTexture&>(texture).GetSerial());
    }
 
 
@@ -433,7 +477,7 @@ namespace Pikzel {
 
 
    vk::PipelineCache VulkanComputeContext::GetVkPipelineCache() const {
-      return m_PipelineCache;
+      return m_Device->GetVkPipelineCache();
    }
 
 
@@ -442,8 +486,8 @@ namespace Pikzel {
    }
 
 
-   std::shared_ptr<VulkanFence> VulkanComputeContext::GetFence() {
-      return m_InFlightFence;
+   std::shared_ptr<VulkanTimeline> VulkanComputeContext::GetTimeline() {
+      return m_Timeline;
    }
 
 
@@ -508,32 +552,20 @@ namespace Pikzel {
    }
 
 
-   void VulkanComputeContext::CreatePipelineCache() {
-      m_PipelineCache = m_Device->GetVkDevice().createPipelineCache({});
-   }
-
-
-   void VulkanComputeContext::DestroyPipelineCache() {
-      if (m_Device && m_PipelineCache) {
-         m_Device->GetVkDevice().destroy(m_PipelineCache);
-      }
-   }
-
-
    void VulkanComputeContext::CreateSyncObjects() {
-      m_InFlightFence = std::make_shared<VulkanFence>(m_Device->GetVkDevice());
+      m_Timeline = std::make_shared<VulkanTimeline>(m_Device->GetVkDevice());
    }
 
 
    void VulkanComputeContext::DestroySyncObjects() {
-      if (m_Device && m_InFlightFence) {
-         m_InFlightFence = nullptr;
+      if (m_Device && m_Timeline) {
+         m_Timeline = nullptr;
       }
    }
 
 
    void VulkanComputeContext::BindDescriptorSets() {
-      m_Pipeline->BindDescriptorSets(GetVkCommandBuffer(), GetFence());
+      m_Pipeline->BindDescriptorSets(GetVkCommandBuffer(), GetTimeline());
    }
 
 
@@ -2,7 +2,7 @@
 
 #include "DescriptorBinding.h"
 #include "VulkanDevice.h"
-#include "VulkanFence.h"
+#include "VulkanTimeline.h"
 #include "VulkanImage.h"
 
 #include "Pikzel/Renderer/ComputeContext.h"
@@ -24,6 +24,14 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
+      virtual void Bind(const Id resourceId, const IndirectBuffer& buffer) override;
+      virtual void Unbind(const IndirectBuffer& buffer) override;
+
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -77,7 +85,7 @@ namespace Pikzel {
       vk::PipelineCache GetVkPipelineCache() const;
 
       vk::CommandBuffer GetVkCommandBuffer();
-      std::shared_ptr<VulkanFence> GetFence();
+      std::shared_ptr<VulkanTimeline> GetTimeline();
 
    protected:
       vk::DescriptorPool CreateDescriptorPool(const vk::ArrayProxy<const DescriptorBinding>& descriptorBindings, size_t maxSets);
@@ -89,9 +97,6 @@ namespace Pikzel {
       void CreateCommandBuffers(const uint32_t commandBufferCount);
       void DestroyCommandBuffers();
 
-      void CreatePipelineCache();
-      void DestroyPipelineCache();
-
       void CreateSyncObjects();
       void DestroySyncObjects();
 
@@ -103,9 +108,8 @@ namespace Pikzel {
 
       vk::CommandPool m_CommandPool;
       std::vector<vk::CommandBuffer> m_CommandBuffers;
-      std::shared_ptr<VulkanFence> m_InFlightFence;
+      std::shared_ptr<VulkanTimeline> m_Timeline;
 
-      vk::PipelineCache m_PipelineCache;
       VulkanPipeline* m_Pipeline = nullptr;       // currently bound pipeline  (TODO: should be a shared_ptr?)
    };
 
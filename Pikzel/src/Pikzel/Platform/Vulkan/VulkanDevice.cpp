@@ -1,7 +1,13 @@
 #include "VulkanDevice.h"
 #include "VulkanUtility.h"
+#include "Pikzel/Core/CheckedFile.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
 #include <set>
+#include <span>
 
 namespace Pikzel {
 
@@ -11,10 +17,18 @@ namespace Pikzel {
       SelectPhysicalDevice(surface);
       CreateDevice();
       CreateCommandPool();
+      CreateSyncObjects();
+      CreateTextureTable();
+      CreatePipelineCache();
    }
 
 
    VulkanDevice::~VulkanDevice() {
+      CollectGarbage(true);
+      DestroyPipelineCache();
+      DestroyTextureTable();
+      DestroySyncObjects();
+      DestroyUploader();
       DestroyCommandPool();
       DestroyDevice();
    }
@@ -47,8 +61,9 @@ namespace Pikzel {
 
 
    void VulkanDevice::EnablePhysicalDeviceFeatures() {
-      auto result = m_PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan13Features>();
+      auto result = m_PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features>();
       auto availableFeatures = result.get<vk::PhysicalDeviceFeatures2>().features;
+      auto availableVulkan12Features = result.get<vk::PhysicalDeviceVulkan12Features>();
       auto availableVulkan13Features = result.get<vk::PhysicalDeviceVulkan13Features>();
 
 
@@ -61,6 +76,31 @@ namespace Pikzel {
       if (availableFeatures.imageCubeArray) {
          m_EnabledPhysicalDeviceFeatures.features.setImageCubeArray(true);
       }
+      if (availableFeatures.multiDrawIndirect) {
+         m_EnabledPhysicalDeviceFeatures.features.setMultiDrawIndirect(true);
+      }
+      if (availableFeatures.drawIndirectFirstInstance) {
+         m_EnabledPhysicalDeviceFeatures.features.setDrawIndirectFirstInstance(true);
+      }
+      if (availableVulkan12Features.drawIndirectCount) {
+         m_EnabledPhysicalDeviceVulkan12Features.setDrawIndirectCount(true);
+      }
+      PKZL_CORE_ASSERT(availableVulkan12Features.timelineSemaphore, "Vulkan device does not support timeline semaphores!");  // (required by Vulkan 1.2 and later)
+      m_EnabledPhysicalDeviceVulkan12Features.setTimelineSemaphore(true);
+      if (
+         availableVulkan12Features.runtimeDescriptorArray &&
+         availableVulkan12Features.descriptorBindingPartiallyBound &&
+         availableVulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+         availableVulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+         availableVulkan12Features.shaderSampledImageArrayNonUniformIndexing
+      ) {
+         // everything needed for the bindless texture table (see VulkanTextureTable)
+         m_EnabledPhysicalDeviceVulkan12Features.setRuntimeDescriptorArray(true);
+         m_EnabledPhysicalDeviceVulkan12Features.setDescriptorBindingPartiallyBound(true);
+         m_EnabledPhysicalDeviceVulkan12Features.setDescriptorBindingSampledImageUpdateAfterBind(true);
+         m_EnabledPhysicalDeviceVulkan12Features.setDescriptorBindingUpdateUnusedWhilePending(true);
+         m_EnabledPhysicalDeviceVulkan12Features.setShaderSampledImageArrayNonUniformIndexing(true);
+      }
       if (availableVulkan13Features.maintenance4) {
          m_EnabledPhysicalDeviceVulkan13Features.setMaintenance4(true);
       }
@@ -100,6 +140,9 @@ namespace Pikzel {
       if (m_QueueFamilyIndices.ComputeFamily.has_value()) {
          uniqueQueueFamilies.insert(m_QueueFamilyIndices.ComputeFamily.value());
       }
+      if (m_QueueFamilyIndices.TransferFamily.has_value()) {
+         uniqueQueueFamilies.insert(m_QueueFamilyIndices.TransferFamily.value());
+      }
 
       for (uint32_t queueFamily : uniqueQueueFamilies) {
          deviceQueueCIs.emplace_back(
@@ -124,7 +167,7 @@ namespace Pikzel {
          deviceExtensions.data()                          /*ppEnabledExtensionNames*/,
          nullptr                                          /*pEnabledFeatures*/
       };
-      ci.pNext = &vk::StructureChain(m_EnabledPhysicalDeviceFeatures, m_EnabledPhysicalDeviceVulkan13Features).get<vk::PhysicalDeviceFeatures2>();
+      ci.pNext = &vk::StructureChain(m_EnabledPhysicalDeviceFeatures, m_EnabledPhysicalDeviceVulkan12Features, m_EnabledPhysicalDeviceVulkan13Features).get<vk::PhysicalDeviceFeatures2>();
 
 #ifdef PKZL_DEBUG
       std::vector<const char*> layers = {"VK_LAYER_KHRONOS_validation"};
@@ -144,7 +187,7 @@ namespace Pikzel {
          m_ComputeQueue = m_Device.getQueue(m_QueueFamilyIndices.ComputeFamily.value(), 0);
       }
       if (m_QueueFamilyIndices.TransferFamily.has_value()) {
-         m_TransferQueue = m_Device.getQueue(m_QueueFamilyIndices.ComputeFamily.value(), 0);
+         m_TransferQueue = m_Device.getQueue(m_QueueFamilyIndices.TransferFamily.value(), 0);
       }
    }
 
@@ -173,6 +216,154 @@ namespace Pikzel {
    }
 
 
+   void VulkanDevice::CreateSyncObjects() {
+      m_Timeline = std::make_unique<VulkanTimeline>(m_Device);
+   }
+
+
+   void VulkanDevice::DestroySyncObjects() {
+      m_Timeline = nullptr;
+   }
+
+
+   void VulkanDevice::CreateTextureTable() {
+      if (m_EnabledPhysicalDeviceVulkan12Features.runtimeDescriptorArray) {
+         // Leave some room under the device limits for the other textures that a pipeline using the table might have
+         constexpr uint32_t reserved = 64;
+         auto properties = m_PhysicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>().get<vk::PhysicalDeviceVulkan12Properties>();
+         uint32_t capacity = std::min({
+            VulkanTextureTable::MaxTextures,
+            properties.maxDescriptorSetUpdateAfterBindSampledImages,
+            properties.maxDescriptorSetUpdateAfterBindSamplers,
+            properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            properties.maxPerStageDescriptorUpdateAfterBindSamplers
+         });
+         if (capacity > reserved) {
+            m_TextureTable = std::make_unique<VulkanTextureTable>(m_Device, capacity - reserved);
+         }
+      }
+   }
+
+
+   void VulkanDevice::DestroyTextureTable() {
+      m_TextureTable = nullptr;
+   }
+
+
+   // The pipeline cache file is this header, followed by the data from vk::Device::getPipelineCacheData().
+   // The driver checks its own header in the data, but drivers have been known to crash on data that it should have
+   // rejected, so the file is only handed to the driver if it was written for this exact device and driver, and is intact.
+   struct PipelineCacheFileHeader {
+      char magic[4];
+      uint32_t version;
+      uint32_t vendorID;
+      uint32_t deviceID;
+      uint32_t driverVersion;
+      uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+      uint64_t dataSize;
+      uint64_t checksum;
+   };
+
+   static constexpr char PipelineCacheFileMagic[4] = {'P', 'K', 'P', 'C'};
+   static constexpr uint32_t PipelineCacheFileVersion = 1;
+
+
+   void VulkanDevice::CreatePipelineCache() {
+      m_PipelineCachePath = std::format("VulkanPipelineCache-{:04x}-{:04x}.bin", m_PhysicalDeviceProperties.vendorID, m_PhysicalDeviceProperties.deviceID);
+      std::vector<uint8_t> data = LoadPipelineCacheData();
+      vk::PipelineCacheCreateInfo ci = {
+         {}            /*flags*/,
+         data.size()   /*initialDataSize*/,
+         data.data()   /*pInitialData*/
+      };
+      m_PipelineCache = m_Device.createPipelineCache(ci);
+   }
+
+
+   void VulkanDevice::DestroyPipelineCache() {
+      if (m_PipelineCache) {
+         try {
+            SavePipelineCacheData();
+         } catch (const std::exception& err) {
+            PKZL_CORE_LOG_WARN("Could not save pipeline cache to '{0}': {1}", m_PipelineCachePath.string(), err.what());
+         }
+         m_Device.destroy(m_PipelineCache);
+         m_PipelineCache = nullptr;
+      }
+   }
+
+
+   std::vector<uint8_t> VulkanDevice::LoadPipelineCacheData() const {
+      PipelineCacheFileHeader header;
+      auto data = ReadCheckedFile(m_PipelineCachePath, header, [this] (const PipelineCacheFileHeader& fileHeader) {
+         if (
+            (std::memcmp(fileHeader.magic, PipelineCacheFileMagic, sizeof(PipelineCacheFileMagic)) != 0) ||
+            (fileHeader.version != PipelineCacheFileVersion) ||
+            (fileHeader.vendorID != m_PhysicalDeviceProperties.vendorID) ||
+            (fileHeader.deviceID != m_PhysicalDeviceProperties.deviceID) ||
+            (fileHeader.driverVersion != m_PhysicalDeviceProperties.driverVersion) ||
+            (std::memcmp(fileHeader.pipelineCacheUUID, m_PhysicalDeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0)
+         ) {
+            PKZL_CORE_LOG_INFO("Pipeline cache '{0}' is for a different device or driver.  It will be rebuilt", m_PipelineCachePath.string());
+            return false;
+         }
+         return true;
+      });
+      return data ? std::move(*data) : std::vector<uint8_t> {};
+   }
+
+
+   void VulkanDevice::SavePipelineCacheData() const {
+      std::vector<uint8_t> data = m_Device.getPipelineCacheData(m_PipelineCache);
+
+      PipelineCacheFileHeader header;
+      std::memcpy(header.magic, PipelineCacheFileMagic, sizeof(PipelineCacheFileMagic));
+      header.version = PipelineCacheFileVersion;
+      header.vendorID = m_PhysicalDeviceProperties.vendorID;
+      header.deviceID = m_PhysicalDeviceProperties.deviceID;
+      header.driverVersion = m_PhysicalDeviceProperties.driverVersion;
+      std::memcpy(header.pipelineCacheUUID, m_PhysicalDeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+      WriteCheckedFile(m_PipelineCachePath, header, std::as_bytes(std::span {data}));
+   }
+
+
+   vk::PipelineCache VulkanDevice::GetVkPipelineCache() const {
+      return m_PipelineCache;
+   }
+
+
+   bool VulkanDevice::IsBindlessSupported() const {
+      return m_TextureTable != nullptr;
+   }
+
+
+   VulkanTextureTable& VulkanDevice::GetTextureTable() {
+      PKZL_CORE_ASSERT(m_TextureTable, "VulkanDevice does not support bindless textures!");
+      return *m_TextureTable;
+   }
+
+
+   void VulkanDevice::CreateUploader() {
+      m_Uploader = std::make_unique<VulkanUploader>(*this);
+   }
+
+
+   void VulkanDevice::DestroyUploader() {
+      m_Uploader = nullptr;
+   }
+
+
+   VulkanUploader& VulkanDevice::GetUploader() {
+      PKZL_CORE_ASSERT(m_Uploader, "VulkanDevice uploader has not been created!");
+      return *m_Uploader;
+   }
+
+
+   VulkanTimeline& VulkanDevice::GetTimeline() {
+      return *m_Timeline;
+   }
+
+
    vk::Instance VulkanDevice::GetVkInstance() const {
       return m_Instance;
    }
@@ -245,6 +436,17 @@ namespace Pikzel {
 
 
    void VulkanDevice::SubmitSingleTimeCommands(vk::Queue queue, const std::function<void(vk::CommandBuffer)>& action) {
+      // The commands may depend on staged uploads (e.g. a copy from a texture whose upload has been recorded but not yet submitted),
+      // so submit those first.  If queue is not the graphics queue, then there is no ordering between the two, so wait for them instead.
+      // Likewise if uploads go via the transfer queue, as then graphics work only waits for the copies at the stages that draws read buffers in (not at transfer).
+      if (m_Uploader && m_Uploader->IsBusy()) {
+         if ((queue == m_GraphicsQueue) && (GetTransferQueueFamilyIndex() == GetGraphicsQueueFamilyIndex())) {
+            m_Uploader->Flush();
+         } else {
+            m_Uploader->WaitIdle();
+         }
+      }
+
       std::vector<vk::CommandBuffer> commandBuffers = m_Device.allocateCommandBuffers({
          m_CommandPool                    /*commandPool*/,
          vk::CommandBufferLevel::ePrimary /*level*/,
@@ -252,6 +454,11 @@ namespace Pikzel {
       });
 
       commandBuffers[0].begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+      vk::MemoryBarrier barrier = {
+         vk::AccessFlagBits::eMemoryWrite                                   /*srcAccessMask*/,
+         vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite /*dstAccessMask*/
+      };
+      commandBuffers[0].pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, barrier, nullptr, nullptr);
       action(commandBuffers[0]);
       commandBuffers[0].end();
 
@@ -270,4 +477,67 @@ namespace Pikzel {
          cmd.pipelineBarrier(srcStageMask, dstStageMask, {}, nullptr, nullptr, barriers);
       });
    }
+
+
+   void VulkanDevice::Submit(vk::Queue queue, vk::CommandBuffer commandBuffer, VulkanTimeline& timeline, vk::Semaphore waitSemaphore/*= nullptr*/, vk::PipelineStageFlags waitStage/*= {}*/, vk::Semaphore signalSemaphore/*= nullptr*/) {
+      std::array<vk::Semaphore, 3> signalSemaphores;
+      std::array<uint64_t, 3> signalValues;
+      uint32_t signalCount = 0;
+      if (signalSemaphore) {
+         signalSemaphores[signalCount] = signalSemaphore;
+         signalValues[signalCount++] = 0; // binary semaphore, value is ignored
+      }
+      signalSemaphores[signalCount] = timeline.GetVkSemaphore();
+      signalValues[signalCount++] = timeline.Submit();
+
+      // Signals of the device timeline must happen in increasing order, which they do so long as they are all on the same queue
+      if (queue == m_GraphicsQueue) {
+         signalSemaphores[signalCount] = m_Timeline->GetVkSemaphore();
+         signalValues[signalCount++] = m_Timeline->Submit();
+      }
+
+      const uint64_t waitValue = 0; // binary semaphore, value is ignored
+      vk::TimelineSemaphoreSubmitInfo timelineSI = {
+         waitSemaphore ? 1u : 0u   /*waitSemaphoreValueCount*/,
+         &waitValue                /*pWaitSemaphoreValues*/,
+         signalCount               /*signalSemaphoreValueCount*/,
+         signalValues.data()       /*pSignalSemaphoreValues*/
+      };
+      vk::SubmitInfo si = {
+         waitSemaphore ? 1u : 0u   /*waitSemaphoreCount*/,
+         &waitSemaphore            /*pWaitSemaphores*/,
+         &waitStage                /*pWaitDstStageMask*/,
+         1                         /*commandBufferCount*/,
+         &commandBuffer            /*pCommandBuffers*/,
+         signalCount               /*signalSemaphoreCount*/,
+         signalSemaphores.data()   /*pSignalSemaphores*/
+      };
+      si.pNext = &timelineSI;
+      queue.submit(si, nullptr);
+   }
+
+
+   void VulkanDevice::DeferDestroy(std::function<void()> destroy) {
+      m_DeferredDestroys.emplace_back(m_Timeline->GetPendingValue(), std::move(destroy));
+   }
+
+
+   void VulkanDevice::CollectGarbage(const bool wait/*= false*/) {
+      if (wait && !m_DeferredDestroys.empty()) {
+         m_Device.waitIdle();
+         while (!m_DeferredDestroys.empty()) {
+            // (pop before calling, as a destroy could defer another one)
+            auto destroy = std::move(m_DeferredDestroys.front().second);
+            m_DeferredDestroys.pop_front();
+            destroy();
+         }
+         return;
+      }
+      while (!m_DeferredDestroys.empty() && m_Timeline->IsComplete(m_DeferredDestroys.front().first)) {
+         auto destroy = std::move(m_DeferredDestroys.front().second);
+         m_DeferredDestroys.pop_front();
+         destroy();
+      }
+   }
+
 }
@@ -1,8 +1,18 @@
 #pragma once
 
 #include "QueueFamilyIndices.h"
+#include "VulkanTextureTable.h"
+#include "VulkanTimeline.h"
+#include "VulkanUploader.h"
+
 #include <vulkan/vulkan.hpp>
 
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <utility>
+
 namespace Pikzel {
 
    class VulkanDevice {
@@ -30,6 +40,10 @@ namespace Pikzel {
          return m_EnabledPhysicalDeviceFeatures.features;
       }
 
+      vk::PhysicalDeviceVulkan12Features GetEnabledPhysicalDeviceVulkan12Features() const {
+         return m_EnabledPhysicalDeviceVulkan12Features;
+      }
+
       vk::PhysicalDeviceVulkan13Features GetEnabledPhysicalDeviceVulkan13Features() const {
          return m_EnabledPhysicalDeviceVulkan13Features;
       }
@@ -38,6 +52,40 @@ namespace Pikzel {
 
       void PipelineBarrier(vk::PipelineStageFlags srcStageMask, vk::PipelineStageFlags dstStageMask, const vk::ArrayProxy<const vk::ImageMemoryBarrier>& barriers);
 
+      // Submit commandBuffer to queue, signalling the next value of timeline (and signalSemaphore, if there is one).
+      // Submissions to the graphics queue also signal the device's own timeline, which is what deferred destroys wait for.
+      void Submit(vk::Queue queue, vk::CommandBuffer commandBuffer, VulkanTimeline& timeline, vk::Semaphore waitSemaphore = nullptr, vk::PipelineStageFlags waitStage = {}, vk::Semaphore signalSemaphore = nullptr);
+
+      // Destroy something (e.g. a buffer that is no longer wanted) once the GPU has finished with the work submitted to the
+      // graphics queue so far, and with the next submission (which could be being recorded now).  Does not wait.
+      void DeferDestroy(std::function<void()> destroy);
+
+      // Run the deferred destroys whose work has completed.
+      // If wait is true, then wait for the device to be idle first (so that they all run)
+      void CollectGarbage(const bool wait = false);
+
+      // A number that is unique (for the lifetime of the device) to the caller.
+      // Resources identify themselves to the descriptor set caches by serial rather than by handle, as handles of destroyed
+      // resources can be reused by new ones.
+      uint64_t NewSerial() {
+         return ++m_Serial;
+      }
+
+      // The uploader needs the memory allocator, so is created (and must be destroyed) separately from the device
+      void CreateUploader();
+      void DestroyUploader();
+      VulkanUploader& GetUploader();
+
+      // Progress of the graphics queue (each submission to it via Submit() signals the next value)
+      VulkanTimeline& GetTimeline();
+
+      // The device's pipeline cache, shared by all contexts.  Loaded from disk when the device is created, and saved when it is destroyed
+      vk::PipelineCache GetVkPipelineCache() const;
+
+      // true if the device supports descriptor indexing, in which case all 2D textures are added to the global texture table
+      bool IsBindlessSupported() const;
+      VulkanTextureTable& GetTextureTable();
+
    private:
       bool IsPhysicalDeviceSuitable(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface);
       std::vector<const char*> GetRequiredDeviceExtensions() const;
@@ -50,11 +98,23 @@ namespace Pikzel {
       void CreateCommandPool();
       void DestroyCommandPool();
 
+      void CreateSyncObjects();
+      void DestroySyncObjects();
+
+      void CreateTextureTable();
+      void DestroyTextureTable();
+
+      void CreatePipelineCache();
+      void DestroyPipelineCache();
+      std::vector<uint8_t> LoadPipelineCacheData() const;
+      void SavePipelineCacheData() const;
+
    private:
       vk::Instance m_Instance;
       vk::PhysicalDevice m_PhysicalDevice;
       vk::PhysicalDeviceProperties m_PhysicalDeviceProperties;
       vk::PhysicalDeviceFeatures2 m_EnabledPhysicalDeviceFeatures;
+      vk::PhysicalDeviceVulkan12Features m_EnabledPhysicalDeviceVulkan12Features;
       vk::PhysicalDeviceVulkan13Features m_EnabledPhysicalDeviceVulkan13Features;
 
       QueueFamilyIndices m_QueueFamilyIndices;
@@ -68,6 +128,16 @@ namespace Pikzel {
 
       vk::CommandPool m_CommandPool;
 
+      vk::PipelineCache m_PipelineCache;
+      std::filesystem::path m_PipelineCachePath;
+
+      std::unique_ptr<VulkanUploader> m_Uploader;
+      std::unique_ptr<VulkanTextureTable> m_TextureTable;   // null if bindless textures are not supported
+
+      std::unique_ptr<VulkanTimeline> m_Timeline;                            // progress of the graphics queue
+      std::deque<std::pair<uint64_t, std::function<void()>>> m_DeferredDestroys;  // destroy functions, and the m_Timeline value that they wait for (oldest first)
+      uint64_t m_Serial = 0;
+
    };
 
 }
@@ -13,6 +13,8 @@
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_vulkan.h>
 
+#include <stdexcept>
+
 namespace Pikzel {
 
    VulkanGraphicsContext::VulkanGraphicsContext(std::shared_ptr<VulkanDevice> device) : m_Device {device} {}
@@ -46,7 +48,7 @@ namespace Pikzel {
 
    void VulkanGraphicsContext::Bind(const IndexBuffer& buffer) {
       const VulkanIndexBuffer& vulkanIndexBuffer = static_cast<const VulkanIndexBuffer&>(buffer);
-      GetVkCommandBuffer().bindIndexBuffer(vulkanIndexBuffer.GetVkBuffer(), 0, vk::IndexType::eUint32);
+      GetVkCommandBuffer().bindIndexBuffer(vulkanIndexBuffer.GetVkBuffer(), 0, vulkanIndexBuffer.GetVkIndexType());
    }
 
 
@@ -62,22 +64,27 @@ namespace Pikzel {
          VK_WHOLE_SIZE                                                 /*range*/
       };
 
-      vk::WriteDescriptorSet uniformBufferWrite = {
-         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
-         resource.Binding                                        /*dstBinding*/,
-         0                                                       /*dstArrayElement*/,
-         resource.GetCount()                                     /*descriptorCount*/,
-         resource.Type                                           /*descriptorType*/,
-         nullptr                                                 /*pImageInfo*/,
-         &uniformBufferDescriptor                                /*pBufferInfo*/,
-         nullptr                                                 /*pTexelBufferView*/
+      m_Pipeline->SetDescriptor(resource, uniformBufferDescriptor, static_cast<const VulkanUniformBuffer&>(buffer).GetSerial());
+   }
+
+
+   void VulkanGraphicsContext::Unbind(const UniformBuffer&) {}
+
+
+   void VulkanGraphicsContext::Bind(const Id resourceId, const StorageBuffer& buffer) {
+      const VulkanResource& resource = m_Pipeline->GetResource(resourceId);
+
+      vk::DescriptorBufferInfo storageBufferDescriptor = {
+         static_cast<const VulkanStorageBuffer&>(buffer).GetVkBuffer() /*buffer*/,
+         0                                                             /*offset*/,
+         VK_WHOLE_SIZE                                                 /*range*/
       };
 
-      m_Device->GetVkDevice().updateDescriptorSets(uniformBufferWrite, nullptr);
+      m_Pipeline->SetDescriptor(resource, storageBufferDescriptor, static_cast<const VulkanStorageBuffer&>(buffer).GetSerial());
    }
 
 
-   void VulkanGraphicsContext::Unbind(const UniformBuffer&) {}
+   void VulkanGraphicsContext::Unbind(const StorageBuffer&) {}
 
 
    void VulkanGraphicsContext::Bind(const Id resourceId, const Texture& texture) {
@@ -91,18 +98,7 @@ namespace Pikzel {
          vk::ImageLayout::eShaderReadOnlyOptimal
       };
 
-      vk::WriteDescriptorSet textureSamplersWrite = {
-         m_Pipeline->GetVkDescriptorSet(resource.DescriptorSet)  /*dstSet*/,
-         resource.Binding                                        /*dstBinding*/,
-         0                                                       /*dstArrayElement*/,
-         resource.GetCount()                                     /*descriptorCount*/,
-         resource.Type                                           /*descriptorType*/,
-         &textureImageDescriptor                                 /*pImageInfo*/,
-         nullptr                                                 /*pBufferInfo*/,
-         nullptr                                                 /*pTexelBufferView*/
-      };
-
-      m_Device->GetVkDevice().updateDescriptorSets(textureSamplersWrite, nullptr);
+      m_Pipeline->SetDescriptor(resource, textureImageDescriptor, static_cast<const VulkanTexture&>(texture).GetSerial());
    }
 
 
@@ -425,12 +421,72 @@ namespace Pikzel {
    }
 
 
-   void VulkanGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount, const uint32_t vertexOffset/*= 0*/) {
-      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount();
+   void VulkanGraphicsContext::DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
+      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount() - firstIndex;
       BindDescriptorSets();
       Bind(vertexBuffer);
       Bind(indexBuffer);
-      GetVkCommandBuffer().drawIndexed(count, 1, 0, vertexOffset, 0);
+      GetVkCommandBuffer().drawIndexed(count, 1, firstIndex, vertexOffset, 0);
+   }
+
+
+   void VulkanGraphicsContext::DrawIndexedInstanced(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t instanceCount, const uint32_t firstInstance/*= 0*/, const uint32_t indexCount/*= 0*/, const uint32_t vertexOffset/*= 0*/, const uint32_t firstIndex/*= 0*/) {
+      uint32_t count = indexCount ? indexCount : indexBuffer.GetCount() - firstIndex;
+      BindDescriptorSets();
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      GetVkCommandBuffer().drawIndexed(count, instanceCount, firstIndex, vertexOffset, firstInstance);
+   }
+
+
+   void VulkanGraphicsContext::DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t commandIndex/*= 0*/) {
+      PKZL_CORE_ASSERT(commandIndex < indirectBuffer.GetCount(), "DrawIndexedIndirect() command index out of range!");
+      BindDescriptorSets();
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      GetVkCommandBuffer().drawIndexedIndirect(static_cast<const VulkanIndirectBuffer&>(indirectBuffer).GetVkBuffer(), commandIndex * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+   }
+
+
+   void VulkanGraphicsContext::MultiDrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t drawCount, const uint32_t firstCommand/*= 0*/) {
+      PKZL_CORE_ASSERT(firstCommand + drawCount <= indirectBuffer.GetCount(), "MultiDrawIndexedIndirect() command range out of range!");
+      if (drawCount == 0) {
+         return;
+      }
+      BindDescriptorSets();
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      vk::Buffer buffer = static_cast<const VulkanIndirectBuffer&>(indirectBuffer).GetVkBuffer();
+      if (m_Device->GetEnabledPhysicalDeviceFeatures().multiDrawIndirect) {
+         GetVkCommandBuffer().drawIndexedIndirect(buffer, firstCommand * sizeof(DrawIndexedIndirectCommand), drawCount, sizeof(DrawIndexedIndirectCommand));
+      } else {
+         // device cannot do more than one draw per indirect call
+         for (uint32_t i = 0; i < drawCount; ++i) {
+            GetVkCommandBuffer().drawIndexedIndirect(buffer, (firstCommand + i) * sizeof(DrawIndexedIndirectCommand), 1, sizeof(DrawIndexedIndirectCommand));
+         }
+      }
+   }
+
+
+   void VulkanGraphicsContext::DrawIndexedIndirectCount(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const StorageBuffer& countBuffer, const uint32_t maxDrawCount, const uint32_t firstCommand/*= 0*/, const uint32_t countIndex/*= 0*/) {
+      PKZL_CORE_ASSERT(firstCommand + maxDrawCount <= indirectBuffer.GetCount(), "DrawIndexedIndirectCount() command range out of range!");
+      if (!m_Device->GetEnabledPhysicalDeviceVulkan12Features().drawIndirectCount) {
+         throw std::runtime_error {"DrawIndexedIndirectCount() requires the drawIndirectCount device feature, which is not supported!"};
+      }
+      if (maxDrawCount == 0) {
+         return;
+      }
+      BindDescriptorSets();
+      Bind(vertexBuffer);
+      Bind(indexBuffer);
+      GetVkCommandBuffer().drawIndexedIndirectCount(
+         static_cast<const VulkanIndirectBuffer&>(indirectBuffer).GetVkBuffer() /*buffer*/,
+         firstCommand * sizeof(DrawIndexedIndirectCommand)                    /*offset*/,
+         static_cast<const VulkanStorageBuffer&>(countBuffer).GetVkBuffer()     /*countBuffer*/,
+         countIndex * sizeof(uint32_t)                                         /*countBufferOffset*/,
+         maxDrawCount                                                          /*maxDrawCount*/,
+         sizeof(DrawIndexedIndirectCommand)                                    /*stride*/
+      );
    }
 
 
@@ -440,7 +496,7 @@ namespace Pikzel {
 
 
    vk::PipelineCache VulkanGraphicsContext::GetVkPipelineCache() const {
-      return m_PipelineCache;
+      return m_Device->GetVkPipelineCache();
    }
 
 
@@ -606,20 +662,8 @@ namespace Pikzel {
    }
 
 
-   void VulkanGraphicsContext::CreatePipelineCache() {
-      m_PipelineCache = m_Device->GetVkDevice().createPipelineCache({});
-   }
-
-
-   void VulkanGraphicsContext::DestroyPipelineCache() {
-      if (m_Device && m_PipelineCache) {
-         m_Device->GetVkDevice().destroy(m_PipelineCache);
-      }
-   }
-
-
    void VulkanGraphicsContext::BindDescriptorSets() {
-      m_Pipeline->BindDescriptorSets(GetVkCommandBuffer(), GetFence());
+      m_Pipeline->BindDescriptorSets(GetVkCommandBuffer(), GetTimeline());
    }
 
 
@@ -726,7 +770,6 @@ namespace Pikzel {
       CreateCommandPool();
       CreateCommandBuffers(static_cast<uint32_t>(m_SwapChainImages.size()));
       CreateSyncObjects();
-      CreatePipelineCache();
 
       EventDispatcher::Connect<WindowResizeEvent, &VulkanWindowGC::OnWindowResize>(*this);
       EventDispatcher::Connect<WindowVSyncChangedEvent, &VulkanWindowGC::OnWindowVSyncChanged>(*this);
@@ -756,7 +799,6 @@ namespace Pikzel {
             DestroyRenderPass(m_RenderPassImGui);
             DestroyDescriptorPool(m_DescriptorPoolImGui);
          }
-         DestroyPipelineCache();
          DestroySyncObjects();
          DestroyCommandBuffers();
          DestroyCommandPool();
@@ -792,8 +834,11 @@ namespace Pikzel {
 
       // Wait until we know GPU has finished with the command buffer we are about to use...
       // Note that m_CurrentFrame and m_CurrentImage are not necessarily equal (particularly if we have, say, 3 swap chain images, and 2 frames-in-flight)
-      // However, we know that the GPU has finished with m_CurrentImage'th command buffer so long as the m_CurrentFrame'th fence is signaled
-      vk::Result result = m_Device->GetVkDevice().waitForFences(m_InFlightFences[m_CurrentFrame]->GetVkFence(), true, UINT64_MAX);
+      // However, we know that the GPU has finished with m_CurrentImage'th command buffer so long as the m_CurrentFrame'th frame's timeline value has been reached
+      m_Timeline->Wait(m_FrameTimelineValues[m_CurrentFrame]);
+
+      // ...which is also a good time to destroy things that the GPU has finished with
+      m_Device->CollectGarbage();
 
       vk::CommandBufferBeginInfo commandBufferBI = {
          vk::CommandBufferUsageFlagBits::eSimultaneousUse
@@ -857,19 +902,18 @@ namespace Pikzel {
       }
 
       commandBuffer.end();
-      vk::PipelineStageFlags waitStages[] = {{vk::PipelineStageFlagBits::eColorAttachmentOutput}};
-      vk::SubmitInfo si = {
-         1                                             /*waitSemaphoreCount*/,
-         &m_ImageAvailableSemaphores[m_CurrentFrame]   /*pWaitSemaphores*/,
-         waitStages                                    /*pWaitDstStageMask*/,
-         1                                             /*commandBufferCount*/,
-         &commandBuffer                                /*pCommandBuffers*/,
-         1                                             /*signalSemaphoreCount*/,
-         &m_RenderFinishedSemaphores[m_CurrentFrame]   /*pSignalSemaphores*/
-      };
 
-      m_Device->GetVkDevice().resetFences(m_InFlightFences[m_CurrentFrame]->GetVkFence());
-      m_Device->GetGraphicsQueue().submit(si, m_InFlightFences[m_CurrentFrame]->GetVkFence());
+      // staged uploads must be submitted before the work that uses them
+      m_Device->GetUploader().Flush();
+      m_Device->Submit(
+         m_Device->GetGraphicsQueue(),
+         commandBuffer,
+         *m_Timeline,
+         m_ImageAvailableSemaphores[m_CurrentFrame],
+         vk::PipelineStageFlagBits::eColorAttachmentOutput,
+         m_RenderFinishedSemaphores[m_CurrentFrame]
+      );
+      m_FrameTimelineValues[m_CurrentFrame] = m_Timeline->GetSubmittedValue();
 
       if (m_ImGuiFrameStarted) {
          if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -973,7 +1017,7 @@ namespace Pikzel {
          .MinImageCount = static_cast<uint32_t>(m_SwapChainImages.size()),
          .ImageCount = static_cast<uint32_t>(m_SwapChainImages.size()),
          .MSAASamples = static_cast<VkSampleCountFlagBits>(GetNumSamples()),
-         .PipelineCache = m_PipelineCache,
+         .PipelineCache = m_Device->GetVkPipelineCache(),
          .Subpass         = 0,
          .UseDynamicRendering = false,
          .Allocator       = nullptr, // TODO: proper allocator...
@@ -1043,13 +1087,24 @@ namespace Pikzel {
    }
 
 
+   uint32_t VulkanWindowGC::GetMaxFramesInFlight() const {
+      return m_MaxFramesInFlight;
+   }
+
+
+   // BeginFrame() has waited for the previous submission of this frame to complete, so buffers that only this frame writes are free
+   uint32_t VulkanWindowGC::GetFrameIndex() const {
+      return m_CurrentFrame;
+   }
+
+
    vk::CommandBuffer VulkanWindowGC::GetVkCommandBuffer() {
       return m_CommandBuffers[m_CurrentImage];
    }
 
 
-   std::shared_ptr<VulkanFence> VulkanWindowGC::GetFence() {
-      return m_InFlightFences[m_CurrentFrame];
+   std::shared_ptr<VulkanTimeline> VulkanWindowGC::GetTimeline() {
+      return m_Timeline;
    }
 
 
@@ -1303,13 +1358,13 @@ namespace Pikzel {
    void VulkanWindowGC::CreateSyncObjects() {
       m_ImageAvailableSemaphores.reserve(m_MaxFramesInFlight);
       m_RenderFinishedSemaphores.reserve(m_MaxFramesInFlight);
-      m_InFlightFences.reserve(m_MaxFramesInFlight);
+      m_FrameTimelineValues.assign(m_MaxFramesInFlight, 0);
 
       for (uint32_t i = 0; i < m_MaxFramesInFlight; ++i) {
          m_ImageAvailableSemaphores.emplace_back(m_Device->GetVkDevice().createSemaphore({}));
          m_RenderFinishedSemaphores.emplace_back(m_Device->GetVkDevice().createSemaphore({}));
-         m_InFlightFences.emplace_back(std::make_shared<VulkanFence>(m_Device->GetVkDevice()));
       }
+      m_Timeline = std::make_shared<VulkanTimeline>(m_Device->GetVkDevice());
    }
 
 
@@ -1324,7 +1379,8 @@ namespace Pikzel {
             m_Device->GetVkDevice().destroy(semaphore);
          }
          m_RenderFinishedSemaphores.clear();
-         m_InFlightFences.clear();
+         m_FrameTimelineValues.clear();
+         m_Timeline = nullptr;
       }
    }
 
@@ -1441,7 +1497,6 @@ namespace Pikzel {
       CreateCommandPool();
       CreateCommandBuffers(1);
       CreateSyncObjects();
-      CreatePipelineCache();
    }
 
 
@@ -1452,7 +1507,6 @@ namespace Pikzel {
          if (m_Pipeline) {
             Unbind(*m_Pipeline);
          }
-         DestroyPipelineCache();
          DestroySyncObjects();
          DestroyCommandBuffers();
          DestroyCommandPool();
@@ -1516,18 +1570,9 @@ namespace Pikzel {
       cmd.endRenderPass();  // TODO: think about where render passes should begin/end
       cmd.end();
 
-      vk::SubmitInfo si = {
-         0                /*waitSemaphoreCount*/,
-         nullptr          /*pWaitSemaphores*/,
-         nullptr          /*pWaitDstStageMask*/,
-         1                /*commandBufferCount*/,
-         &cmd             /*pCommandBuffers*/,
-         0                /*signalSemaphoreCount*/,
-         nullptr          /*pSignalSemaphores*/
-      };
-
-      m_Device->GetVkDevice().resetFences(m_InFlightFence->GetVkFence());
-      m_Device->GetGraphicsQueue().submit(si, m_InFlightFence->GetVkFence());
+      // staged uploads must be submitted before the work that uses them
+      m_Device->GetUploader().Flush();
+      m_Device->Submit(m_Device->GetGraphicsQueue(), cmd, *m_Timeline);
 
       // Depth texture to shader read only here.
       // This is so that other "graphics contexts" can ask this framebuffer for the depth texture
@@ -1560,7 +1605,8 @@ namespace Pikzel {
 
 
    void VulkanFramebufferGC::SwapBuffers() {
-      vk::Result result = m_Device->GetVkDevice().waitForFences(m_InFlightFence->GetVkFence(), true, UINT64_MAX);
+      m_Timeline->Wait(m_Timeline->GetSubmittedValue());
+      m_Device->CollectGarbage();
    }
 
 
@@ -1569,8 +1615,8 @@ namespace Pikzel {
    }
 
 
-   std::shared_ptr<VulkanFence> VulkanFramebufferGC::GetFence() {
-      return m_InFlightFence;
+   std::shared_ptr<VulkanTimeline> VulkanFramebufferGC::GetTimeline() {
+      return m_Timeline;
    }
 
 
@@ -1580,13 +1626,13 @@ namespace Pikzel {
 
 
    void VulkanFramebufferGC::CreateSyncObjects() {
-      m_InFlightFence = std::make_shared<VulkanFence>(m_Device->GetVkDevice());
+      m_Timeline = std::make_shared<VulkanTimeline>(m_Device->GetVkDevice());
    }
 
 
    void VulkanFramebufferGC::DestroySyncObjects() {
-      if (m_Device && m_InFlightFence) {
-         m_InFlightFence = nullptr;
+      if (m_Device && m_Timeline) {
+         m_Timeline = nullptr;
       }
    }
 
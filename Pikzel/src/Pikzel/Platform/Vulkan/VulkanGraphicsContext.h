@@ -2,7 +2,7 @@
 
 #include "DescriptorBinding.h"
 #include "VulkanDevice.h"
-#include "VulkanFence.h"
+#include "VulkanTimeline.h"
 #include "VulkanFramebuffer.h"
 #include "VulkanImage.h"
 
@@ -37,6 +37,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) override;
       virtual void Unbind(const UniformBuffer& buffer) override;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) override;
+      virtual void Unbind(const StorageBuffer& buffer) override;
+
       virtual void Bind(const Id resourceId, const Texture& texture) override;
       virtual void Unbind(const Texture& texture) override;
 
@@ -82,14 +85,18 @@ namespace Pikzel {
       virtual void PushConstant(const Id id, const glm::dmat4& value) override;
 
       virtual void DrawTriangles(const VertexBuffer& vertexBuffer, const uint32_t vertexCount, const uint32_t vertexOffset = 0) override;
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) override;
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedInstanced(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t instanceCount, const uint32_t firstInstance = 0, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) override;
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t commandIndex = 0) override;
+      virtual void MultiDrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t drawCount, const uint32_t firstCommand = 0) override;
+      virtual void DrawIndexedIndirectCount(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const StorageBuffer& countBuffer, const uint32_t maxDrawCount, const uint32_t firstCommand = 0, const uint32_t countIndex = 0) override;
 
    public:
       vk::RenderPass GetVkRenderPass(BeginFrameOp operation) const;
       vk::PipelineCache GetVkPipelineCache() const;
 
       virtual vk::CommandBuffer GetVkCommandBuffer() = 0;
-      virtual std::shared_ptr<VulkanFence> GetFence() = 0;
+      virtual std::shared_ptr<VulkanTimeline> GetTimeline() = 0;
 
       vk::SampleCountFlagBits GetNumSamples() const;
 
@@ -108,9 +115,6 @@ namespace Pikzel {
       void CreateCommandBuffers(const uint32_t commandBufferCount);
       void DestroyCommandBuffers();
 
-      void CreatePipelineCache();
-      void DestroyPipelineCache();
-
       void BindDescriptorSets();
       void UnbindDescriptorSets();
 
@@ -131,7 +135,6 @@ namespace Pikzel {
       vk::CommandPool m_CommandPool;
       std::vector<vk::CommandBuffer> m_CommandBuffers;
 
-      vk::PipelineCache m_PipelineCache;
       VulkanPipeline* m_Pipeline = nullptr;       // currently bound pipeline  (TODO: should be a shared_ptr?)
    };
 
@@ -154,9 +157,12 @@ namespace Pikzel {
 
       virtual void SwapBuffers() override;
 
+      virtual uint32_t GetMaxFramesInFlight() const override;
+      virtual uint32_t GetFrameIndex() const override;
+
    public:
       virtual vk::CommandBuffer GetVkCommandBuffer() override;
-      virtual std::shared_ptr<VulkanFence> GetFence() override;
+      virtual std::shared_ptr<VulkanTimeline> GetTimeline() override;
 
       virtual uint32_t GetNumColorAttachments() const override;
 
@@ -215,7 +221,8 @@ namespace Pikzel {
       uint32_t m_CurrentImage = 0; // which swap chain image are we currently rendering to
       std::vector<vk::Semaphore> m_ImageAvailableSemaphores;
       std::vector<vk::Semaphore> m_RenderFinishedSemaphores;
-      std::vector<std::shared_ptr<VulkanFence>> m_InFlightFences;
+      std::shared_ptr<VulkanTimeline> m_Timeline;
+      std::vector<uint64_t> m_FrameTimelineValues; // m_FrameTimelineValues[i] = value of m_Timeline signalled by the most recent submission of frame i
 
       bool m_IsVSync = false;
       bool m_WantResize = false;
@@ -240,7 +247,7 @@ namespace Pikzel {
 
    public:
       virtual vk::CommandBuffer GetVkCommandBuffer() override;
-      virtual std::shared_ptr<VulkanFence> GetFence() override;
+      virtual std::shared_ptr<VulkanTimeline> GetTimeline() override;
 
       virtual uint32_t GetNumColorAttachments() const override;
 
@@ -252,7 +259,7 @@ namespace Pikzel {
       std::vector<vk::ClearValue> m_ClearValues;
       vk::Extent2D m_Extent;
       VulkanFramebuffer* m_Framebuffer;
-      std::shared_ptr<VulkanFence> m_InFlightFence;
+      std::shared_ptr<VulkanTimeline> m_Timeline;
    };
 
 }
@@ -100,16 +100,25 @@ namespace Pikzel {
 
 
    VulkanImage::~VulkanImage() {
-      DestroyImageViews();
       if (m_Device && m_Image && m_Allocation) {
          // Only destroy the image if it has an allocation.
          // I.e. we allocated the image, so we destroy it.
          // As opposed to images that were created (and are destroyed) by
          // the swap chain.
-         VulkanMemoryAllocator::Get().destroyImage(m_Image, m_Allocation);
+         // Submitted work (or staged uploads to the image) may still be using it, so destroy it, and its views, once that has completed.
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), image = m_Image, allocation = m_Allocation, imageView = m_ImageView, mipImageViews = std::move(m_MIPImageViews)] {
+            for (const auto mipImageView : mipImageViews) {
+               device.destroy(mipImageView);
+            }
+            device.destroy(imageView);
+            VulkanMemoryAllocator::Get().destroyImage(image, allocation);
+         });
+         m_MIPImageViews.clear();
+         m_ImageView = nullptr;
          m_Image = nullptr;
          m_Allocation = nullptr;
       }
+      DestroyImageViews();
    }
 
 
@@ -322,20 +331,25 @@ namespace Pikzel {
 
 
    void VulkanImage::CopyFromBuffer(vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions) {
-      m_Device->SubmitSingleTimeCommands(m_Device->GetTransferQueue(), [this, buffer, &regions] (vk::CommandBuffer cmd) {
-         std::vector<vk::ImageMemoryBarrier> beforeCopyBarriers;
-         beforeCopyBarriers.reserve(regions.size());
-         for (const auto& region : regions) {
-            beforeCopyBarriers.emplace_back(Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, region.imageSubresource.mipLevel, 1, region.imageSubresource.baseArrayLayer, region.imageSubresource.layerCount));
-         }
-         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, beforeCopyBarriers);
-         cmd.copyBufferToImage(buffer, m_Image, vk::ImageLayout::eTransferDstOptimal, regions);
+      m_Device->SubmitSingleTimeCommands(m_Device->GetGraphicsQueue(), [this, buffer, &regions] (vk::CommandBuffer cmd) {
+         CopyFromBuffer(cmd, buffer, regions);
       });
    }
 
 
+   void VulkanImage::CopyFromBuffer(vk::CommandBuffer cmd, vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions) {
+      std::vector<vk::ImageMemoryBarrier> beforeCopyBarriers;
+      beforeCopyBarriers.reserve(regions.size());
+      for (const auto& region : regions) {
+         beforeCopyBarriers.emplace_back(Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, region.imageSubresource.mipLevel, 1, region.imageSubresource.baseArrayLayer, region.imageSubresource.layerCount));
+      }
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, beforeCopyBarriers);
+      cmd.copyBufferToImage(buffer, m_Image, vk::ImageLayout::eTransferDstOptimal, regions);
+   }
+
+
    void VulkanImage::CopyFromImage(const VulkanImage& image, const vk::ArrayProxy<const vk::ImageCopy>& regions) {
-      m_Device->SubmitSingleTimeCommands(m_Device->GetTransferQueue(), [this, &image, &regions] (vk::CommandBuffer cmd) {
+      m_Device->SubmitSingleTimeCommands(m_Device->GetGraphicsQueue(), [this, &image, &regions] (vk::CommandBuffer cmd) {
          std::vector<vk::ImageMemoryBarrier> beforeCopyBarriers;
          std::vector<vk::ImageMemoryBarrier> afterCopyBarriers;
          beforeCopyBarriers.reserve(regions.size() * 2);
@@ -354,82 +368,92 @@ namespace Pikzel {
    }
 
 
-   void VulkanImage::GenerateMipmap(const uint32_t baseMipLevel) {
-      // Check if image format supports linear blitting
+   void VulkanImage::CheckLinearBlitSupport() const {
       vk::FormatProperties formatProperties = m_Device->GetVkPhysicalDevice().getFormatProperties(m_Format);
       if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
          throw std::runtime_error {"texture image format does not support linear blitting!"};
       }
+   }
 
-      m_Device->SubmitSingleTimeCommands(m_Device->GetComputeQueue(), [this, baseMipLevel] (vk::CommandBuffer cmd) {
-         vk::ImageMemoryBarrier barrier = {
-            {}                                   /*srcAccessMask*/,
-            {}                                   /*dstAccessMask*/,
-            vk::ImageLayout::eUndefined          /*oldLayout*/,
-            vk::ImageLayout::eUndefined          /*newLayout*/,
-            VK_QUEUE_FAMILY_IGNORED              /*srcQueueFamilyIndex*/,
-            VK_QUEUE_FAMILY_IGNORED              /*dstQueueFamilyIndex*/,
-            m_Image                              /*image*/,
-            vk::ImageSubresourceRange {
-               {vk::ImageAspectFlagBits::eColor}    /*aspectMask*/,
-               0                                    /*baseMipLevel*/,
-               1                                    /*levelCount*/,
-               0                                    /*baseArrayLayer*/,
-               m_Layers                             /*layerCount*/
-            }                                    /*subresourceRange*/
-         };
 
-         int32_t mipWidth = m_Width;
-         int32_t mipHeight = m_Height;
-         int32_t mipDepth = m_Depth;
-
-         for (uint32_t i = 1; i < m_MIPLevels; ++i) {
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, barrier);
-
-            if (i > baseMipLevel) {
-               vk::ImageBlit blit;
-               blit.srcOffsets[0] = vk::Offset3D{ 0, 0, 0 };
-               blit.srcOffsets[1] = vk::Offset3D{ mipWidth, mipHeight, mipDepth };
-               blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-               blit.srcSubresource.mipLevel = i - 1;
-               blit.srcSubresource.baseArrayLayer = 0;
-               blit.srcSubresource.layerCount = m_Layers;
-               blit.dstOffsets[0] = vk::Offset3D{ 0, 0, 0 };
-               blit.dstOffsets[1] = vk::Offset3D{ mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth > 1 ? mipDepth / 2 : 1 };
-               blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-               blit.dstSubresource.mipLevel = i;
-               blit.dstSubresource.baseArrayLayer = 0;
-               blit.dstSubresource.layerCount = m_Layers;;
-               cmd.blitImage(m_Image, vk::ImageLayout::eTransferSrcOptimal, m_Image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
-            }
-            barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, barrier);
-
-            if (mipWidth > 1) {
-               mipWidth /= 2;
-            }
-            if (mipHeight > 1) {
-               mipHeight /= 2;
-            }
-            if (mipDepth > 1) {
-               mipDepth /= 2;
-            }
-         }
-         barrier.subresourceRange.baseMipLevel = m_MIPLevels - 1;
+   void VulkanImage::GenerateMipmap(const uint32_t baseMipLevel) {
+      CheckLinearBlitSupport();
+      m_Device->SubmitSingleTimeCommands(m_Device->GetGraphicsQueue(), [this, baseMipLevel] (vk::CommandBuffer cmd) {
+         GenerateMipmap(cmd, baseMipLevel);
+      });
+   }
+
+
+   void VulkanImage::GenerateMipmap(vk::CommandBuffer cmd, const uint32_t baseMipLevel) {
+      CheckLinearBlitSupport();
+
+      vk::ImageMemoryBarrier barrier = {
+         {}                                   /*srcAccessMask*/,
+         {}                                   /*dstAccessMask*/,
+         vk::ImageLayout::eUndefined          /*oldLayout*/,
+         vk::ImageLayout::eUndefined          /*newLayout*/,
+         VK_QUEUE_FAMILY_IGNORED              /*srcQueueFamilyIndex*/,
+         VK_QUEUE_FAMILY_IGNORED              /*dstQueueFamilyIndex*/,
+         m_Image                              /*image*/,
+         vk::ImageSubresourceRange {
+            {vk::ImageAspectFlagBits::eColor}    /*aspectMask*/,
+            0                                    /*baseMipLevel*/,
+            1                                    /*levelCount*/,
+            0                                    /*baseArrayLayer*/,
+            m_Layers                             /*layerCount*/
+         }                                    /*subresourceRange*/
+      };
+
+      int32_t mipWidth = m_Width;
+      int32_t mipHeight = m_Height;
+      int32_t mipDepth = m_Depth;
+
+      for (uint32_t i = 1; i < m_MIPLevels; ++i) {
+         barrier.subresourceRange.baseMipLevel = i - 1;
          barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-         barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+         barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
          barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+         barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, barrier);
+
+         if (i > baseMipLevel) {
+            vk::ImageBlit blit;
+            blit.srcOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+            blit.srcOffsets[1] = vk::Offset3D{ mipWidth, mipHeight, mipDepth };
+            blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            blit.srcSubresource.mipLevel = i - 1;
+            blit.srcSubresource.baseArrayLayer = 0;
+            blit.srcSubresource.layerCount = m_Layers;
+            blit.dstOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+            blit.dstOffsets[1] = vk::Offset3D{ mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth > 1 ? mipDepth / 2 : 1 };
+            blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            blit.dstSubresource.mipLevel = i;
+            blit.dstSubresource.baseArrayLayer = 0;
+            blit.dstSubresource.layerCount = m_Layers;;
+            cmd.blitImage(m_Image, vk::ImageLayout::eTransferSrcOptimal, m_Image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+         }
+         barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+         barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+         barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
          barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, barrier);
-      });
+         cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, {}, nullptr, nullptr, barrier);
+
+         if (mipWidth > 1) {
+            mipWidth /= 2;
+         }
+         if (mipHeight > 1) {
+            mipHeight /= 2;
+         }
+         if (mipDepth > 1) {
+            mipDepth /= 2;
+         }
+      }
+      barrier.subresourceRange.baseMipLevel = m_MIPLevels - 1;
+      barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+      barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+      barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+      barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+      cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, {}, nullptr, nullptr, barrier);
    }
 
 }
@@ -39,6 +39,13 @@ namespace Pikzel {
 
       void GenerateMipmap(const uint32_t baseMipLevel);
 
+      // As above, but recorded into cmd instead of being submitted straight away
+      void CopyFromBuffer(vk::CommandBuffer cmd, vk::Buffer buffer, const vk::ArrayProxy<const vk::BufferImageCopy>& regions);
+      void GenerateMipmap(vk::CommandBuffer cmd, const uint32_t baseMipLevel);
+
+   protected:
+      void CheckLinearBlitSupport() const;
+
    protected:
       std::shared_ptr<VulkanDevice> m_Device;
       vk::ImageViewType m_Type;
@@ -7,6 +7,7 @@
 
 #include <spirv_cross/spirv_cross.hpp>
 
+#include <algorithm>
 #include <array>
 #include <format>
 #include <map>
@@ -43,6 +44,12 @@ namespace Pikzel {
          case DataType::DVec2:    return vk::Format::eR64G64Sfloat;
          case DataType::DVec3:    return vk::Format::eR64G64B64Sfloat;
          case DataType::DVec4:    return vk::Format::eR64G64B64A64Sfloat;
+         case DataType::SNorm16Vec2: return vk::Format::eR16G16Snorm;
+         case DataType::SNorm16Vec4: return vk::Format::eR16G16B16A16Snorm;
+         case DataType::UNorm16Vec2: return vk::Format::eR16G16Unorm;
+         case DataType::UNorm16Vec4: return vk::Format::eR16G16B16A16Unorm;
+         case DataType::HVec2:    return vk::Format::eR16G16Sfloat;
+         case DataType::HVec4:    return vk::Format::eR16G16B16A16Sfloat;
          default:                 break;
       }
       PKZL_CORE_ASSERT(false, "Unknown DataType for VkFormat!");
@@ -98,7 +105,8 @@ namespace Pikzel {
 
 
    VulkanPipeline::~VulkanPipeline() {
-      m_Device->GetVkDevice().waitIdle();
+      // Previously submitted work may still be using the pipeline (and its descriptor sets).
+      // Rather than waiting for the device to go idle, the Destroy functions defer destruction until that work has completed.
       DestroyDesciptorPool();
       DestroyPipeline();
       DestroyPipelineLayout();
@@ -161,10 +169,13 @@ namespace Pikzel {
          const auto& type = compiler.get_type(resource.type_id);
          std::vector<uint32_t> shape;
          if (type.array.size() > 0) {
-            PKZL_CORE_LOG_ERROR(std::format("{} object with name '{}' is an array.  This is not currently supported by Pikzel!", resourceType, name));
             shape.resize(type.array.size());  // number of dimensions of the array. 0 = its a scalar (i.e. not an array), 1 = 1D array, 2 = 2D array, etc...
             for (auto dim = 0; dim < shape.size(); ++dim) {
-               shape[dim] = type.array[dim];  // size of [dim]th dimension of the array
+               shape[dim] = type.array[dim];  // size of [dim]th dimension of the array.  0 = unbounded
+            }
+            if ((descriptorType != vk::DescriptorType::eCombinedImageSampler) || (shape.size() != 1) || (shape[0] != 0)) {
+               // unbounded sampled image arrays are the bindless texture table.  Other arrays can only have their first element bound.
+               PKZL_CORE_LOG_ERROR(std::format("{} object with name '{}' is an array.  Only unbounded arrays of sampled images (the bindless texture table) are supported by Pikzel!", resourceType, name));
             }
          }
 
@@ -230,6 +241,7 @@ namespace Pikzel {
          ReflectResourceBindings(shaderType, vk::DescriptorType::eUniformBuffer, "uniform buffer", compiler, m_Resources, resources.uniform_buffers);
          ReflectResourceBindings(shaderType, vk::DescriptorType::eCombinedImageSampler, "sampled image", compiler, m_Resources, resources.sampled_images);
          ReflectResourceBindings(shaderType, vk::DescriptorType::eStorageImage, "storage image", compiler, m_Resources, resources.storage_images);
+         ReflectResourceBindings(shaderType, vk::DescriptorType::eStorageBuffer, "storage buffer", compiler, m_Resources, resources.storage_buffers);
 
          // specialization constants
          m_SpecializationMap.emplace_back();
@@ -262,26 +274,43 @@ namespace Pikzel {
       ReflectShaders(settings.specializationConstants);
 
       std::vector<std::vector<vk::DescriptorSetLayoutBinding>> layoutBindings;
+      std::vector<bool> isBindless;
       for (const auto& [id, resource] : m_Resources) {
          if (layoutBindings.size() <= resource.DescriptorSet) {
             layoutBindings.resize(resource.DescriptorSet + 1);
+            isBindless.resize(resource.DescriptorSet + 1);
          }
          layoutBindings[resource.DescriptorSet].emplace_back(resource.Binding, resource.Type, resource.GetCount(), resource.ShaderStages);
+         if (resource.IsBindless()) {
+            if (!m_Device->IsBindlessSupported()) {
+               throw std::runtime_error {std::format("Shader resource '{}' is a bindless texture table, but the device does not support bindless textures!", resource.Name)};
+            }
+            if (resource.Binding != 0) {
+               throw std::runtime_error {std::format("Shader resource '{}' is a bindless texture table, and must be at binding 0!", resource.Name)};
+            }
+            isBindless[resource.DescriptorSet] = true;
+         }
       }
 
-      for (const auto& layoutBinding : layoutBindings) {
+      for (uint32_t set = 0; set < layoutBindings.size(); ++set) {
+         const auto& layoutBinding = layoutBindings[set];
+         m_DescriptorSets.emplace_back();
+         if (isBindless[set]) {
+            // the texture table's set layout is owned by the device (and the set must hold nothing else)
+            if (layoutBinding.size() != 1) {
+               throw std::runtime_error {std::format("Descriptor set {} holds a bindless texture table, and so cannot hold anything else!", set)};
+            }
+            m_DescriptorSetLayouts.emplace_back(m_Device->GetTextureTable().GetVkDescriptorSetLayout());
+            m_DescriptorSets.back().IsBindless = true;
+            continue;
+         }
+
          vk::DescriptorSetLayoutCreateInfo ci = {
             {}                                            /*flags*/,
             static_cast<uint32_t>(layoutBinding.size())   /*bindingCount*/,
             layoutBinding.data()                          /*pBindings*/
          };
-
          m_DescriptorSetLayouts.emplace_back(m_Device->GetVkDevice().createDescriptorSetLayout(ci));
-         m_DescriptorSetInstances.emplace_back();
-         m_DescriptorSetFences.emplace_back();
-         m_DescriptorSetIndices.emplace_back(0);
-         m_DescriptorSetPending.emplace_back(false);
-         m_DescriptorSetBound.emplace_back(false);
       }
    }
 
@@ -298,9 +327,14 @@ namespace Pikzel {
 
    void VulkanPipeline::DestroyDescriptorSetLayouts() {
       if (m_Device) {
-         for (const auto descriptorSetLayout : m_DescriptorSetLayouts) {
-            m_Device->GetVkDevice().destroy(descriptorSetLayout);
+         if (m_Device->IsBindlessSupported()) {
+            std::erase(m_DescriptorSetLayouts, m_Device->GetTextureTable().GetVkDescriptorSetLayout());
          }
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorSetLayouts = std::move(m_DescriptorSetLayouts)] {
+            for (const auto descriptorSetLayout : descriptorSetLayouts) {
+               device.destroy(descriptorSetLayout);
+            }
+         });
          m_DescriptorSetLayouts.clear();
       }
    }
@@ -336,9 +370,10 @@ namespace Pikzel {
 
 
    void VulkanPipeline::DestroyPipelineLayout() {
-      ;
       if (m_Device && m_PipelineLayout) {
-         m_Device->GetVkDevice().destroy(m_PipelineLayout);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), pipelineLayout = m_PipelineLayout] {
+            device.destroy(pipelineLayout);
+         });
          m_PipelineLayout = nullptr;
       }
    }
@@ -360,7 +395,7 @@ namespace Pikzel {
       };
 
       // .value works around issue in Vulkan.hpp (refer https://github.com/KhronosGroup/Vulkan-Hpp/issues/659)
-      m_PipelineCompute = m_Device->GetVkDevice().createComputePipeline({}, pipelineCI).value;
+      m_PipelineCompute = m_Device->GetVkDevice().createComputePipeline(m_Device->GetVkPipelineCache(), pipelineCI).value;
 
       // Shader modules are no longer needed once the pipeline has been created
       DestroyShaderModule(pipelineCI.stage.module);
@@ -562,31 +597,29 @@ namespace Pikzel {
 
    void VulkanPipeline::DestroyPipeline() {
       if (m_Device) {
-         if (m_PipelineFrontFaceCCW) {
-            m_Device->GetVkDevice().destroy(m_PipelineFrontFaceCCW);
-            m_PipelineFrontFaceCCW = nullptr;
-         }
-         if (m_PipelineFrontFaceCW) {
-            m_Device->GetVkDevice().destroy(m_PipelineFrontFaceCW);
-            m_PipelineFrontFaceCW = nullptr;
-         }
-         if (m_PipelineCompute) {
-            m_Device->GetVkDevice().destroy(m_PipelineCompute);
-            m_PipelineCompute = nullptr;
-         }
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), pipelines = std::array {m_PipelineFrontFaceCCW, m_PipelineFrontFaceCW, m_PipelineCompute}] {
+            for (const auto pipeline : pipelines) {
+               if (pipeline) {
+                  device.destroy(pipeline);
+               }
+            }
+         });
+         m_PipelineFrontFaceCCW = nullptr;
+         m_PipelineFrontFaceCW = nullptr;
+         m_PipelineCompute = nullptr;
       }
    }
 
 
    void VulkanPipeline::CreateDescriptorPool() {
       constexpr uint32_t howMany = 100; // We don't really know at this point how many descriptor sets might end up being needed.
-                                        // We just create "some" here, to allow toy examples to work (TODO: may need to provide a way to set this amount)
-                                        // For more complicated rendering tasks, Pikzel provides various "Renderer" classes which manage their own descriptor
-                                        // sets.
+                                        // We just create "some" here.  If they run out, then AllocateDescriptorSet() creates another pool.
 
       std::unordered_map<vk::DescriptorType, uint32_t> descriptorTypeCount;
       for (const auto& [id, resource] : m_Resources) {
-         ++descriptorTypeCount[resource.Type];
+         if (!resource.IsBindless()) {
+            ++descriptorTypeCount[resource.Type];
+         }
       }
 
       std::vector<vk::DescriptorPoolSize> poolSizes;
@@ -601,78 +634,159 @@ namespace Pikzel {
             static_cast<uint32_t>(poolSizes.size())                          /*poolSizeCount*/,
             poolSizes.data()                                                 /*pPoolSizes*/
          };
-         m_DescriptorPool = m_Device->GetVkDevice().createDescriptorPool(descriptorPoolCI);
+         m_DescriptorPools.emplace_back(m_Device->GetVkDevice().createDescriptorPool(descriptorPoolCI));
       }
    }
 
 
    void VulkanPipeline::DestroyDesciptorPool() {
-      if (m_Device && m_DescriptorPool) {
-         m_Device->GetVkDevice().destroy(m_DescriptorPool);
+      if (m_Device && !m_DescriptorPools.empty()) {
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), descriptorPools = std::move(m_DescriptorPools)] {
+            for (auto descriptorPool : descriptorPools) {
+               device.destroy(descriptorPool);
+            }
+         });
       }
-      m_DescriptorPool = nullptr;
-      m_DescriptorSetInstances.clear();
-      m_DescriptorSetFences.clear();
-      m_DescriptorSetIndices.clear();
-      m_DescriptorSetPending.clear();
-      m_DescriptorSetBound.clear();
+      m_DescriptorPools.clear();
+      m_DescriptorSets.clear();
    }
 
 
    vk::DescriptorSet VulkanPipeline::AllocateDescriptorSet(const uint32_t set) {
+      vk::DescriptorSet descriptorSet;
       vk::DescriptorSetAllocateInfo allocInfo = {
-         m_DescriptorPool,
-         1,
-         &m_DescriptorSetLayouts[set]
+         m_DescriptorPools.empty() ? vk::DescriptorPool {} : m_DescriptorPools.back()   /*descriptorPool*/,
+         1                                                                            /*descriptorSetCount*/,
+         &m_DescriptorSetLayouts[set]                                                 /*pSetLayouts*/
       };
 
-      m_DescriptorSetInstances[set].emplace_back(m_Device->GetVkDevice().allocateDescriptorSets(allocInfo).front());
-      m_DescriptorSetBound[set].emplace_back(false);
-      m_DescriptorSetFences[set].emplace_back(nullptr);
-      m_DescriptorSetIndices[set] = m_DescriptorSetInstances[set].size() - 1;
-      m_DescriptorSetPending[set] = true;
-      return m_DescriptorSetInstances[set].back();
+      vk::Result result = m_DescriptorPools.empty() ? vk::Result::eErrorOutOfPoolMemory : m_Device->GetVkDevice().allocateDescriptorSets(&allocInfo, &descriptorSet);
+      if ((result == vk::Result::eErrorOutOfPoolMemory) || (result == vk::Result::eErrorFragmentedPool)) {
+         CreateDescriptorPool();
+         allocInfo.descriptorPool = m_DescriptorPools.back();
+         result = m_Device->GetVkDevice().allocateDescriptorSets(&allocInfo, &descriptorSet);
+      }
+      if (result != vk::Result::eSuccess) {
+         throw std::runtime_error {std::format("Failed to allocate descriptor set: {}", vk::to_string(result))};
+      }
+      return descriptorSet;
    }
 
 
-   vk::DescriptorSet VulkanPipeline::GetVkDescriptorSet(const uint32_t set) {
-      // if we have not created an instance of the specified descriptor set yet, allocate a new one and return.
-      // otherwise, look for an instance that isn't currently in use (has not already been bound to the pipeline, and is not still in use by some previously submitted render commands) and return that one
-      // if cannot find one that isn't in use, allocate a new one and return
-      if (m_DescriptorSetInstances[set].empty()) {
-         return AllocateDescriptorSet(set);
+   void VulkanPipeline::SetDescriptor(const VulkanResource& resource, const vk::DescriptorBufferInfo& bufferInfo, const uint64_t serial) {
+      SetDescriptor(resource, VulkanDescriptor {resource.Binding, resource.Type, serial, bufferInfo, {}});
+   }
+
+
+   void VulkanPipeline::SetDescriptor(const VulkanResource& resource, const vk::DescriptorImageInfo& imageInfo, const uint64_t serial) {
+      SetDescriptor(resource, VulkanDescriptor {resource.Binding, resource.Type, serial, {}, imageInfo});
+   }
+
+
+   void VulkanPipeline::SetDescriptor(const VulkanResource& resource, const VulkanDescriptor& descriptor) {
+      PKZL_CORE_ASSERT(resource.DescriptorSet < m_DescriptorSets.size(), "Descriptor set out of range!");
+      PKZL_CORE_ASSERT(!resource.IsBindless(), "Textures cannot be bound to a bindless texture table.  Index the table with Texture::GetBindlessIndex() instead!");
+      auto& state = m_DescriptorSets[resource.DescriptorSet];
+      auto it = std::lower_bound(state.Descriptors.begin(), state.Descriptors.end(), descriptor.Binding, [](const VulkanDescriptor& d, const uint32_t binding) { return d.Binding < binding; });
+      if ((it != state.Descriptors.end()) && (it->Binding == descriptor.Binding)) {
+         if (
+            (it->Serial == descriptor.Serial) &&
+            (it->BufferInfo == descriptor.BufferInfo) &&
+            (it->ImageInfo == descriptor.ImageInfo)
+         ) {
+            return; // re-binding what is already bound
+         }
+         *it = descriptor;
+      } else {
+         state.Descriptors.insert(it, descriptor);
+      }
+      state.Bound = nullptr;
+      state.Pending = true;
+   }
+
+
+   VulkanPipeline::CachedDescriptorSet& VulkanPipeline::GetCachedDescriptorSet(const uint32_t set) {
+      // The key identifies everything that is written to the set.
+      // Ranges, views and layouts are included as well as the serial because the same buffer can be bound with different ranges,
+      // and the same image with different views (mip levels) and layouts.
+      auto& state = m_DescriptorSets[set];
+      std::vector<uint64_t> key;
+      key.reserve(state.Descriptors.size() * 5);
+      for (const auto& descriptor : state.Descriptors) {
+         key.emplace_back(descriptor.Binding);
+         key.emplace_back(descriptor.Serial);
+         if (descriptor.ImageInfo.imageView) {
+            key.emplace_back(reinterpret_cast<uint64_t>(static_cast<VkImageView>(descriptor.ImageInfo.imageView)));
+            key.emplace_back(reinterpret_cast<uint64_t>(static_cast<VkSampler>(descriptor.ImageInfo.sampler)));
+            key.emplace_back(static_cast<uint64_t>(descriptor.ImageInfo.imageLayout));
+         } else {
+            key.emplace_back(descriptor.BufferInfo.offset);
+            key.emplace_back(descriptor.BufferInfo.range);
+         }
       }
-      uint32_t i = m_DescriptorSetIndices[set];
-      do {
-         if (!m_DescriptorSetBound[set][i] && (!m_DescriptorSetFences[set][i] || (m_Device->GetVkDevice().getFenceStatus(m_DescriptorSetFences[set][i]->GetVkFence()) == vk::Result::eSuccess))) {
-            m_DescriptorSetIndices[set] = i;
-            m_DescriptorSetPending[set] = true;
-            m_DescriptorSetFences[set][i] = nullptr;
-            return m_DescriptorSetInstances[set][i];
+
+      auto it = state.Cache.find(key);
+      if (it == state.Cache.end()) {
+         // Miss.  Recycle the least recently used set if the cache is full (and that set is no longer in use), otherwise allocate a new one.
+         constexpr size_t maxCachedDescriptorSets = 1024;
+         vk::DescriptorSet descriptorSet;
+         if (state.Cache.size() >= maxCachedDescriptorSets) {
+            auto lru = std::min_element(state.Cache.begin(), state.Cache.end(), [](const auto& a, const auto& b) { return a.second.LastUsed < b.second.LastUsed; });
+            if (!lru->second.Timeline || lru->second.Timeline->IsComplete(lru->second.TimelineValue)) {
+               descriptorSet = lru->second.DescriptorSet;
+               state.Cache.erase(lru);
+            }
          }
-         if (++i == m_DescriptorSetInstances[set].size()) {
-            i = 0;
+         if (!descriptorSet) {
+            descriptorSet = AllocateDescriptorSet(set);
          }
-      } while(i != m_DescriptorSetIndices[set]);
-      return AllocateDescriptorSet(set);
+
+         std::vector<vk::WriteDescriptorSet> writes;
+         writes.reserve(state.Descriptors.size());
+         for (const auto& descriptor : state.Descriptors) {
+            const bool isImage = static_cast<bool>(descriptor.ImageInfo.imageView);
+            writes.emplace_back(
+               descriptorSet                                 /*dstSet*/,
+               descriptor.Binding                            /*dstBinding*/,
+               0                                             /*dstArrayElement*/,
+               1                                             /*descriptorCount*/,
+               descriptor.Type                               /*descriptorType*/,
+               isImage ? &descriptor.ImageInfo : nullptr     /*pImageInfo*/,
+               isImage ? nullptr : &descriptor.BufferInfo    /*pBufferInfo*/,
+               nullptr                                       /*pTexelBufferView*/
+            );
+         }
+         m_Device->GetVkDevice().updateDescriptorSets(writes, nullptr);
+
+         it = state.Cache.emplace(std::move(key), CachedDescriptorSet {descriptorSet}).first;
+      }
+      return it->second;
    }
 
 
-   void VulkanPipeline::BindDescriptorSets(vk::CommandBuffer commandBuffer, std::shared_ptr<VulkanFence> fence) {
-      for (uint32_t i = 0; i < m_DescriptorSetInstances.size(); ++i) {
-         if (m_DescriptorSetPending[i]) {
-            commandBuffer.bindDescriptorSets(m_PipelineBindPoint, GetVkPipelineLayout(), i, m_DescriptorSetInstances[i][m_DescriptorSetIndices[i]], nullptr);
-            m_DescriptorSetFences[i][m_DescriptorSetIndices[i]] = fence;
-            m_DescriptorSetPending[i] = false;
-            m_DescriptorSetBound[i][m_DescriptorSetIndices[i]] = true;
+   void VulkanPipeline::BindDescriptorSets(vk::CommandBuffer commandBuffer, std::shared_ptr<VulkanTimeline> timeline) {
+      for (uint32_t i = 0; i < m_DescriptorSets.size(); ++i) {
+         auto& state = m_DescriptorSets[i];
+         if (state.Pending && state.IsBindless) {
+            commandBuffer.bindDescriptorSets(m_PipelineBindPoint, GetVkPipelineLayout(), i, m_Device->GetTextureTable().GetVkDescriptorSet(), nullptr);
+            state.Pending = false;
+         } else if (state.Pending && !state.Descriptors.empty()) {
+            if (!state.Bound) {
+               state.Bound = &GetCachedDescriptorSet(i);
+            }
+            commandBuffer.bindDescriptorSets(m_PipelineBindPoint, GetVkPipelineLayout(), i, state.Bound->DescriptorSet, nullptr);
+            state.Bound->Timeline = timeline;
+            state.Bound->TimelineValue = timeline->GetPendingValue();
+            state.Bound->LastUsed = ++m_DescriptorSetUseCount;
+            state.Pending = false;
          }
       }
    }
 
 
    void VulkanPipeline::UnbindDescriptorSets() {
-      for (auto& bound : m_DescriptorSetBound) {
-         std::fill(bound.begin(), bound.end(), false);
+      for (auto& state : m_DescriptorSets) {
+         state.Pending = true;
       }
    }
 
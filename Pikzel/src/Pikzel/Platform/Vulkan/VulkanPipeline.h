@@ -7,6 +7,7 @@
 
 #include <filesystem>
 #include <unordered_map>
+#include <vector>
 
 namespace Pikzel {
 
@@ -36,6 +37,21 @@ namespace Pikzel {
          }
          return count;
       }
+
+      // An unbounded array of sampled images is the global texture table (see VulkanTextureTable)
+      bool IsBindless() const {
+         return (Type == vk::DescriptorType::eCombinedImageSampler) && (Shape.size() == 1) && (Shape[0] == 0);
+      }
+   };
+
+
+   // A descriptor that has been set for a resource, but not necessarily written to a descriptor set yet
+   struct VulkanDescriptor {
+      uint32_t Binding = 0;
+      vk::DescriptorType Type = {};
+      uint64_t Serial = 0;                   // identifies the buffer or image
+      vk::DescriptorBufferInfo BufferInfo;   // }- whichever one is relevant to Type
+      vk::DescriptorImageInfo ImageInfo;     // }
    };
 
 
@@ -54,13 +70,19 @@ namespace Pikzel {
       std::shared_ptr<VulkanDevice> GetDevice();
 
       const std::vector<vk::DescriptorSetLayout>& GetVkDescriptorSetLayouts() const;
-      vk::DescriptorSet GetVkDescriptorSet(const uint32_t set);
-
-      // Bind the descriptors into the specified commandbuffer.  They should be considered "in use" (i.e. do not change them)
-      // until the specified fence is signaled.
-      void BindDescriptorSets(vk::CommandBuffer commandBuffer, std::shared_ptr<VulkanFence> fence);
-
-      // mark descriptors as not-bound (they might still be in use in some previously submitted frame (check fences)
+      // Set the descriptor for resource, to be used by subsequent draw (or dispatch) calls.
+      // Nothing is written to a descriptor set here.  That happens (if necessary) in BindDescriptorSets().
+      // serial identifies the buffer or image that the descriptor refers to (see VulkanDevice::NewSerial())
+      void SetDescriptor(const VulkanResource& resource, const vk::DescriptorBufferInfo& bufferInfo, const uint64_t serial);
+      void SetDescriptor(const VulkanResource& resource, const vk::DescriptorImageInfo& imageInfo, const uint64_t serial);
+
+      // Bind descriptor sets for the descriptors that have been set into the specified commandbuffer.
+      // Descriptor sets are cached, keyed by the descriptors that they contain, so a set is allocated and written only when this combination of
+      // descriptors has not been seen before.  Cached sets are never changed while in use, a set bound here is in use until timeline reaches
+      // the value that the commandbuffer's submission will signal (its pending value).
+      void BindDescriptorSets(vk::CommandBuffer commandBuffer, std::shared_ptr<VulkanTimeline> timeline);
+
+      // mark descriptor sets as needing to be bound again before the next draw call (e.g. because the pipeline has been bound again)
       void UnbindDescriptorSets();
 
       vk::Pipeline GetVkPipelineCompute() const;
@@ -97,6 +119,37 @@ namespace Pikzel {
 
       vk::DescriptorSet AllocateDescriptorSet(const uint32_t set);
 
+   private:
+      struct DescriptorSetKeyHash {
+         size_t operator()(const std::vector<uint64_t>& key) const {
+            size_t seed = key.size();
+            for (const auto value : key) {
+               seed ^= std::hash<uint64_t> {}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+         }
+      };
+
+      struct CachedDescriptorSet {
+         vk::DescriptorSet DescriptorSet;
+         std::shared_ptr<VulkanTimeline> Timeline; // }- the set is in use until Timeline reaches TimelineValue
+         uint64_t TimelineValue = 0;               // }
+         uint64_t LastUsed = 0;                    // value of m_DescriptorSetUseCount when the set was last bound
+      };
+
+      struct DescriptorSetState {
+         std::vector<VulkanDescriptor> Descriptors;   // descriptors that have been set, sorted by binding
+         CachedDescriptorSet* Bound = nullptr;        // cached set holding Descriptors (null if Descriptors have changed since it was looked up)
+         bool Pending = false;                        // true <=> set needs to be bound for next draw call
+         bool IsBindless = false;                     // true <=> set is the global texture table (which has no Descriptors or Cache of its own)
+         std::unordered_map<std::vector<uint64_t>, CachedDescriptorSet, DescriptorSetKeyHash> Cache;
+      };
+
+      void SetDescriptor(const VulkanResource& resource, const VulkanDescriptor& descriptor);
+
+      // Find (or, if not found, allocate and write) a descriptor set holding the descriptors that have been set for set
+      CachedDescriptorSet& GetCachedDescriptorSet(const uint32_t set);
+
    private:
       std::shared_ptr<VulkanDevice> m_Device;
       std::vector<vk::DescriptorSetLayout> m_DescriptorSetLayouts;
@@ -106,12 +159,9 @@ namespace Pikzel {
       vk::Pipeline m_PipelineFrontFaceCCW; // }- Need to create two variations of graphics pipelines, one has front faces CCW and the other has them CW
       vk::Pipeline m_PipelineFrontFaceCW;  // }  If/when VK_EXT_extended_dynamic_state becomes more widely available (e.g. in the nvidia general release drivers)
                                            // }  then the front face winding order can be a dynamic state
-      vk::DescriptorPool m_DescriptorPool;
-      std::vector<std::vector<vk::DescriptorSet>> m_DescriptorSetInstances;         // m_DescriptorSets[i] = collection of descriptor sets that have been allocated for set i
-      std::vector<std::vector<bool>> m_DescriptorSetBound;                          // m_DescriptorSetBound[i] = collection of booleans indicating which elements from m_DescriptorSets[i] are currently bound to the pipeline
-      std::vector<std::vector<std::shared_ptr<VulkanFence>>> m_DescriptorSetFences; // m_DescriptorSetFences[i] = collection of fences synchronizing access to m_DescriptorSets for set i
-      std::vector<uint32_t> m_DescriptorSetIndices;                                 // m_DescriptorSetIndices[i] = which element (of m_DescriptorSets) is currently available for writing for set i
-      std::vector<bool> m_DescriptorSetPending;                                     // m_DescriptorSetPending[i] = true <=> set i needs to be bound for next draw call
+      std::vector<vk::DescriptorPool> m_DescriptorPools;    // descriptor sets are allocated from the last pool.  Another is created when that one is exhausted
+      std::vector<DescriptorSetState> m_DescriptorSets;     // m_DescriptorSets[i] = descriptors, and cache of descriptor sets, for set i
+      uint64_t m_DescriptorSetUseCount = 0;                 // incremented each time a descriptor set is bound (gives the cache's least recently used order)
 
       std::vector<std::pair<ShaderType, std::vector<uint32_t>>> m_ShaderSrcs;
       std::vector<vk::SpecializationInfo> m_ShaderSpecializations;
@@ -65,10 +65,13 @@ namespace Pikzel {
       m_Instance.destroy(surface);
 
       VulkanMemoryAllocator::Init(m_Instance, m_Device->GetVkPhysicalDevice(), m_Device->GetVkDevice());
+      m_Device->CreateUploader();
    }
 
 
    VulkanRenderCore::~VulkanRenderCore() {
+      m_Device->CollectGarbage(true); // deferred destroys of buffers and images need the memory allocator
+      m_Device->DestroyUploader();
       VulkanMemoryAllocator::Get().destroy();
       m_Device = nullptr;
       DestroyInstance();
@@ -90,6 +93,21 @@ namespace Pikzel {
    }
 
 
+   bool VulkanRenderCore::SupportsBindlessTextures() const {
+      return m_Device->IsBindlessSupported();
+   }
+
+
+   bool VulkanRenderCore::SupportsIndirectFirstInstance() const {
+      return m_Device->GetEnabledPhysicalDeviceFeatures().drawIndirectFirstInstance;
+   }
+
+
+   bool VulkanRenderCore::SupportsIndirectCount() const {
+      return m_Device->GetEnabledPhysicalDeviceVulkan12Features().drawIndirectCount;
+   }
+
+
    std::unique_ptr<ComputeContext> VulkanRenderCore::CreateComputeContext() {
       return std::make_unique<VulkanComputeContext>(m_Device);
    }
@@ -115,6 +133,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> VulkanRenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return std::make_unique<VulkanIndexBuffer>(m_Device, count, indices);
+   }
+
+
    std::unique_ptr<UniformBuffer> VulkanRenderCore::CreateUniformBuffer(const uint32_t size) {
       return std::make_unique<VulkanUniformBuffer>(m_Device, size);
    }
@@ -125,6 +148,26 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<StorageBuffer> VulkanRenderCore::CreateStorageBuffer(const uint32_t size) {
+      return std::make_unique<VulkanStorageBuffer>(m_Device, size);
+   }
+
+
+   std::unique_ptr<StorageBuffer> VulkanRenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return std::make_unique<VulkanStorageBuffer>(m_Device, size, data);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> VulkanRenderCore::CreateIndirectBuffer(const uint32_t count) {
+      return std::make_unique<VulkanIndirectBuffer>(m_Device, count);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> VulkanRenderCore::CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands) {
+      return std::make_unique<VulkanIndirectBuffer>(m_Device, count, commands);
+   }
+
+
    std::unique_ptr<Framebuffer> VulkanRenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       return std::make_unique<VulkanFramebuffer>(m_Device, settings);
    }
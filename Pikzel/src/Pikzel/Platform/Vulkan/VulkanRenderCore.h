@@ -14,6 +14,10 @@ namespace Pikzel {
 
       virtual void SetViewport(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) override;
 
+      virtual bool SupportsBindlessTextures() const override;
+      virtual bool SupportsIndirectFirstInstance() const override;
+      virtual bool SupportsIndirectCount() const override;
+
       virtual std::unique_ptr<ComputeContext> CreateComputeContext() override;
       virtual std::unique_ptr<GraphicsContext> CreateGraphicsContext(const Window& window) override;
 
@@ -21,10 +25,17 @@ namespace Pikzel {
       virtual std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size,const void* data) override;
 
       virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices) override;
+      virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices) override;
 
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size) override;
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data) override;
 
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size) override;
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data) override;
+
+      virtual std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count) override;
+      virtual std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands) override;
+
       virtual std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings) override;
 
       virtual std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings) override;
@@ -1,13 +1,14 @@
 #include "VulkanTexture.h"
 
-#include "VulkanBuffer.h"
 #include "VulkanComputeContext.h"
 #include "VulkanPipeline.h"
 
+#include <cstring>
 #include <format>
 #include <memory>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace Pikzel {
 
@@ -140,6 +141,7 @@ namespace Pikzel {
 
 
    VulkanTexture::~VulkanTexture() {
+      RemoveFromTextureTable();
       DestroySampler();
       DestroyImage();
    }
@@ -220,31 +222,26 @@ namespace Pikzel {
             }
             CreateImage(TextureTypeToVkImageViewType(GetType()), width, height, layers * depth, mipLevels, TextureFormatToVkFormat(format), usage, aspect);
 
-              for (uint32_t layer = 0; layer < layers; ++layer) {
+            // All of the loaded layers, slices, and mip levels go up in one staged upload
+            const uint32_t loadedMipLevels = std::min(GetMIPLevels(), loader.GetMIPLevels());
+            std::vector<std::pair<const void*, uint32_t>> data;
+            std::vector<vk::BufferImageCopy> regions;
+            for (uint32_t layer = 0; layer < layers; ++layer) {
 
                // note: loader.GetDepth() is the actual number of slices in the data
                //       this->GetDepth() could be different (e.g. cubemaps will have loader.GetDepth() = 6, and this->GetDepth() = 1)
                for (uint32_t slice = 0; slice < loader.GetDepth(); ++slice) {
-                  for (uint32_t mipLevel = 0; mipLevel < std::min(mipLevels, loader.GetMIPLevels()); ++mipLevel) {
-                     const auto [data, size] = loader.GetData(layer, slice, mipLevel);
-                     SetDataInternal(layer, slice, mipLevel, size, data);
+                  for (uint32_t mipLevel = 0; mipLevel < loadedMipLevels; ++mipLevel) {
+                     data.emplace_back(loader.GetData(layer, slice, mipLevel));
+                     regions.emplace_back(GetRegion(layer, slice, mipLevel));
                   }
                }
             }
-            // here you have levels 0..min in transfer_dst_optimal,  and all the other ones undefined
-            // put the rest of them into transfer_dst_optimal also
-            uint32_t baseMipLevel = std::min(mipLevels, loader.GetMIPLevels()) - 1;
-            if (baseMipLevel < GetMIPLevels() - 1) {
-               m_Device->PipelineBarrier(
-                  vk::PipelineStageFlagBits::eAllCommands,
-                  vk::PipelineStageFlagBits::eTransfer,
-                  m_Image->Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, baseMipLevel + 1, (GetMIPLevels() - baseMipLevel - 1), 0, 0)
-               );
-            }
-            m_Image->GenerateMipmap(baseMipLevel);
+            Upload(data, std::move(regions), loadedMipLevels - 1);
          }
       }
       CreateSampler(settings);
+      AddToTextureTable();
    }
 
 
@@ -279,17 +276,21 @@ namespace Pikzel {
 
 
    void VulkanTexture::Commit(const uint32_t baseMipLevel) {
+      // recorded into the upload batch (rather than submitted on its own), so that it is ordered after any staged uploads to the texture
+      vk::CommandBuffer cmd = m_Device->GetUploader().GetGraphicsCommandBuffer();
       if (baseMipLevel < GetMIPLevels()) {
-         m_Device->PipelineBarrier(
+         cmd.pipelineBarrier(
             vk::PipelineStageFlagBits::eAllCommands,
             vk::PipelineStageFlagBits::eTransfer,
+            {}, nullptr, nullptr,
             m_Image->Barrier(vk::ImageLayout::eGeneral, vk::ImageLayout::eTransferDstOptimal, 0, 0, 0, 0)
          );
-         m_Image->GenerateMipmap(baseMipLevel);
+         m_Image->GenerateMipmap(cmd, baseMipLevel);
       } else {
-         m_Device->PipelineBarrier(
+         cmd.pipelineBarrier(
             vk::PipelineStageFlagBits::eAllCommands,
-            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+            {}, nullptr, nullptr,
             m_Image->Barrier(vk::ImageLayout::eGeneral, vk::ImageLayout::eShaderReadOnlyOptimal, 0, 0, 0, 0)
          );
       }
@@ -392,18 +393,25 @@ namespace Pikzel {
    }
 
 
+   uint64_t VulkanTexture::GetSerial() const {
+      return m_Serial;
+   }
+
+
+   uint32_t VulkanTexture::GetBindlessIndex() const {
+      return m_BindlessIndex;
+   }
+
+
    const Pikzel::VulkanImage& VulkanTexture::GetImage() const {
       PKZL_CORE_ASSERT(m_Image, "Attempted to access null image!");
       return *m_Image;
    }
 
 
-   void VulkanTexture::SetDataInternal(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel, const uint32_t size, const void* data) {
-      VulkanBuffer stagingBuffer(m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
-      stagingBuffer.CopyFromHost(0, size, data);
-
-      uint32_t width = GetWidth() >> mipLevel;
-      uint32_t height = GetHeight() >> mipLevel;
+   vk::BufferImageCopy VulkanTexture::GetRegion(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel) const {
+      uint32_t width = std::max(GetWidth() >> mipLevel, 1u);
+      uint32_t height = std::max(GetHeight() >> mipLevel, 1u);
       uint32_t depth = 1;
 
       uint32_t layerInternal = layer;
@@ -418,7 +426,7 @@ namespace Pikzel {
          sliceInternal = 0;
       }
 
-      vk::BufferImageCopy region = {
+      return {
          0                                    /*bufferOffset*/,
          0                                    /*bufferRowLength*/,
          0                                    /*bufferImageHeight*/,
@@ -431,8 +439,44 @@ namespace Pikzel {
          {0, 0, sliceInternal}                /*imageOffset*/,
          {width, height, depth}               /*imageExtent*/
       };
+   }
+
+
+   void VulkanTexture::Upload(const std::vector<std::pair<const void*, uint32_t>>& data, std::vector<vk::BufferImageCopy> regions, const uint32_t baseMipLevel) {
+      PKZL_CORE_ASSERT(data.size() == regions.size(), "Texture upload must have one data block per region!");
+
+      // Each region's data must start at a multiple of 4 bytes and of the format's texel (or compressed block) size.
+      // Those are all (1, 2, 4, 6, 8, 12, or 16 bytes) factors of 48.
+      static constexpr vk::DeviceSize regionAlignment = 48;
+
+      vk::DeviceSize size = 0;
+      for (size_t i = 0; i < regions.size(); ++i) {
+         size = ((size + regionAlignment - 1) / regionAlignment) * regionAlignment;
+         regions[i].bufferOffset = size;
+         size += data[i].second;
+      }
+
+      VulkanUploader& uploader = m_Device->GetUploader();
+      const VulkanUploader::Staging staging = uploader.Stage(size, regionAlignment);
+      for (size_t i = 0; i < regions.size(); ++i) {
+         memcpy(staging.data + regions[i].bufferOffset, data[i].first, data[i].second);
+         regions[i].bufferOffset += staging.offset;
+      }
+
+      vk::CommandBuffer cmd = uploader.GetGraphicsCommandBuffer();
 
-      m_Image->CopyFromBuffer(stagingBuffer.m_Buffer, region);
+      // CopyFromBuffer() puts the copied levels into transfer_dst_optimal.  The levels above those will be blitted into by
+      // GenerateMipmap(), so put them into transfer_dst_optimal also
+      if (baseMipLevel + 1 < GetMIPLevels()) {
+         cmd.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eTransfer,
+            {}, nullptr, nullptr,
+            m_Image->Barrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, baseMipLevel + 1, GetMIPLevels() - baseMipLevel - 1, 0, 0)
+         );
+      }
+      m_Image->CopyFromBuffer(cmd, staging.buffer, regions);
+      m_Image->GenerateMipmap(cmd, baseMipLevel);
    }
 
 
@@ -451,6 +495,7 @@ namespace Pikzel {
          vma::MemoryUsage::eGpuOnly
       );
       m_Image->CreateImageViews(format, aspect);
+      m_Serial = m_Device->NewSerial();
       if (usage & vk::ImageUsageFlagBits::eStorage) {
          m_Device->PipelineBarrier(
             vk::PipelineStageFlagBits::eAllCommands,
@@ -514,12 +559,33 @@ namespace Pikzel {
 
    void VulkanTexture::DestroySampler() {
       if (m_Device && m_TextureSampler) {
-         m_Device->GetVkDevice().destroy(m_TextureSampler);
+         m_Device->DeferDestroy([device = m_Device->GetVkDevice(), sampler = m_TextureSampler] {
+            device.destroy(sampler);
+         });
          m_TextureSampler = nullptr;
       }
    }
 
 
+   void VulkanTexture::AddToTextureTable() {
+      // The table is an array of sampler2D, so only 2D textures go in it
+      if ((GetType() == TextureType::Texture2D) && m_Device->IsBindlessSupported()) {
+         m_BindlessIndex = m_Device->GetTextureTable().Add(GetVkImageView(), m_TextureSampler);
+      }
+   }
+
+
+   void VulkanTexture::RemoveFromTextureTable() {
+      if (m_Device && (m_BindlessIndex != InvalidBindlessIndex)) {
+         // Submitted work may still be indexing the table with this texture's index, so do not free it for reuse until that has completed
+         m_Device->DeferDestroy([device = m_Device.get(), index = m_BindlessIndex] {
+            device->GetTextureTable().Remove(index);
+         });
+         m_BindlessIndex = InvalidBindlessIndex;
+      }
+   }
+
+
    VulkanTexture2D::VulkanTexture2D(std::shared_ptr<VulkanDevice> device, const TextureSettings& settings, vk::ImageUsageFlags usage, vk::ImageAspectFlags aspect) {
       Init(device, settings, usage, aspect);
    }
@@ -531,9 +597,6 @@ namespace Pikzel {
 
 
    void VulkanTexture2D::SetData(const void* data, uint32_t size) {
-      VulkanBuffer stagingBuffer(m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
-      stagingBuffer.CopyFromHost(0, size, data);
-
       vk::BufferImageCopy region = {
          0                                     /*bufferOffset*/,
          0                                     /*bufferRowLength*/,
@@ -548,8 +611,7 @@ namespace Pikzel {
          {GetWidth(), GetHeight(), GetDepth()} /*imageExtent*/
       };
 
-      m_Image->CopyFromBuffer(stagingBuffer.m_Buffer, region);
-      m_Image->GenerateMipmap(0); // equivalent to Commit()
+      Upload({{data, size}}, {region}, 0);
    }
 
 
@@ -575,8 +637,6 @@ namespace Pikzel {
 
 
    void VulkanTexture2DArray::SetData(const void* data, const uint32_t size) {
-      VulkanBuffer stagingBuffer(m_Device, size, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuToGpu);
-      stagingBuffer.CopyFromHost(0, size, data);
       vk::BufferImageCopy region = {
          0                                     /*bufferOffset*/,
          0                                     /*bufferRowLength*/,
@@ -590,8 +650,7 @@ namespace Pikzel {
          {0, 0, 0}                             /*imageOffset*/,
          {GetWidth(), GetHeight(), GetDepth()} /*imageExtent*/
       };
-      m_Image->CopyFromBuffer(stagingBuffer.m_Buffer, region);
-      m_Image->GenerateMipmap(0); // equivalent to Commit()
+      Upload({{data, size}}, {region}, 0);
    }
 
 
@@ -5,6 +5,8 @@
 #include "VulkanImage.h"
 
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 namespace Pikzel {
 
@@ -30,6 +32,8 @@ namespace Pikzel {
 
       virtual bool operator==(const Texture& that) override;
 
+      virtual uint32_t GetBindlessIndex() const override;
+
       void CopyFrom(const Texture& srcTexture, const TextureCopySettings& settings = {}) override;
 
    public:
@@ -39,6 +43,9 @@ namespace Pikzel {
       vk::ImageView GetVkImageView(const uint32_t mipLevel) const;
       vk::Sampler GetVkSampler() const;
 
+      // Identifies this texture's image (see VulkanDevice::NewSerial())
+      uint64_t GetSerial() const;
+
       const VulkanImage& GetImage() const;
 
    protected:
@@ -47,7 +54,12 @@ namespace Pikzel {
       virtual uint32_t CheckDepth(uint32_t depth) const = 0;
       virtual uint32_t CheckLayers(uint32_t layers) const = 0;
 
-      void SetDataInternal(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel, const uint32_t size, const void* data);
+      // Region of the image that loader data for (layer, slice, mipLevel) is copied into
+      vk::BufferImageCopy GetRegion(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel) const;
+
+      // Stage data (one {pointer, size} per region) and record, into the upload batch, copying it into the image regions and
+      // generating mip levels above baseMipLevel.  Nothing is submitted here, the upload happens when the batch is flushed.
+      void Upload(const std::vector<std::pair<const void*, uint32_t>>& data, std::vector<vk::BufferImageCopy> regions, const uint32_t baseMipLevel);
 
       void CreateImage(const vk::ImageViewType type, const uint32_t width, const uint32_t height, const uint32_t layers, const uint32_t mipLevels, const vk::Format format, vk::ImageUsageFlags usage, vk::ImageAspectFlags aspect);
       void DestroyImage();
@@ -55,11 +67,16 @@ namespace Pikzel {
       void CreateSampler(const TextureSettings& settings);
       void DestroySampler();
 
+      void AddToTextureTable();
+      void RemoveFromTextureTable();
+
    protected:
       std::filesystem::path m_Path;
       std::shared_ptr<VulkanDevice> m_Device;
       std::unique_ptr<VulkanImage> m_Image;
       vk::Sampler m_TextureSampler;
+      uint64_t m_Serial = 0;
+      uint32_t m_BindlessIndex = InvalidBindlessIndex;
       TextureFormat m_DataFormat; // this is used temporarily while uploading cubemap textures to GPU
    };
 
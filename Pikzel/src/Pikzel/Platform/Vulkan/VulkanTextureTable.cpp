@@ -0,0 +1,103 @@
+#include "VulkanTextureTable.h"
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Texture.h"
+
+namespace Pikzel {
+
+   VulkanTextureTable::VulkanTextureTable(vk::Device device, const uint32_t capacity)
+   : m_Device {device}
+   , m_Capacity {capacity}
+   {
+      PKZL_CORE_ASSERT(device, "null device");
+
+      vk::DescriptorSetLayoutBinding binding = {
+         0                                           /*binding*/,
+         vk::DescriptorType::eCombinedImageSampler   /*descriptorType*/,
+         m_Capacity                                  /*descriptorCount*/,
+         vk::ShaderStageFlagBits::eAll               /*stageFlags*/,
+         nullptr                                     /*pImmutableSamplers*/
+      };
+
+      // partially bound: not every slot holds a texture
+      // update after bind (and unused while pending): textures are added and removed while the set is in use
+      vk::DescriptorBindingFlags bindingFlags = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+      vk::StructureChain<vk::DescriptorSetLayoutCreateInfo, vk::DescriptorSetLayoutBindingFlagsCreateInfo> layoutCI {
+         vk::DescriptorSetLayoutCreateInfo {vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, 1, &binding},
+         vk::DescriptorSetLayoutBindingFlagsCreateInfo {1, &bindingFlags}
+      };
+      m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(layoutCI.get<vk::DescriptorSetLayoutCreateInfo>());
+
+      vk::DescriptorPoolSize poolSize = {vk::DescriptorType::eCombinedImageSampler, m_Capacity};
+      vk::DescriptorPoolCreateInfo poolCI = {
+         vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind   /*flags*/,
+         1                                                    /*maxSets*/,
+         1                                                    /*poolSizeCount*/,
+         &poolSize                                            /*pPoolSizes*/
+      };
+      m_DescriptorPool = m_Device.createDescriptorPool(poolCI);
+
+      vk::DescriptorSetAllocateInfo allocInfo = {
+         m_DescriptorPool         /*descriptorPool*/,
+         1                        /*descriptorSetCount*/,
+         &m_DescriptorSetLayout   /*pSetLayouts*/
+      };
+      m_DescriptorSet = m_Device.allocateDescriptorSets(allocInfo).front();
+   }
+
+
+   VulkanTextureTable::~VulkanTextureTable() {
+      m_Device.destroy(m_DescriptorPool);
+      m_Device.destroy(m_DescriptorSetLayout);
+   }
+
+
+   vk::DescriptorSetLayout VulkanTextureTable::GetVkDescriptorSetLayout() const {
+      return m_DescriptorSetLayout;
+   }
+
+
+   vk::DescriptorSet VulkanTextureTable::GetVkDescriptorSet() const {
+      return m_DescriptorSet;
+   }
+
+
+   uint32_t VulkanTextureTable::Add(vk::ImageView imageView, vk::Sampler sampler) {
+      uint32_t index = Texture::InvalidBindlessIndex;
+      if (!m_FreeIndices.empty()) {
+         index = m_FreeIndices.back();
+         m_FreeIndices.pop_back();
+      } else if (m_Next < m_Capacity) {
+         index = m_Next++;
+      } else {
+         PKZL_CORE_LOG_WARN("Bindless texture table is full ({0} textures).  Texture will not be available to bindless shaders!", m_Capacity);
+         return index;
+      }
+
+      vk::DescriptorImageInfo imageInfo = {
+         sampler,
+         imageView,
+         vk::ImageLayout::eShaderReadOnlyOptimal
+      };
+
+      vk::WriteDescriptorSet write = {
+         m_DescriptorSet                             /*dstSet*/,
+         0                                           /*dstBinding*/,
+         index                                       /*dstArrayElement*/,
+         1                                           /*descriptorCount*/,
+         vk::DescriptorType::eCombinedImageSampler   /*descriptorType*/,
+         &imageInfo                                  /*pImageInfo*/,
+         nullptr                                     /*pBufferInfo*/,
+         nullptr                                     /*pTexelBufferView*/
+      };
+      m_Device.updateDescriptorSets(write, nullptr);
+      return index;
+   }
+
+
+   void VulkanTextureTable::Remove(const uint32_t index) {
+      PKZL_CORE_ASSERT(index < m_Next, "Bindless texture index out of range!");
+      m_FreeIndices.emplace_back(index);
+   }
+
+}
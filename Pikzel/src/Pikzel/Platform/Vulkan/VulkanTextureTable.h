@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Pikzel {
+
+   // The global ("bindless") texture table.
+   // A single descriptor set holding one large array of combined image samplers, which every 2D texture is added to when it is created.
+   // Shaders declare the table as an unbounded array at binding 0 of a set of its own, e.g.
+   //    layout(set = 1, binding = 0) uniform sampler2D textures[];
+   // and index it with Texture::GetBindlessIndex() (supplied via push constants, or a material buffer), so there is nothing
+   // to bind per draw.  Pipelines bind the table's descriptor set for that set automatically (see VulkanPipeline).
+   //
+   // The table is written while it may be in use (update after bind), so slots must not be reused until the GPU has finished with
+   // the texture that was in them.  VulkanTexture defers Remove() for that reason.
+   // Not thread safe: render thread only.
+   class VulkanTextureTable final {
+   public:
+      static constexpr uint32_t MaxTextures = 16384;
+
+      VulkanTextureTable(vk::Device device, const uint32_t capacity);
+      VulkanTextureTable(const VulkanTextureTable&) = delete;
+      VulkanTextureTable& operator=(const VulkanTextureTable&) = delete;
+      ~VulkanTextureTable();
+
+      vk::DescriptorSetLayout GetVkDescriptorSetLayout() const;
+      vk::DescriptorSet GetVkDescriptorSet() const;
+
+      // Write imageView and sampler into a free slot of the table, returning the slot's index
+      // (or Texture::InvalidBindlessIndex if the table is full)
+      uint32_t Add(vk::ImageView imageView, vk::Sampler sampler);
+
+      // Free the slot at index.  The GPU must have finished with it.
+      void Remove(const uint32_t index);
+
+   private:
+      vk::Device m_Device;
+      vk::DescriptorSetLayout m_DescriptorSetLayout;
+      vk::DescriptorPool m_DescriptorPool;
+      vk::DescriptorSet m_DescriptorSet;
+      uint32_t m_Capacity = 0;
+      uint32_t m_Next = 0;                  // slots [m_Next, m_Capacity) have never been used
+      std::vector<uint32_t> m_FreeIndices;  // slots below m_Next that have been removed
+   };
+
+}
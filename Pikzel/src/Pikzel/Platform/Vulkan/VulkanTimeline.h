@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <vulkan/vulkan.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Pikzel {
+
+   class VulkanTimeline final {
+      // Manages a timeline semaphore, and the values that have been submitted to it.
+      // Each submission signals the next value, so "has the GPU finished with X yet?" is just a comparison
+      // of the value of the submission that used X with the (cached) value that the semaphore has reached,
+      // instead of a fence per submission that has to be reset, and polled.
+      //
+      // Why std::shared_ptr<VulkanTimeline>?
+      // Descriptor sets are created on-demand by a pipeline state object, and then get bound to a cmd buffer by a
+      // graphics context just before draw calls.  The pipeline is handed the context's timeline (and the value that the
+      // cmd buffer will signal), so that it knows that it cannot overwrite the descriptor set until that value is reached.
+      // If ownership of the timeline is not shared, then there is a chance that the graphics context could
+      // get destroyed (destroying the timeline with it), leaving the pipeline with a dangling pointer
+
+   public:
+      VulkanTimeline(vk::Device device)
+      : m_Device {device}
+      {
+         PKZL_CORE_ASSERT(device, "null device");
+         vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> ci {
+            vk::SemaphoreCreateInfo {},
+            vk::SemaphoreTypeCreateInfo {vk::SemaphoreType::eTimeline, 0}
+         };
+         m_Semaphore = device.createSemaphore(ci.get<vk::SemaphoreCreateInfo>());
+      }
+
+      VulkanTimeline(const VulkanTimeline&) = delete;
+      VulkanTimeline& operator=(const VulkanTimeline&) = delete;
+
+      ~VulkanTimeline() {
+         m_Device.destroy(m_Semaphore);
+      }
+
+      vk::Semaphore GetVkSemaphore() const {
+         return m_Semaphore;
+      }
+
+      // The value that the most recent submission signals
+      uint64_t GetSubmittedValue() const {
+         return m_SubmittedValue;
+      }
+
+      // The value that the next submission will signal (i.e. the one for work that is being recorded now)
+      uint64_t GetPendingValue() const {
+         return m_SubmittedValue + 1;
+      }
+
+      // Call once per submission (in the order that they are submitted), for the value that the submission is to signal
+      uint64_t Submit() {
+         return ++m_SubmittedValue;
+      }
+
+      // true if the GPU has signalled value.  Only asks the device if the answer is not already known.
+      bool IsComplete(const uint64_t value) {
+         if (value > m_CompletedValue) {
+            m_CompletedValue = std::max(m_CompletedValue, m_Device.getSemaphoreCounterValue(m_Semaphore));
+         }
+         return value <= m_CompletedValue;
+      }
+
+      // Block until the GPU has signalled value (which must have been submitted)
+      void Wait(const uint64_t value) {
+         PKZL_CORE_ASSERT(value <= m_SubmittedValue, "Waiting for a timeline value that has not been submitted!");
+         if (!IsComplete(value)) {
+            vk::SemaphoreWaitInfo wi = {
+               {}             /*flags*/,
+               1              /*semaphoreCount*/,
+               &m_Semaphore   /*pSemaphores*/,
+               &value         /*pValues*/
+            };
+            auto result = m_Device.waitSemaphores(wi, UINT64_MAX);
+            m_CompletedValue = std::max(m_CompletedValue, value);
+         }
+      }
+
+   private:
+      vk::Device m_Device;
+      vk::Semaphore m_Semaphore;
+      uint64_t m_SubmittedValue = 0;
+      uint64_t m_CompletedValue = 0;
+   };
+
+}
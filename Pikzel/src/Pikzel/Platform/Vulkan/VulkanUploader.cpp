@@ -0,0 +1,333 @@
+#include "VulkanUploader.h"
+
+#include "VulkanDevice.h"
+#include "Pikzel/Core/Core.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Pikzel {
+
+   VulkanUploader::VulkanUploader(VulkanDevice& device, const vk::DeviceSize ringSize/*= DefaultRingSize*/)
+   : m_Device {device}
+   , m_IsOwnershipTransferRequired {device.GetTransferQueueFamilyIndex() != device.GetGraphicsQueueFamilyIndex()}
+   , m_RingSize {ringSize}
+   {
+      m_CommandPool = m_Device.GetVkDevice().createCommandPool({
+         vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+         m_Device.GetTransferQueueFamilyIndex()
+      });
+      if (m_IsOwnershipTransferRequired) {
+         m_GraphicsCommandPool = m_Device.GetVkDevice().createCommandPool({
+            vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+            m_Device.GetGraphicsQueueFamilyIndex()
+         });
+      }
+
+      auto [buffer, allocation] = CreateStagingBuffer(m_RingSize);
+      m_Ring = buffer;
+      m_RingAllocation = allocation;
+      m_RingData = static_cast<std::byte*>(VulkanMemoryAllocator::Get().mapMemory(m_RingAllocation));
+   }
+
+
+   VulkanUploader::~VulkanUploader() {
+      WaitIdle();
+      for (const auto& batch : m_Free) {
+         m_Device.GetVkDevice().destroy(batch.fence);
+         m_Device.GetVkDevice().freeCommandBuffers(m_CommandPool, batch.commandBuffer);
+         if (m_IsOwnershipTransferRequired) {
+            m_Device.GetVkDevice().destroy(batch.copiesDone);
+            m_Device.GetVkDevice().freeCommandBuffers(m_GraphicsCommandPool, batch.graphicsCommandBuffer);
+         }
+      }
+      m_Free.clear();
+      VulkanMemoryAllocator::Get().unmapMemory(m_RingAllocation);
+      VulkanMemoryAllocator::Get().destroyBuffer(m_Ring, m_RingAllocation);
+      if (m_IsOwnershipTransferRequired) {
+         m_Device.GetVkDevice().destroy(m_GraphicsCommandPool);
+      }
+      m_Device.GetVkDevice().destroy(m_CommandPool);
+   }
+
+
+   void VulkanUploader::CopyToBuffer(vk::Buffer dst, const vk::DeviceSize dstOffset, const vk::DeviceSize size, const void* pData, const uint64_t inUseValue/*= 0*/) {
+      if (size == 0) {
+         return;
+      }
+
+      const Staging staging = Stage(size);
+      memcpy(staging.data, pData, static_cast<size_t>(size));
+
+      vk::BufferCopy copyRegion = {
+         staging.offset,
+         dstOffset,
+         size
+      };
+      Batch& batch = GetBatch();
+      batch.commandBuffer.copyBuffer(staging.buffer, dst, copyRegion);
+
+      if (m_IsOwnershipTransferRequired) {
+         // (if the transfer queue is the graphics queue, then the barrier at the start of the batch orders the copies after the work instead)
+         if ((inUseValue != 0) && !m_Device.GetTimeline().IsComplete(inUseValue)) {
+            batch.inUseValue = std::max(batch.inUseValue, inUseValue);
+         }
+
+         // consecutive copies to the same buffer are often contiguous (e.g. geometry appended to a pool), in which case one barrier covers them
+         if (!batch.ownershipBarriers.empty() && (batch.ownershipBarriers.back().buffer == dst) && (batch.ownershipBarriers.back().offset + batch.ownershipBarriers.back().size == dstOffset)) {
+            batch.ownershipBarriers.back().size += size;
+         } else {
+            batch.ownershipBarriers.emplace_back(
+               vk::AccessFlagBits::eTransferWrite           /*srcAccessMask*/,
+               vk::AccessFlags {}                           /*dstAccessMask*/,
+               m_Device.GetTransferQueueFamilyIndex()       /*srcQueueFamilyIndex*/,
+               m_Device.GetGraphicsQueueFamilyIndex()       /*dstQueueFamilyIndex*/,
+               dst                                          /*buffer*/,
+               dstOffset                                    /*offset*/,
+               size                                         /*size*/
+            );
+         }
+      }
+   }
+
+
+   VulkanUploader::Staging VulkanUploader::Stage(const vk::DeviceSize size, const vk::DeviceSize alignment/*= 16*/) {
+      if (const auto offset = Allocate(size, alignment); offset.has_value()) {
+         GetBatch();
+         return {m_Ring, *offset, m_RingData + *offset};
+      }
+
+      // too big for the ring.  Use a staging buffer of its own, which is destroyed when the batch completes
+      auto [buffer, allocation] = CreateStagingBuffer(size);
+      GetBatch().buffers.emplace_back(buffer, allocation);
+      return {buffer, 0, static_cast<std::byte*>(VulkanMemoryAllocator::Get().mapMemory(allocation))};
+   }
+
+
+   vk::CommandBuffer VulkanUploader::GetGraphicsCommandBuffer() {
+      return GetBatch().graphicsCommandBuffer;
+   }
+
+
+   void VulkanUploader::Flush() {
+      if (!m_Batch.has_value()) {
+         return;
+      }
+
+      // staging memory is written through mapped pointers, so needs flushing for the GPU to see it (if it is not host coherent)
+      VulkanMemoryAllocator::Get().flushAllocation(m_RingAllocation, 0, VK_WHOLE_SIZE);
+      for (const auto& [buffer, allocation] : m_Batch->buffers) {
+         VulkanMemoryAllocator::Get().flushAllocation(allocation, 0, VK_WHOLE_SIZE);
+      }
+
+      static constexpr vk::AccessFlags readAccess =
+         vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead |
+         vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eUniformRead |
+         vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead;
+
+      Batch& batch = *m_Batch;
+      if (m_IsOwnershipTransferRequired) {
+         // The copies can overwrite buffer ranges that graphics work already submitted is still reading (e.g. after a GeometryPool is compacted).
+         // If they do, then the transfer queue waits for the device timeline to reach the value that says that work is done.
+         // Otherwise (e.g. filling a new buffer) the copies can run alongside rendering.
+         //
+         // Release the copied ranges from the transfer queue family...
+         batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, batch.ownershipBarriers, nullptr);
+         batch.commandBuffer.end();
+
+         const vk::Semaphore timeline = m_Device.GetTimeline().GetVkSemaphore();
+         const uint64_t signalValue = 0; // binary semaphore, value is ignored
+         vk::PipelineStageFlags transferWaitStage = vk::PipelineStageFlagBits::eTransfer;
+         vk::TimelineSemaphoreSubmitInfo transferTimelineSI = {
+            batch.inUseValue ? 1u : 0u   /*waitSemaphoreValueCount*/,
+            &batch.inUseValue            /*pWaitSemaphoreValues*/,
+            1                            /*signalSemaphoreValueCount*/,
+            &signalValue                 /*pSignalSemaphoreValues*/
+         };
+         vk::SubmitInfo transferSI = {
+            batch.inUseValue ? 1u : 0u   /*waitSemaphoreCount*/,
+            &timeline                    /*pWaitSemaphores*/,
+            &transferWaitStage           /*pWaitDstStageMask*/,
+            1                            /*commandBufferCount*/,
+            &batch.commandBuffer         /*pCommandBuffers*/,
+            1                            /*signalSemaphoreCount*/,
+            &batch.copiesDone            /*pSignalSemaphores*/
+         };
+         transferSI.pNext = &transferTimelineSI;
+         m_Device.GetTransferQueue().submit(transferSI, nullptr);
+
+         // ...and acquire them on the graphics queue family.  Graphics work submitted from now on waits (on the GPU) for the copies, but only
+         // at the stages that read buffers, so e.g. clearing attachments and staged uploads' own commands (which do not depend on the copies) can go ahead.
+         // (the command buffer already has any other uploads' commands in it)
+         static constexpr vk::PipelineStageFlags readStages =
+            vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput |
+            vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader |
+            vk::PipelineStageFlagBits::eComputeShader;
+         for (auto& barrier : batch.ownershipBarriers) {
+            barrier.srcAccessMask = {};
+            barrier.dstAccessMask = readAccess & ~vk::AccessFlagBits::eTransferRead;
+         }
+         batch.graphicsCommandBuffer.pipelineBarrier(readStages, readStages, {}, nullptr, batch.ownershipBarriers, nullptr);
+         batch.graphicsCommandBuffer.end();
+
+         vk::PipelineStageFlags acquireWaitStage = readStages;
+         vk::SubmitInfo acquireSI = {
+            1                             /*waitSemaphoreCount*/,
+            &batch.copiesDone             /*pWaitSemaphores*/,
+            &acquireWaitStage             /*pWaitDstStageMask*/,
+            1                             /*commandBufferCount*/,
+            &batch.graphicsCommandBuffer   /*pCommandBuffers*/,
+            0                             /*signalSemaphoreCount*/,
+            nullptr                       /*pSignalSemaphores*/
+         };
+         m_Device.GetGraphicsQueue().submit(acquireSI, batch.fence);
+      } else {
+         // same queue, so a barrier is enough to make the copies visible to subsequently submitted work that reads the buffers
+         vk::MemoryBarrier barrier = {
+            vk::AccessFlagBits::eTransferWrite /*srcAccessMask*/,
+            readAccess                         /*dstAccessMask*/
+         };
+         batch.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, barrier, nullptr, nullptr);
+         batch.commandBuffer.end();
+
+         vk::SubmitInfo si;
+         si.commandBufferCount = 1;
+         si.pCommandBuffers = &batch.commandBuffer;
+         m_Device.GetTransferQueue().submit(si, batch.fence);
+      }
+
+      m_Batch->ringEnd = m_Head;
+      m_InFlight.emplace_back(std::move(*m_Batch));
+      m_Batch.reset();
+   }
+
+
+   void VulkanUploader::WaitIdle() {
+      Flush();
+      while (!m_InFlight.empty()) {
+         Retire(true);
+      }
+   }
+
+
+   bool VulkanUploader::IsBusy() const {
+      return m_Batch.has_value() || !m_InFlight.empty();
+   }
+
+
+   std::pair<vk::Buffer, vma::Allocation> VulkanUploader::CreateStagingBuffer(const vk::DeviceSize size) {
+      vk::BufferCreateInfo bufferInfo = {};
+      bufferInfo.size = size;
+      bufferInfo.usage = vk::BufferUsageFlagBits::eTransferSrc;
+
+      // Staged data is read by the transfer queue (buffer copies) and by the graphics queue (staged uploads' own commands).
+      // Staging buffers are never released/acquired, so if those are different queue families the buffer must be shared by both.
+      const uint32_t queueFamilyIndices[] = {m_Device.GetTransferQueueFamilyIndex(), m_Device.GetGraphicsQueueFamilyIndex()};
+      if (m_IsOwnershipTransferRequired) {
+         bufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+         bufferInfo.queueFamilyIndexCount = 2;
+         bufferInfo.pQueueFamilyIndices = queueFamilyIndices;
+      }
+
+      vma::AllocationCreateInfo allocInfo = {};
+      allocInfo.usage = vma::MemoryUsage::eCpuToGpu;
+
+      return VulkanMemoryAllocator::Get().createBuffer(bufferInfo, allocInfo);
+   }
+
+
+   std::optional<vk::DeviceSize> VulkanUploader::Allocate(const vk::DeviceSize size, const vk::DeviceSize alignment) {
+      if (size > m_RingSize) {
+         return {};
+      }
+      for (;;) {
+         // if nothing is in use, start again from the beginning of the ring (so that the whole ring is available)
+         if (m_Tail == m_Head) {
+            m_Head = ((m_Head + m_RingSize - 1) / m_RingSize) * m_RingSize;
+            m_Tail = m_Head;
+         }
+
+         // Allocations do not wrap around the end of the ring.  If there is not room before the end, then skip to the start.
+         // (alignment is of the offset into the ring, so is applied within the current lap of the ring)
+         uint64_t lap = (m_Head / m_RingSize) * m_RingSize;
+         uint64_t offset = ((m_Head - lap + alignment - 1) / alignment) * alignment;
+         if (offset + size > m_RingSize) {
+            lap += m_RingSize;
+            offset = 0;
+         }
+         if (lap + offset + size - m_Tail <= m_RingSize) {
+            m_Head = lap + offset + size;
+            return offset;
+         }
+
+         // Not enough free space.  Wait for the oldest batch to complete (submitting the current batch first, if it is the only one holding space)
+         if (m_InFlight.empty()) {
+            Flush();
+         }
+         PKZL_CORE_ASSERT(!m_InFlight.empty(), "VulkanUploader ring space is in use, but not by any batch!");
+         Retire(true);
+      }
+   }
+
+
+   VulkanUploader::Batch& VulkanUploader::GetBatch() {
+      if (!m_Batch.has_value()) {
+         Retire(false);
+         if (m_Free.empty()) {
+            Batch batch;
+            batch.commandBuffer = m_Device.GetVkDevice().allocateCommandBuffers({
+               m_CommandPool                    /*commandPool*/,
+               vk::CommandBufferLevel::ePrimary /*level*/,
+               1                                /*commandBufferCount*/
+            }).front();
+            batch.fence = m_Device.GetVkDevice().createFence({});
+            if (m_IsOwnershipTransferRequired) {
+               batch.graphicsCommandBuffer = m_Device.GetVkDevice().allocateCommandBuffers({
+                  m_GraphicsCommandPool             /*commandPool*/,
+                  vk::CommandBufferLevel::ePrimary /*level*/,
+                  1                                /*commandBufferCount*/
+               }).front();
+               batch.copiesDone = m_Device.GetVkDevice().createSemaphore({});
+            } else {
+               batch.graphicsCommandBuffer = batch.commandBuffer;
+            }
+            m_Batch = std::move(batch);
+         } else {
+            m_Batch = std::move(m_Free.back());
+            m_Free.pop_back();
+            m_Device.GetVkDevice().resetFences(m_Batch->fence);
+         }
+         m_Batch->commandBuffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+         // copies must not overwrite buffers that previously submitted work is still reading
+         // (if the transfer queue is not the graphics queue, this is done by semaphore instead.  See Flush())
+         m_Batch->commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, nullptr);
+         if (m_IsOwnershipTransferRequired) {
+            m_Batch->graphicsCommandBuffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+         }
+      }
+      return *m_Batch;
+   }
+
+
+   // Recycle batches that have completed (waiting for the oldest one to complete first, if wait is true)
+   void VulkanUploader::Retire(const bool wait) {
+      if (wait && !m_InFlight.empty()) {
+         auto result = m_Device.GetVkDevice().waitForFences(m_InFlight.front().fence, true, UINT64_MAX);
+      }
+      while (!m_InFlight.empty() && (m_Device.GetVkDevice().getFenceStatus(m_InFlight.front().fence) == vk::Result::eSuccess)) {
+         Batch& batch = m_InFlight.front();
+         m_Tail = std::max(m_Tail, batch.ringEnd);
+         for (const auto& [buffer, allocation] : batch.buffers) {
+            VulkanMemoryAllocator::Get().unmapMemory(allocation);
+            VulkanMemoryAllocator::Get().destroyBuffer(buffer, allocation);
+         }
+         batch.buffers.clear();
+         batch.ownershipBarriers.clear();
+         batch.inUseValue = 0;
+         m_Free.emplace_back(std::move(batch));
+         m_InFlight.pop_front();
+      }
+   }
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "VulkanMemoryAllocator.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Pikzel {
+
+   class VulkanDevice;
+
+   // Copies data from host to device local buffers via a persistently mapped staging ring.
+   // Copies are recorded into a batch (one command buffer), and nothing is submitted to the GPU until the batch is flushed,
+   // so loading a model is a handful of submits instead of a submit (and a wait for the queue to go idle) per buffer.
+   // Ring space is recycled once the batch that used it has completed.
+   //
+   // Batches are submitted to the transfer queue.  If that is a different queue family to graphics, then the copied buffer ranges are
+   // released by the transfer queue and acquired by the graphics queue (which waits, on the GPU, for the copies via a semaphore, but only
+   // at the stages that read buffers).  The copies themselves only wait for graphics work if they overwrite something that it may be reading.
+   // Either way, graphics work submitted after Flush() sees the copies, and the CPU never waits for them (unless the ring is full).
+   //
+   // Uploads that need more than a buffer copy (e.g. images, which need layout transitions and mipmap generation) Stage() their data,
+   // and then record their own commands into the batch's graphics queue command buffer.
+   // Not thread safe: render thread only.
+   class VulkanUploader final {
+   public:
+      static constexpr vk::DeviceSize DefaultRingSize = 64 * 1024 * 1024;
+
+      struct Staging {
+         vk::Buffer buffer;
+         vk::DeviceSize offset = 0;
+         std::byte* data = nullptr;
+      };
+
+      VulkanUploader(VulkanDevice& device, const vk::DeviceSize ringSize = DefaultRingSize);
+      VulkanUploader(const VulkanUploader&) = delete;
+      VulkanUploader& operator=(const VulkanUploader&) = delete;
+      ~VulkanUploader();
+
+      // Copy size bytes from host (pData) to dst at dstOffset.
+      // The data is copied into the staging ring immediately (so pData can be discarded on return), but the GPU copy
+      // does not happen until the batch is flushed.
+      // If graphics work may still be reading the range being overwritten, then inUseValue is the value of the device's timeline
+      // that signals that work is done (and the copy waits for it).  0 => the range is not in use
+      void CopyToBuffer(vk::Buffer dst, const vk::DeviceSize dstOffset, const vk::DeviceSize size, const void* pData, const uint64_t inUseValue = 0);
+
+      // Reserve size bytes of staging memory, at an offset that is a multiple of alignment (which need not be a power of two), for the current batch.
+      // Fill it via data, and then record the commands that read it (see GetGraphicsCommandBuffer()) before staging anything else,
+      // as staging can flush the batch.
+      Staging Stage(const vk::DeviceSize size, const vk::DeviceSize alignment = 16);
+
+      // Command buffer of the current batch that executes on the graphics queue, after the batch's buffer copies
+      vk::CommandBuffer GetGraphicsCommandBuffer();
+
+      // Submit the current batch, if there is anything in it
+      void Flush();
+
+      // Flush, and then wait for all submitted batches to complete
+      void WaitIdle();
+
+      // true if there are copies that have not yet completed on the GPU (whether or not they have been submitted)
+      bool IsBusy() const;
+
+   private:
+      struct Batch {
+         vk::CommandBuffer commandBuffer;                             // transfer queue: the copies
+         vk::CommandBuffer graphicsCommandBuffer;                     // graphics queue: acquires ownership of what was copied, and staged uploads' own commands (same as commandBuffer if queue families are the same)
+         vk::Semaphore copiesDone;                                    // signalled by transfer queue when the copies are done (only if queue families differ)
+         uint64_t inUseValue = 0;                                     // value of the device timeline that the copies must wait for (0 => none.  Only if queue families differ)
+         vk::Fence fence;                                             // signalled when the batch (including the acquire) has completed
+         uint64_t ringEnd = 0;                                        // ring space up to here is free once the batch completes
+         std::vector<std::pair<vk::Buffer, vma::Allocation>> buffers; // staging buffers (mapped) for uploads too big for the ring
+         std::vector<vk::BufferMemoryBarrier> ownershipBarriers;      // buffer ranges written by the batch (only if queue families differ)
+      };
+
+      std::pair<vk::Buffer, vma::Allocation> CreateStagingBuffer(const vk::DeviceSize size);
+
+      // Returns offset into the ring of size bytes of free space, or nullopt if the ring is not big enough
+      std::optional<vk::DeviceSize> Allocate(const vk::DeviceSize size, const vk::DeviceSize alignment);
+
+      Batch& GetBatch();
+      void Retire(const bool wait);
+
+   private:
+      VulkanDevice& m_Device;
+      vk::CommandPool m_CommandPool;         // transfer queue family
+      vk::CommandPool m_GraphicsCommandPool; // graphics queue family (only if queue families differ)
+      bool m_IsOwnershipTransferRequired = false;
+
+      vk::Buffer m_Ring;
+      vma::Allocation m_RingAllocation;
+      std::byte* m_RingData = nullptr;
+      vk::DeviceSize m_RingSize = 0;
+
+      // m_Head and m_Tail count bytes since the ring was created (so they never wrap).  Space [m_Tail, m_Head) is in use.
+      uint64_t m_Head = 0;
+      uint64_t m_Tail = 0;
+
+      std::optional<Batch> m_Batch;   // batch that copies are currently being recorded into
+      std::deque<Batch> m_InFlight;   // submitted batches, oldest first
+      std::vector<Batch> m_Free;      // completed batches, whose command buffer and fence can be reused
+   };
+
+}
@@ -90,16 +90,26 @@ namespace Pikzel {
             indices.ComputeFamily = i;
          }
 
-         if (queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) {
-            indices.TransferFamily = i;
+         if (indices.GraphicsFamily.has_value() && indices.PresentFamily.has_value() && indices.ComputeFamily.has_value()) {
+            break;
          }
 
-         if (indices.GraphicsFamily.has_value() && indices.PresentFamily.has_value() && indices.ComputeFamily.has_value() && indices.TransferFamily.has_value()) {
+         ++i;
+      }
+
+      // Prefer a transfer only family (typically backed by DMA engines), so that uploads can run alongside graphics work.
+      // Otherwise transfer on the graphics family (which always supports transfer, whether or not it says so)
+      i = 0;
+      for (const auto& queueFamily : queueFamilies) {
+         if ((queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) && !(queueFamily.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+            indices.TransferFamily = i;
             break;
          }
-
          ++i;
       }
+      if (!indices.TransferFamily.has_value()) {
+         indices.TransferFamily = indices.GraphicsFamily;
+      }
 
       return indices;
    }
@@ -25,6 +25,12 @@ namespace Pikzel {
          case DataType::DVec2:    return "DVec2";
          case DataType::DVec3:    return "DVec3";
          case DataType::DVec4:    return "DVec4";
+         case DataType::SNorm16Vec2: return "SNorm16Vec2";
+         case DataType::SNorm16Vec4: return "SNorm16Vec4";
+         case DataType::UNorm16Vec2: return "UNorm16Vec2";
+         case DataType::UNorm16Vec4: return "UNorm16Vec4";
+         case DataType::HVec2:    return "HVec2";
+         case DataType::HVec4:    return "HVec4";
          case DataType::Mat2:     return "Mat2";
          case DataType::Mat2x3:   return "Mat2x3";
          case DataType::Mat2x4:   return "Mat2x4";
@@ -72,6 +78,12 @@ namespace Pikzel {
          case DataType::DVec2:    return 8 * 2;
          case DataType::DVec3:    return 8 * 3;
          case DataType::DVec4:    return 8 * 4;
+         case DataType::SNorm16Vec2: return 2 * 2;
+         case DataType::SNorm16Vec4: return 2 * 4;
+         case DataType::UNorm16Vec2: return 2 * 2;
+         case DataType::UNorm16Vec4: return 2 * 4;
+         case DataType::HVec2:    return 2 * 2;
+         case DataType::HVec4:    return 2 * 4;
          case DataType::Mat2:     return 4 * 2 * 2;
          case DataType::Mat2x3:   return 4 * 2 * 3;
          case DataType::Mat2x4:   return 4 * 2 * 4;
@@ -97,10 +109,35 @@ namespace Pikzel {
    }
 
 
+   bool DataTypeIsNormalized(DataType type) {
+      switch (type) {
+         case DataType::SNorm16Vec2:
+         case DataType::SNorm16Vec4:
+         case DataType::UNorm16Vec2:
+         case DataType::UNorm16Vec4:
+            return true;
+         default:
+            return false;
+      }
+   }
+
+
+   uint32_t IndexTypeSize(IndexType type) {
+      switch (type) {
+         case IndexType::UInt16: return 2;
+         case IndexType::UInt32: return 4;
+      }
+      PKZL_CORE_ASSERT(false, "Unknown IndexType!");
+      return 0;
+   }
+
+
    BufferElement::BufferElement(const std::string& name, DataType type)
    : name {name}
    , dataType {type}
    , size {DataTypeSize(type)}
+   , offset {0}
+   , normalized {DataTypeIsNormalized(type)}
    {}
 
 
@@ -126,6 +163,12 @@ namespace Pikzel {
          case DataType::DVec2:    return 2;
          case DataType::DVec3:    return 3;
          case DataType::DVec4:    return 4;
+         case DataType::SNorm16Vec2: return 2;
+         case DataType::SNorm16Vec4: return 4;
+         case DataType::UNorm16Vec2: return 2;
+         case DataType::UNorm16Vec4: return 4;
+         case DataType::HVec2:    return 2;
+         case DataType::HVec4:    return 4;
          case DataType::Mat2:     return 2; // 2 * vec2,
          case DataType::Mat2x3:   return 2; // 2 * vec3, etc.
          case DataType::Mat2x4:   return 2;
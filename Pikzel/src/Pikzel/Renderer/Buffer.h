@@ -26,6 +26,12 @@ namespace Pikzel {
       DVec2,
       DVec3,
       DVec4,
+      SNorm16Vec2,   // } Packed formats.  Only valid as vertex attributes.
+      SNorm16Vec4,   // } SNorm16 and UNorm16 are 16-bit integers that the shader reads as floats normalized to [-1, 1] and [0, 1] respectively.
+      UNorm16Vec2,   // } HVec are 16-bit (half precision) floats that the shader reads as 32-bit floats.
+      UNorm16Vec4,   // }
+      HVec2,         // }
+      HVec4,         // }
       Mat2,
       Mat2x3,
       Mat2x4,
@@ -49,6 +55,16 @@ namespace Pikzel {
 
    std::string PKZL_API DataTypeToString(DataType type);
    uint32_t PKZL_API DataTypeSize(DataType type);
+   bool PKZL_API DataTypeIsNormalized(DataType type);
+
+
+   enum class IndexType {
+      UInt16,
+      UInt32
+   };
+   inline constexpr uint32_t IndexTypeCount = 2;
+
+   uint32_t PKZL_API IndexTypeSize(IndexType type);
 
 
    struct PKZL_API BufferElement {
@@ -56,7 +72,7 @@ namespace Pikzel {
       DataType dataType;
       uint32_t size;
       uint32_t offset;
-      bool normalized;
+      bool normalized;  // true for normalized integer types (see DataTypeIsNormalized())
 
       BufferElement(const std::string& name, DataType type);
 
@@ -109,6 +125,7 @@ namespace Pikzel {
       virtual ~IndexBuffer() = default;
 
       virtual uint32_t GetCount() const = 0;
+      virtual IndexType GetIndexType() const = 0;
    };
 
 
@@ -117,4 +134,31 @@ namespace Pikzel {
       virtual ~UniformBuffer() = default;
    };
 
+
+   class PKZL_API StorageBuffer : public Buffer {
+   public:
+      virtual ~StorageBuffer() = default;
+   };
+
+
+   // Parameters for one indexed draw, as read by the GPU from an IndirectBuffer.
+   // This has the same layout as both VkDrawIndexedIndirectCommand, and OpenGL's DrawElementsIndirectCommand
+   struct DrawIndexedIndirectCommand {
+      uint32_t indexCount = 0;
+      uint32_t instanceCount = 1;
+      uint32_t firstIndex = 0;
+      int32_t vertexOffset = 0;
+      uint32_t firstInstance = 0;
+   };
+   static_assert(sizeof(DrawIndexedIndirectCommand) == 5 * sizeof(uint32_t), "DrawIndexedIndirectCommand layout must match VkDrawIndexedIndirectCommand");
+
+
+   class PKZL_API IndirectBuffer : public Buffer {
+   public:
+      virtual ~IndirectBuffer() = default;
+
+      // number of DrawIndexedIndirectCommands that the buffer holds
+      virtual uint32_t GetCount() const = 0;
+   };
+
 }
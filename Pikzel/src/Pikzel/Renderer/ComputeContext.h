@@ -18,6 +18,17 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) = 0;
       virtual void Unbind(const UniformBuffer& buffer) = 0;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) = 0;
+      virtual void Unbind(const StorageBuffer& buffer) = 0;
+
+      // Bind an indirect buffer as a shader storage buffer, so that a compute shader can write draw commands into it
+      virtual void Bind(const Id resourceId, const IndirectBuffer& buffer) = 0;
+      virtual void Unbind(const IndirectBuffer& buffer) = 0;
+
+      // Set every uint32_t of buffer to value.
+      // Unlike StorageBuffer::CopyFromHost(), this happens on the GPU, in order with the compute work around it
+      virtual void Fill(const StorageBuffer& buffer, const uint32_t value) = 0;
+
       virtual void Bind(const Id resourceId, const Texture& texture, const uint32_t mipLevel = ~0) = 0;
       virtual void Unbind(const Texture& texture) = 0;
 
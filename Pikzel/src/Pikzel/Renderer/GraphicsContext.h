@@ -37,6 +37,12 @@ namespace Pikzel {
 
       virtual void SwapBuffers() = 0;
 
+      // The GPU may still be drawing earlier frames while the current one is being recorded, so buffers that are rewritten every frame
+      // need one copy per frame in flight.  The current frame (from BeginFrame() to SwapBuffers()) may only write copy GetFrameIndex(),
+      // which is in [0, GetMaxFramesInFlight())
+      virtual uint32_t GetMaxFramesInFlight() const { return 1; }
+      virtual uint32_t GetFrameIndex() const { return 0; }
+
       virtual void Bind(const VertexBuffer& buffer) = 0;
       virtual void Unbind(const VertexBuffer& buffer) = 0;
 
@@ -46,6 +52,9 @@ namespace Pikzel {
       virtual void Bind(const Id resourceId, const UniformBuffer& buffer) = 0;
       virtual void Unbind(const UniformBuffer& buffer) = 0;
 
+      virtual void Bind(const Id resourceId, const StorageBuffer& buffer) = 0;
+      virtual void Unbind(const StorageBuffer& buffer) = 0;
+
       virtual void Bind(const Id resourceId, const Texture& texture) = 0;
       virtual void Unbind(const Texture& texture) = 0;
 
@@ -105,9 +114,30 @@ namespace Pikzel {
       virtual void DrawTriangles(const VertexBuffer& vertexBuffer, const uint32_t vertexCount, const uint32_t vertexOffset = 0) = 0;
 
       // Draw contents of vertex buffer, as triangles indexed by index buffer.
-      // The number of vertices drawn is determined by the number of indices in the index buffer, unless you override the indexCount parameter.
-      // Drawing starts from [vertexOffset]th element of the vertex buffer (default 0)
-      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0) = 0;
+      // The number of vertices drawn is determined by the number of indices in the index buffer (from firstIndex onwards), unless you override the indexCount parameter.
+      // Drawing starts from [firstIndex]th element of the index buffer, and indices are relative to the [vertexOffset]th element of the vertex buffer (both default 0).
+      // This allows many meshes to share one vertex buffer and one index buffer (see GeometryPool)
+      virtual void DrawIndexed(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) = 0;
+
+      // As for DrawIndexed(), but draws instanceCount instances.
+      // Instances are numbered from firstInstance (i.e. gl_InstanceIndex runs from firstInstance to firstInstance + instanceCount - 1),
+      // so that shaders can use it to index per-instance data (e.g. transforms in a storage buffer)
+      virtual void DrawIndexedInstanced(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const uint32_t instanceCount, const uint32_t firstInstance = 0, const uint32_t indexCount = 0, const uint32_t vertexOffset = 0, const uint32_t firstIndex = 0) = 0;
+
+      // Draw triangles indexed by index buffer, with the draw parameters (index count, instance count, etc.) taken from
+      // the [commandIndex]th DrawIndexedIndirectCommand in the indirect buffer.
+      // The parameters are read by the GPU at the time the draw executes (so the indirect buffer can be written by the GPU, e.g. by a compute shader)
+      virtual void DrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t commandIndex = 0) = 0;
+
+      // As for DrawIndexedIndirect(), but issues drawCount draws (commands [firstCommand, firstCommand + drawCount) of the indirect buffer)
+      // with one call.
+      // Shaders can tell the draws apart via firstInstance (which is included in gl_InstanceIndex)
+      virtual void MultiDrawIndexedIndirect(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const uint32_t drawCount, const uint32_t firstCommand = 0) = 0;
+
+      // As for MultiDrawIndexedIndirect(), but the number of draws is read by the GPU from the [countIndex]th uint32_t of countBuffer
+      // (and is clamped to maxDrawCount).
+      // This allows both the commands and their number to be generated on the GPU (e.g. by a culling compute shader)
+      virtual void DrawIndexedIndirectCount(const VertexBuffer& vertexBuffer, const IndexBuffer& indexBuffer, const IndirectBuffer& indirectBuffer, const StorageBuffer& countBuffer, const uint32_t maxDrawCount, const uint32_t firstCommand = 0, const uint32_t countIndex = 0) = 0;
 
    };
 
@@ -105,6 +105,21 @@ namespace Pikzel {
    }
 
 
+   bool RenderCore::SupportsBindlessTextures() {
+      return s_RenderCore->SupportsBindlessTextures();
+   }
+
+
+   bool RenderCore::SupportsIndirectFirstInstance() {
+      return s_RenderCore->SupportsIndirectFirstInstance();
+   }
+
+
+   bool RenderCore::SupportsIndirectCount() {
+      return s_RenderCore->SupportsIndirectCount();
+   }
+
+
    std::unique_ptr<ComputeContext> RenderCore::CreateComputeContext() {
       return s_RenderCore->CreateComputeContext();
    }
@@ -130,6 +145,11 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<IndexBuffer> RenderCore::CreateIndexBuffer(const uint32_t count, const uint16_t* indices) {
+      return s_RenderCore->CreateIndexBuffer(count, indices);
+   }
+
+
    std::unique_ptr<Pikzel::UniformBuffer> RenderCore::CreateUniformBuffer(const uint32_t size) {
       return s_RenderCore->CreateUniformBuffer(size);
    }
@@ -140,6 +160,26 @@ namespace Pikzel {
    }
 
 
+   std::unique_ptr<StorageBuffer> RenderCore::CreateStorageBuffer(const uint32_t size) {
+      return s_RenderCore->CreateStorageBuffer(size);
+   }
+
+
+   std::unique_ptr<StorageBuffer> RenderCore::CreateStorageBuffer(const uint32_t size, const void* data) {
+      return s_RenderCore->CreateStorageBuffer(size, data);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> RenderCore::CreateIndirectBuffer(const uint32_t count) {
+      return s_RenderCore->CreateIndirectBuffer(count);
+   }
+
+
+   std::unique_ptr<IndirectBuffer> RenderCore::CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands) {
+      return s_RenderCore->CreateIndirectBuffer(count, commands);
+   }
+
+
    std::unique_ptr<Pikzel::Framebuffer> RenderCore::CreateFramebuffer(const FramebufferSettings& settings) {
       if(!(
          (settings.msaaNumSamples == 1) ||
@@ -23,6 +23,10 @@ namespace Pikzel {
 
       virtual void SetViewport(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height) = 0;
 
+      virtual bool SupportsBindlessTextures() const = 0;
+      virtual bool SupportsIndirectFirstInstance() const = 0;
+      virtual bool SupportsIndirectCount() const = 0;
+
       virtual std::unique_ptr<ComputeContext> CreateComputeContext() = 0;
       virtual std::unique_ptr<GraphicsContext> CreateGraphicsContext(const Window& window) = 0;
 
@@ -30,10 +34,17 @@ namespace Pikzel {
       virtual std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data) = 0;
 
       virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices) = 0;
+      virtual std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices) = 0;
 
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size) = 0;
       virtual std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data) = 0;
 
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size) = 0;
+      virtual std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data) = 0;
+
+      virtual std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count) = 0;
+      virtual std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands) = 0;
+
       virtual std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings) = 0;
 
       virtual std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings) = 0;
@@ -69,6 +80,17 @@ namespace Pikzel {
 
       static void SetViewport(const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height);
 
+      // true if textures can be fetched by index from the global texture table (see Texture::GetBindlessIndex()),
+      // instead of being bound to the pipeline before each draw
+      static bool SupportsBindlessTextures();
+
+      // true if indirect draw commands may have a non-zero firstInstance.
+      // Instanced shaders index per-instance data by gl_InstanceIndex, so without this only one batch of instances can be drawn per indirect buffer
+      static bool SupportsIndirectFirstInstance();
+
+      // true if GraphicsContext::DrawIndexedIndirectCount() is supported (i.e. the GPU can read the number of draws from a buffer)
+      static bool SupportsIndirectCount();
+
       static std::unique_ptr<ComputeContext> CreateComputeContext();
       static std::unique_ptr<GraphicsContext> CreateGraphicsContext(const Window& window);
 
@@ -76,10 +98,18 @@ namespace Pikzel {
       static std::unique_ptr<VertexBuffer> CreateVertexBuffer(const BufferLayout& layout, const uint32_t size, const void* data);
 
       static std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint32_t* indices);
+      static std::unique_ptr<IndexBuffer> CreateIndexBuffer(const uint32_t count, const uint16_t* indices);
 
       static std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size);
       static std::unique_ptr<UniformBuffer> CreateUniformBuffer(const uint32_t size, const void* data);
 
+      static std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size);
+      static std::unique_ptr<StorageBuffer> CreateStorageBuffer(const uint32_t size, const void* data);
+
+      // Indirect buffer holding count DrawIndexedIndirectCommands
+      static std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count);
+      static std::unique_ptr<IndirectBuffer> CreateIndirectBuffer(const uint32_t count, const DrawIndexedIndirectCommand* commands);
+
       static std::unique_ptr<Framebuffer> CreateFramebuffer(const FramebufferSettings& settings = {});
 
       static std::unique_ptr<Texture> CreateTexture(const TextureSettings& settings = {});
@@ -0,0 +1,79 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace Pikzel {
+
+   uint64_t RenderQueue::MakeKey(const uint32_t pipeline, const uint32_t material, const uint32_t mesh, const float depth) {
+      PKZL_CORE_ASSERT(pipeline <= MaxPipeline, "Render queue pipeline {0} does not fit in the sort key (max {1})!", pipeline, MaxPipeline);
+      PKZL_CORE_ASSERT(material <= MaxMaterial, "Render queue material {0} does not fit in the sort key (max {1})!", material, MaxMaterial);
+      PKZL_CORE_ASSERT(mesh <= MaxMesh, "Render queue mesh {0} does not fit in the sort key (max {1})!", mesh, MaxMesh);
+
+      // The bit pattern of a non-negative IEEE float increases monotonically with its value, so the top 24 bits
+      // (below the sign bit, which is zero) order depths correctly without needing to know the depth range.
+      const uint32_t depthBits = std::bit_cast<uint32_t>(std::max(depth, 0.0f)) >> 7;
+      return
+         (static_cast<uint64_t>(pipeline & MaxPipeline) << 56) |
+         (static_cast<uint64_t>(material & MaxMaterial) << 40) |
+         (static_cast<uint64_t>(mesh & MaxMesh) << 24) |
+         static_cast<uint64_t>(depthBits & 0xFFFFFF);
+   }
+
+
+   void RenderQueue::Clear() {
+      m_Items.clear();
+   }
+
+
+   void RenderQueue::Reserve(const size_t size) {
+      m_Items.reserve(size);
+   }
+
+
+   void RenderQueue::Add(const uint64_t key, const uint32_t index) {
+      m_Items.emplace_back(key, index);
+   }
+
+
+   void RenderQueue::Sort() {
+      PKZL_PROFILE_FUNCTION();
+
+      const size_t count = m_Items.size();
+      if (count < 2) {
+         return;
+      }
+      m_Scratch.resize(count);
+
+      // one histogram per byte, all built in a single pass over the keys
+      std::array<std::array<size_t, 256>, 8> histograms = {};
+      for (const auto& item : m_Items) {
+         for (size_t pass = 0; pass < 8; ++pass) {
+            ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+         }
+      }
+
+      for (size_t pass = 0; pass < 8; ++pass) {
+         auto& histogram = histograms[pass];
+         const uint32_t shift = static_cast<uint32_t>(pass * 8);
+
+         // if every key has the same value for this byte, then this pass would not change the order
+         if (histogram[(m_Items.front().key >> shift) & 0xFF] == count) {
+            continue;
+         }
+
+         size_t offset = 0;
+         for (auto& bucket : histogram) {
+            const size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+         }
+         for (const auto& item : m_Items) {
+            m_Scratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+         }
+         std::swap(m_Items, m_Scratch);
+      }
+   }
+
+}
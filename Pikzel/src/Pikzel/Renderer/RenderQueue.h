@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pikzel {
+
+   // A list of draws, each identified by a 64-bit sort key.
+   // Sorting the keys groups together draws that share state, so that when walking the sorted list
+   // state only needs to be rebound when it actually changes.
+   //
+   // Key layout (most significant first):
+   //    [63..56] pipeline   (8 bits, 0 to MaxPipeline)
+   //    [55..40] material   (16 bits, 0 to MaxMaterial)  e.g. index of a set of textures
+   //    [39..24] mesh       (16 bits, 0 to MaxMesh)      e.g. index of vertex and index buffers
+   //    [23.. 0] depth      (24 bits)                    so that, within the same state, draws are ordered front-to-back
+   //
+   // Pipeline, material and mesh must fit in their fields.  Values that did not would alias other values, and clients that
+   // compare the fields to decide what to rebind would then draw with the wrong state.
+   //
+   // Example usage:
+   //    queue.Clear();
+   //    for (each draw i) {
+   //       queue.Add(RenderQueue::MakeKey(pipeline, material, mesh, viewDepth), i);
+   //    }
+   //    queue.Sort();
+   //    for (const auto& item : queue.GetItems()) {
+   //       if (RenderQueue::GetMaterial(item.key) != previousMaterial) { ... bind material ... }
+   //       ... draw item.index ...
+   //    }
+   class PKZL_API RenderQueue final {
+   public:
+      struct Item {
+         uint64_t key;
+         uint32_t index;  // client-defined, identifies what to draw
+      };
+
+      static constexpr uint32_t MaxPipeline = 0xFF;
+      static constexpr uint32_t MaxMaterial = 0xFFFF;
+      static constexpr uint32_t MaxMesh = 0xFFFF;
+
+      // depth should be non-negative (e.g. view space distance).  Negative depths are treated as zero.
+      // pipeline, material and mesh must be at most MaxPipeline, MaxMaterial and MaxMesh respectively
+      static uint64_t MakeKey(const uint32_t pipeline, const uint32_t material, const uint32_t mesh, const float depth);
+
+      static uint32_t GetPipeline(const uint64_t key) { return static_cast<uint32_t>(key >> 56); }
+      static uint32_t GetMaterial(const uint64_t key) { return static_cast<uint32_t>(key >> 40) & MaxMaterial; }
+      static uint32_t GetMesh(const uint64_t key) { return static_cast<uint32_t>(key >> 24) & MaxMesh; }
+
+      void Clear();
+      void Reserve(const size_t size);
+      void Add(const uint64_t key, const uint32_t index);
+
+      // Stable sort of the items by key (LSD radix sort, one byte per pass.  Passes where every key has the same byte are skipped)
+      void Sort();
+
+      const std::vector<Item>& GetItems() const { return m_Items; }
+      size_t Size() const { return m_Items.size(); }
+
+   private:
+      std::vector<Item> m_Items;
+      std::vector<Item> m_Scratch;
+   };
+
+}
@@ -1,4 +1,6 @@
 #include "Texture.h"
+#include "Pikzel/Core/CheckedFile.h"
+#include "Pikzel/Core/Hash.h"
 #include "Pikzel/Core/Utility.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -7,11 +9,44 @@
 #define DDSKTX_IMPLEMENT
 #include "dds-ktx.h"
 
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+
 namespace Pikzel {
 
+   // Cooked texture file is this header, followed immediately by dataSize bytes of texels
+   struct CookedTextureHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t format;     // TextureFormat
+      uint64_t key;        // hash of the source file content (and version)
+      uint32_t width;
+      uint32_t height;
+      uint64_t dataSize;
+   };
+
+   static constexpr char CookedTextureMagic[8] = {'P', 'K', 'Z', 'L', 'T', 'E', 'X', '\0'};
+   static constexpr uint32_t CookedTextureVersion = 1;
+
+
+   static uint64_t CookedTextureKey(const std::vector<uint8_t>& source) {
+      return HashValue(CookedTextureVersion, HashBytes(std::as_bytes(std::span {source})));
+   }
+
+
+   static bool IsCookedTextureHeaderValid(const CookedTextureHeader& header, const uint64_t key) {
+      return (std::memcmp(header.magic, CookedTextureMagic, sizeof(CookedTextureMagic)) == 0) && (header.version == CookedTextureVersion) && (header.key == key);
+   }
+
+
    TextureLoader::TextureLoader(const std::filesystem::path& path) {
       m_FileData = ReadFile<uint8_t>(path);
+      if (TryCooked(path)) {
+         return;
+      }
       if (!TrySTBI()) {
          if (!TryDDSKTX()) {
             PKZL_CORE_ASSERT(false, "'{0}': Image format not supported!", path.string());
@@ -32,7 +67,7 @@ namespace Pikzel {
    }
    
    TextureLoader::~TextureLoader() {
-      if (m_Data) {
+      if (m_Data && !m_IsCooked) {
          if (m_IsDDSKTX) {
             delete static_cast<ddsktx_texture_info*>(m_Data);
          } else {
@@ -42,6 +77,52 @@ namespace Pikzel {
    }
 
 
+   std::filesystem::path TextureLoader::GetCookedPath(const std::filesystem::path& path) {
+      std::filesystem::path cookedPath = path;
+      cookedPath += ".pkzltex";
+      return cookedPath;
+   }
+
+
+   bool TextureLoader::Cook(const std::filesystem::path& path) {
+      PKZL_PROFILE_FUNCTION();
+      std::vector<uint8_t> source = ReadFile<uint8_t>(path);
+      const uint64_t key = CookedTextureKey(source);
+      const auto cookedPath = GetCookedPath(path);
+      {
+         std::ifstream file {cookedPath, std::ios::binary};
+         CookedTextureHeader header;
+         if (file.read(reinterpret_cast<char*>(&header), sizeof(CookedTextureHeader)) && IsCookedTextureHeaderValid(header, key)) {
+            return false;
+         }
+      }
+
+      TextureLoader loader {source.data(), static_cast<uint32_t>(source.size())};
+      if (!loader.IsLoaded()) {
+         throw std::runtime_error {std::format("Could not decode texture '{}'", path)};
+      }
+      if (loader.m_IsDDSKTX) {
+         return false;
+      }
+
+      const auto [data, size] = loader.GetData(0, 0, 0);
+      CookedTextureHeader header;
+      std::memcpy(header.magic, CookedTextureMagic, sizeof(CookedTextureMagic));
+      header.version = CookedTextureVersion;
+      header.format = static_cast<uint32_t>(loader.m_Format);
+      header.key = key;
+      header.width = loader.m_Width;
+      header.height = loader.m_Height;
+      header.dataSize = size;
+
+      WriteFileAtomic(cookedPath, [&header, data, size] (std::ostream& file) {
+         file.write(reinterpret_cast<const char*>(&header), sizeof(CookedTextureHeader));
+         file.write(static_cast<const char*>(data), size);
+      });
+      return true;
+   }
+
+
    bool TextureLoader::IsLoaded() const {
       return m_Data != nullptr;
    }
@@ -102,6 +183,40 @@ namespace Pikzel {
    }
 
 
+   // If there is an up to date cooked file for the texture at path (whose content is already in m_FileData), then replace
+   // m_FileData with the cooked file, and point m_Data at its texels
+   bool TextureLoader::TryCooked(const std::filesystem::path& path) {
+      std::vector<uint8_t> cooked;
+      try {
+         cooked = ReadFile<uint8_t>(GetCookedPath(path));
+      } catch (const std::runtime_error&) {
+         return false; // no cooked file
+      }
+      CookedTextureHeader header;
+      if (cooked.size() < sizeof(CookedTextureHeader)) {
+         return false;
+      }
+      std::memcpy(&header, cooked.data(), sizeof(CookedTextureHeader));
+      if (!IsCookedTextureHeaderValid(header, CookedTextureKey(m_FileData)) || (header.dataSize != cooked.size() - sizeof(CookedTextureHeader))) {
+         return false;
+      }
+
+      m_FileData = std::move(cooked);
+      m_Data = m_FileData.data() + sizeof(CookedTextureHeader);
+      m_Width = header.width;
+      m_Height = header.height;
+      m_Depth = 1;
+      m_Layers = 1;
+      m_MIPLevels = 1;
+      m_Format = static_cast<TextureFormat>(header.format);
+      m_IsCubeMap = false;
+      m_IsDDSKTX = false;
+      m_IsCompressed = false;
+      m_IsCooked = true;
+      return true;
+   }
+
+
    bool TextureLoader::TrySTBI() {
       int iWidth;
       int iHeight;
@@ -256,7 +256,15 @@ namespace Pikzel {
 
       virtual bool operator==(const Texture& that) = 0;
 
+      // Index of this texture in the global ("bindless") texture table, for shaders that fetch textures from the table by index
+      // rather than having them bound per draw.
+      // InvalidBindlessIndex if the texture is not in the table (e.g. bindless textures are not supported, see RenderCore::SupportsBindlessTextures(),
+      // or the texture is not a Texture2D)
+      virtual uint32_t GetBindlessIndex() const { return InvalidBindlessIndex; }
+
    public:
+      static constexpr uint32_t InvalidBindlessIndex = ~0u;
+
       static uint32_t CalculateMipmapLevels(const uint32_t width, const uint32_t height);
       static uint32_t BPP(const TextureFormat format);
    };
@@ -295,6 +303,9 @@ namespace Pikzel {
    // Manages load of texture resources from file
    // Constructor loads and parses the file into memory buffer and from there it can be uploaded to GPU
    // Destructor frees that memory
+   //
+   // Image files that need decoding (i.e. anything other than .dds/.ktx) can be "cooked": the decoded texels are written
+   // to a file alongside the source (see Cook()), and loading from the path then reads the decoded texels directly.
    class PKZL_API TextureLoader {
    public:
       PKZL_NO_COPYMOVE(TextureLoader);
@@ -302,6 +313,16 @@ namespace Pikzel {
       TextureLoader(void* pdata, uint32_t size);
       ~TextureLoader();
 
+      // The cooked file for the texture at path
+      static std::filesystem::path GetCookedPath(const std::filesystem::path& path);
+
+      // Bring the texture's cooked file up to date (decoding the texture and writing the file if necessary).
+      // Returns true if the cooked file was written, false if it was already up to date or the texture does not need cooking
+      // (it is already in a GPU ready format).
+      // throws std::runtime_error if the texture cannot be read or the cooked file cannot be written.
+      // Does not touch the GPU, so can be called from any thread (and without a RenderCore)
+      static bool Cook(const std::filesystem::path& path);
+
       bool IsLoaded() const;
 
       uint32_t GetWidth() const;
@@ -320,6 +341,7 @@ namespace Pikzel {
       std::pair<const void*, const uint32_t> GetData(const uint32_t layer, const uint32_t slice, const uint32_t mipLevel) const;
 
    private:
+      bool TryCooked(const std::filesystem::path& path);
       bool TrySTBI();
       bool TryDDSKTX();
       // for platform windows we could probably also try Windows Imaging Component (WIC) here.
@@ -339,6 +361,7 @@ namespace Pikzel {
       bool m_IsCubeMap;
       bool m_IsDDSKTX;
       bool m_IsCompressed;
+      bool m_IsCooked = false; // m_Data points into m_FileData
    };
 
 }
@@ -1,9 +1,23 @@
 #include "AssetCache.h"
 
+#include "Pikzel/Core/ThreadPool.h"
 #include "Pikzel/Scene/ModelAssetLoader.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+
 namespace Pikzel {
 
+   // Background loads get a pool of their own.  Decoding a model can take seconds, and on the engine-wide pool (ThreadPool::Get())
+   // that would queue up every frame's work (e.g. Culling::CullScene()) behind it.
+   static ThreadPool& GetLoaderPool() {
+      static ThreadPool pool {std::max(std::thread::hardware_concurrency() / 2, 1u)};
+      return pool;
+   }
+
+
    Id AssetCache::LoadModelAsset(const std::filesystem::path& path) {
       auto id = entt::hashed_string(path.string().data());
 
@@ -11,7 +25,82 @@ namespace Pikzel {
          PKZL_CORE_LOG_ERROR("Asset with path '{}' has already been loaded", path);
       } else {
          m_Paths.load(id, path);
-         m_Models.load(id, path);
+         m_Models.load(id, path, m_VertexFormat, m_MeshOptimization);
+      }
+      return id;
+   }
+
+
+   Id AssetCache::LoadModelAssetAsync(const std::filesystem::path& path) {
+      auto id = entt::hashed_string(path.string().data());
+
+      if (GetPath(id)) {
+         PKZL_CORE_LOG_ERROR("Asset with path '{}' has already been loaded", path);
+      } else {
+         m_Paths.load(id, path);
+         m_PendingModels.emplace(id, GetLoaderPool().Submit([path, format = m_VertexFormat, optimization = m_MeshOptimization] { return ModelAssetLoader::Decode(path, format, optimization); }));
+      }
+      return id;
+   }
+
+
+   bool AssetCache::IsModelAssetPending(Id id) {
+      return m_PendingModels.contains(id);
+   }
+
+
+   uint32_t AssetCache::GetPendingModelAssetCount() {
+      return static_cast<uint32_t>(m_PendingModels.size());
+   }
+
+
+   void AssetCache::Update(const bool wait/*= false*/) {
+      PKZL_PROFILE_FUNCTION();
+      for (auto pending = m_PendingModels.begin(); pending != m_PendingModels.end();) {
+         auto& [id, future] = *pending;
+         if (!wait && (future.wait_for(std::chrono::seconds {0}) != std::future_status::ready)) {
+            ++pending;
+            continue;
+         }
+         try {
+            m_Models.load(id, ModelAssetLoader::Upload(*future.get()));
+         } catch (const std::exception& err) {
+            PKZL_CORE_LOG_ERROR("Failed to load model asset '{}': {}", *GetPath(id), err.what());
+            m_Paths.erase(id);
+         }
+         pending = m_PendingModels.erase(pending);
+      }
+   }
+
+
+   void AssetCache::SetVertexFormat(const VertexFormat format) {
+      m_VertexFormat = format;
+   }
+
+
+   VertexFormat AssetCache::GetVertexFormat() {
+      return m_VertexFormat;
+   }
+
+
+   void AssetCache::SetMeshOptimization(const MeshOptimization optimization) {
+      m_MeshOptimization = optimization;
+   }
+
+
+   MeshOptimization AssetCache::GetMeshOptimization() {
+      return m_MeshOptimization;
+   }
+
+
+   Id AssetCache::AddModelAsset(const std::filesystem::path& path, std::shared_ptr<ModelAsset> modelAsset) {
+      auto id = entt::hashed_string(path.string().data());
+
+      if (GetPath(id)) {
+         PKZL_CORE_LOG_ERROR("Asset with path '{}' has already been loaded", path);
+      } else {
+         m_Paths.load(id, path);
+         m_Models.load(id, std::move(modelAsset));
       }
       return id;
    }
@@ -22,11 +111,19 @@ namespace Pikzel {
    }
 
 
+   void AssetCache::UnloadModelAsset(Id id) {
+      m_PendingModels.erase(id); // does not wait for the decode to finish, its result is just discarded
+      m_Models.erase(id);
+      m_Paths.erase(id);
+   }
+
+
    Pikzel::PathHandle AssetCache::GetPath(Id id) {
       return m_Paths[id];
    }
 
    void AssetCache::Clear() {
+      m_PendingModels.clear();
       m_Paths.clear();
       m_Models.clear();
    }
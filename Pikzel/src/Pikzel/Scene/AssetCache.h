@@ -8,7 +8,10 @@
 #include <entt/resource/resource.hpp>
 
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 namespace Pikzel {
 
@@ -26,16 +29,56 @@ namespace Pikzel {
    public:
       static Id LoadModelAsset(const std::filesystem::path& path);
 
+      // Load a model asset in the background.  The model is read and decoded on a pool of loader threads, and its geometry
+      // is then uploaded by a subsequent Update() on the render thread.
+      // Returns the asset's id immediately.  GetPath() is valid straight away, but GetModelAsset() returns an empty handle
+      // until the asset has been uploaded (so things that draw models just skip it until then).
+      static Id LoadModelAssetAsync(const std::filesystem::path& path);
+
+      // Is the specified model asset still being loaded in the background?
+      static bool IsModelAssetPending(Id modelId);
+
+      // Number of model assets still being loaded in the background
+      static uint32_t GetPendingModelAssetCount();
+
+      // Upload the geometry of any background loaded model assets that have finished decoding, and put them in the cache.
+      // Must be called on the render thread, between frames (Application::Run() does this once per frame).
+      // If wait is true, blocks until all pending model assets are done.
+      static void Update(const bool wait = false);
+
+      // Vertex format that LoadModelAsset() stores mesh geometry in.  Default is VertexFormat::Full.
+      // The smaller formats trade some precision for (roughly) half the vertex memory and bandwidth.
+      static void SetVertexFormat(const VertexFormat format);
+      static VertexFormat GetVertexFormat();
+
+      // How much LoadModelAsset() reorders mesh indices and vertices for the GPU.  Default is MeshOptimization::Full.
+      // Applies at load (or cook) time only, and does not change what is drawn.
+      static void SetMeshOptimization(const MeshOptimization optimization);
+      static MeshOptimization GetMeshOptimization();
+
+      // Add an already constructed model asset to the cache.  The asset is identified by the specified path
+      // (in the same way as if it had been loaded from that path)
+      static Id AddModelAsset(const std::filesystem::path& path, std::shared_ptr<ModelAsset> modelAsset);
+
       static PathHandle GetPath(Id id);
 
       static ModelAssetHandle GetModelAsset(Id modelId);
 
+      // Remove a model asset from the cache (or abandon it, if it is still being loaded in the background).
+      // The asset (and its meshes' ranges of the GeometryPool) are freed once
+      // nothing else holds a handle to it.  Call Compact() on the GeometryPools (between frames) to reclaim fragmented space
+      // if many assets are unloaded.
+      static void UnloadModelAsset(Id modelId);
+
       static void Clear();
 
    private:
       friend class AssetCacheSerializerYAML;
       inline static PathCache m_Paths;
       inline static ModelAssetCache m_Models;
+      inline static std::unordered_map<Id, std::future<std::unique_ptr<ModelAssetData>>> m_PendingModels; // only accessed from the render thread
+      inline static VertexFormat m_VertexFormat = VertexFormat::Full;
+      inline static MeshOptimization m_MeshOptimization = MeshOptimization::Full;
 
    };
 
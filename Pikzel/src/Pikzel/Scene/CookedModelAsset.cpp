@@ -0,0 +1,335 @@
+#include "CookedModelAsset.h"
+
+#include "Pikzel/Core/CheckedFile.h"
+#include "Pikzel/Core/Hash.h"
+#include "Pikzel/Core/MappedFile.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Pikzel::CookedModelAsset {
+
+   static constexpr char Magic[8] = {'P', 'K', 'Z', 'L', 'M', 'D', 'L', '\0'};
+   static constexpr uint32_t Version = 4;
+   static constexpr uint64_t BlobAlignment = 16;
+
+   struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t meshCount;
+      uint64_t key;
+      uint64_t dependencyOffset;  // from start of file
+      uint32_t dependencyCount;
+      uint32_t reserved;
+   };
+
+   struct MeshEntry {
+      uint32_t format;        // VertexFormat
+      uint32_t indexType;     // IndexType
+      uint32_t vertexCount;
+      uint32_t indexCount;
+      uint64_t vertexOffset;  // from start of file
+      uint64_t vertexSize;    // bytes
+      uint64_t indexOffset;   // from start of file
+      uint64_t indexSize;     // bytes
+      float aabbMin[3];
+      float aabbMax[3];
+      float dequantize[16];   // column major
+      uint32_t lodCount;
+      Mesh::LOD lods[Mesh::MaxLODCount];
+      uint32_t meshletCount;
+      uint64_t meshletOffset; // from start of file
+   };
+
+   // Each dependency is one of these, followed by its path (pathSize bytes, relative to the cooked file's directory, not null terminated),
+   // padded to BlobAlignment
+   struct DependencyEntry {
+      uint64_t size;          // bytes
+      int64_t lastWriteTime;  // std::filesystem::file_time_type ticks
+      uint64_t hash;          // of the content
+      uint32_t pathSize;
+      uint32_t reserved;
+   };
+
+   static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<MeshEntry> && std::is_trivially_copyable_v<DependencyEntry>);
+
+
+   static uint64_t AlignUp(const uint64_t offset) {
+      return (offset + BlobAlignment - 1) & ~(BlobAlignment - 1);
+   }
+
+
+   std::filesystem::path GetPath(const std::filesystem::path& sourcePath, const VertexFormat format) {
+      std::filesystem::path path = sourcePath;
+      switch (format) {
+         case VertexFormat::Packed:    path += ".packed.pkzlmodel"; break;
+         case VertexFormat::Quantized: path += ".quantized.pkzlmodel"; break;
+         default:                      path += ".pkzlmodel"; break;
+      }
+      return path;
+   }
+
+
+   uint64_t ComputeKey(const VertexFormat format, const MeshOptimization optimization, const uint32_t importFlags) {
+      const uint32_t settings[] = {static_cast<uint32_t>(format), static_cast<uint32_t>(optimization), importFlags, Version};
+      return HashBytes(std::as_bytes(std::span {settings}));
+   }
+
+
+   static int64_t LastWriteTime(const std::filesystem::path& path, std::error_code& error) {
+      return static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+   }
+
+
+   // throws std::runtime_error if the file cannot be read
+   static uint64_t HashFile(const std::filesystem::path& path) {
+      const MappedFile file {path};
+      return HashBytes(file.GetBytes());
+   }
+
+
+   // Are the dependencies recorded in the cooked file (bytes) unchanged?
+   // A dependency whose size and last write time match is taken to be unchanged.  Only if the last write time has moved is the
+   // file hashed, so a warm load does not have to read the sources at all.
+   static bool AreDependenciesUpToDate(const std::span<const std::byte> bytes, const Header& header, const std::filesystem::path& cookedPath) {
+      PKZL_PROFILE_FUNCTION();
+      const std::filesystem::path dir = cookedPath.parent_path();
+      uint64_t offset = header.dependencyOffset;
+      for (uint32_t i = 0; i < header.dependencyCount; ++i) {
+         DependencyEntry entry;
+         if ((offset > bytes.size()) || (sizeof(DependencyEntry) > bytes.size() - offset)) {
+            PKZL_CORE_LOG_WARN("Cooked model '{}' is malformed.  Ignoring it", cookedPath);
+            return false;
+         }
+         std::memcpy(&entry, bytes.data() + offset, sizeof(DependencyEntry));
+         offset += sizeof(DependencyEntry);
+         if (entry.pathSize > bytes.size() - offset) {
+            PKZL_CORE_LOG_WARN("Cooked model '{}' is malformed.  Ignoring it", cookedPath);
+            return false;
+         }
+         const std::filesystem::path path = dir / std::string {reinterpret_cast<const char*>(bytes.data() + offset), entry.pathSize};
+         offset = AlignUp(offset + entry.pathSize);
+
+         std::error_code error;
+         const uintmax_t size = std::filesystem::file_size(path, error);
+         if (error || (size != entry.size)) {
+            return false;
+         }
+         const int64_t lastWriteTime = LastWriteTime(path, error);
+         if (error) {
+            return false;
+         }
+         if (lastWriteTime != entry.lastWriteTime) {
+            try {
+               if (HashFile(path) != entry.hash) {
+                  return false;
+               }
+            } catch (const std::runtime_error&) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+
+   // Is bytes a cooked model with the specified key, and are the files that it was cooked from unchanged?
+   static bool IsUpToDate(const std::span<const std::byte> bytes, const std::filesystem::path& cookedPath, const uint64_t key, Header& header) {
+      if (bytes.size() < sizeof(Header)) {
+         PKZL_CORE_LOG_WARN("Cooked model '{}' is truncated.  Ignoring it", cookedPath);
+         return false;
+      }
+      std::memcpy(&header, bytes.data(), sizeof(Header));
+      if ((std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) || (header.version != Version) || (header.key != key)) {
+         return false; // cooked with different settings, or by a different version (or not a cooked model at all)
+      }
+      return AreDependenciesUpToDate(bytes, header, cookedPath);
+   }
+
+
+   bool IsUpToDate(const std::filesystem::path& cookedPath, const uint64_t key) {
+      std::error_code error;
+      if (!std::filesystem::exists(cookedPath, error)) {
+         return false;
+      }
+      try {
+         const MappedFile file {cookedPath};
+         Header header;
+         return IsUpToDate(file.GetBytes(), cookedPath, key, header);
+      } catch (const std::runtime_error&) {
+         return false;
+      }
+   }
+
+
+   std::unique_ptr<ModelAssetData> Read(const std::filesystem::path& cookedPath, const uint64_t key) {
+      PKZL_PROFILE_FUNCTION();
+      std::error_code error;
+      if (!std::filesystem::exists(cookedPath, error)) {
+         return nullptr;
+      }
+
+      auto model = std::make_unique<ModelAssetData>();
+      try {
+         model->File = std::make_unique<MappedFile>(cookedPath);
+      } catch (const std::runtime_error& err) {
+         PKZL_CORE_LOG_WARN("Could not read cooked model: {}", err.what());
+         return nullptr;
+      }
+
+      const auto bytes = model->File->GetBytes();
+      Header header;
+      if (!IsUpToDate(bytes, cookedPath, key, header)) {
+         return nullptr;
+      }
+      if (static_cast<uint64_t>(header.meshCount) * sizeof(MeshEntry) > bytes.size() - sizeof(Header)) {
+         PKZL_CORE_LOG_WARN("Cooked model '{}' is truncated.  Ignoring it", cookedPath);
+         return nullptr;
+      }
+
+      model->Meshes.reserve(header.meshCount);
+      for (uint32_t i = 0; i < header.meshCount; ++i) {
+         MeshEntry entry;
+         std::memcpy(&entry, bytes.data() + sizeof(Header) + i * sizeof(MeshEntry), sizeof(MeshEntry));
+         if ((entry.format >= VertexFormatCount) || (entry.indexType >= IndexTypeCount)) {
+            PKZL_CORE_LOG_WARN("Cooked model '{}' is malformed.  Ignoring it", cookedPath);
+            return nullptr;
+         }
+         const auto format = static_cast<VertexFormat>(entry.format);
+         const auto indexType = static_cast<IndexType>(entry.indexType);
+         if (
+            (entry.vertexSize != static_cast<uint64_t>(entry.vertexCount) * Mesh::GetVertexBufferLayout(format).GetStride()) ||
+            (entry.indexSize != static_cast<uint64_t>(entry.indexCount) * IndexTypeSize(indexType)) ||
+            (entry.vertexOffset > bytes.size()) || (entry.vertexSize > bytes.size() - entry.vertexOffset) ||
+            (entry.indexOffset > bytes.size()) || (entry.indexSize > bytes.size() - entry.indexOffset) ||
+            (entry.lodCount == 0) || (entry.lodCount > Mesh::MaxLODCount) ||
+            std::any_of(entry.lods, entry.lods + entry.lodCount, [&entry](const Mesh::LOD& lod) { return (lod.firstIndex > entry.indexCount) || (lod.indexCount > entry.indexCount - lod.firstIndex); }) ||
+            (entry.meshletOffset > bytes.size()) || (static_cast<uint64_t>(entry.meshletCount) * sizeof(Mesh::Meshlet) > bytes.size() - entry.meshletOffset)
+         ) {
+            PKZL_CORE_LOG_WARN("Cooked model '{}' is malformed.  Ignoring it", cookedPath);
+            return nullptr;
+         }
+
+         auto& mesh = model->Meshes.emplace_back();
+         mesh.format = format;
+         mesh.indexType = indexType;
+         mesh.vertexCount = entry.vertexCount;
+         mesh.indexCount = entry.indexCount;
+         mesh.vertices = bytes.subspan(entry.vertexOffset, entry.vertexSize);
+         mesh.indices = bytes.subspan(entry.indexOffset, entry.indexSize);
+         mesh.AABB = {glm::make_vec3(entry.aabbMin), glm::make_vec3(entry.aabbMax)};
+         mesh.dequantize = glm::make_mat4(entry.dequantize);
+         mesh.lods.assign(entry.lods, entry.lods + entry.lodCount);
+         mesh.meshlets.resize(entry.meshletCount);
+         std::memcpy(mesh.meshlets.data(), bytes.data() + entry.meshletOffset, entry.meshletCount * sizeof(Mesh::Meshlet));
+         if (std::any_of(mesh.meshlets.begin(), mesh.meshlets.end(), [&mesh](const Mesh::Meshlet& meshlet) { return (meshlet.firstIndex > mesh.lods[0].indexCount) || (3 * static_cast<uint64_t>(meshlet.triangleCount) > mesh.lods[0].indexCount - meshlet.firstIndex); })) {
+            PKZL_CORE_LOG_WARN("Cooked model '{}' is malformed.  Ignoring it", cookedPath);
+            return nullptr;
+         }
+      }
+      return model;
+   }
+
+
+   // path, relative to dir if possible
+   static std::string DependencyPath(const std::filesystem::path& path, const std::filesystem::path& dir) {
+      const std::filesystem::path absolutePath = std::filesystem::absolute(path).lexically_normal();
+      const std::filesystem::path relativePath = absolutePath.lexically_relative(std::filesystem::absolute(dir).lexically_normal());
+      return (relativePath.empty() ? absolutePath : relativePath).generic_string();
+   }
+
+
+   void Write(const std::filesystem::path& cookedPath, const ModelAssetData& model, const uint64_t key) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(!model.SourceFiles.empty(), "Cooked model must have at least one source file!");
+      Header header;
+      std::memcpy(header.magic, Magic, sizeof(Magic));
+      header.version = Version;
+      header.meshCount = static_cast<uint32_t>(model.Meshes.size());
+      header.key = key;
+      header.dependencyCount = static_cast<uint32_t>(model.SourceFiles.size());
+      header.reserved = 0;
+
+      std::vector<std::pair<DependencyEntry, std::string>> dependencies;
+      dependencies.reserve(model.SourceFiles.size());
+      for (const auto& sourceFile : model.SourceFiles) {
+         std::error_code sizeError;
+         std::error_code timeError;
+         auto& [entry, path] = dependencies.emplace_back();
+         entry.size = std::filesystem::file_size(sourceFile, sizeError);
+         entry.lastWriteTime = LastWriteTime(sourceFile, timeError);
+         if (sizeError || timeError) {
+            throw std::runtime_error {std::format("Could not get size or last write time of '{}'", sourceFile)};
+         }
+         entry.hash = HashFile(sourceFile);
+         path = DependencyPath(sourceFile, cookedPath.parent_path());
+         entry.pathSize = static_cast<uint32_t>(path.size());
+         entry.reserved = 0;
+      }
+
+      std::vector<MeshEntry> entries;
+      entries.reserve(model.Meshes.size());
+      uint64_t offset = AlignUp(sizeof(Header) + model.Meshes.size() * sizeof(MeshEntry));
+      for (const auto& mesh : model.Meshes) {
+         auto& entry = entries.emplace_back();
+         entry.format = static_cast<uint32_t>(mesh.format);
+         entry.indexType = static_cast<uint32_t>(mesh.indexType);
+         entry.vertexCount = mesh.vertexCount;
+         entry.indexCount = mesh.indexCount;
+         entry.vertexOffset = offset;
+         entry.vertexSize = mesh.vertices.size();
+         offset = AlignUp(offset + entry.vertexSize);
+         entry.indexOffset = offset;
+         entry.indexSize = mesh.indices.size();
+         offset = AlignUp(offset + entry.indexSize);
+         std::memcpy(entry.aabbMin, glm::value_ptr(mesh.AABB.first), sizeof(entry.aabbMin));
+         std::memcpy(entry.aabbMax, glm::value_ptr(mesh.AABB.second), sizeof(entry.aabbMax));
+         std::memcpy(entry.dequantize, glm::value_ptr(mesh.dequantize), sizeof(entry.dequantize));
+         PKZL_CORE_ASSERT(!mesh.lods.empty() && (mesh.lods.size() <= Mesh::MaxLODCount), "Mesh has invalid number of LODs!");
+         entry.lodCount = static_cast<uint32_t>(mesh.lods.size());
+         std::copy(mesh.lods.begin(), mesh.lods.end(), entry.lods);
+         std::fill(entry.lods + entry.lodCount, entry.lods + Mesh::MaxLODCount, Mesh::LOD {});
+         entry.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+         entry.meshletOffset = offset;
+         offset = AlignUp(offset + mesh.meshlets.size() * sizeof(Mesh::Meshlet));
+      }
+      header.dependencyOffset = offset;
+
+      WriteFileAtomic(cookedPath, [&] (std::ostream& file) {
+         uint64_t position = 0;
+         const auto write = [&file, &position] (const void* data, const uint64_t size) {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            position += size;
+         };
+         const auto pad = [&write, &position] (const uint64_t to) {
+            static constexpr char zeros[BlobAlignment] = {};
+            write(zeros, to - position);
+         };
+
+         write(&header, sizeof(Header));
+         write(entries.data(), entries.size() * sizeof(MeshEntry));
+         for (size_t i = 0; i < entries.size(); ++i) {
+            pad(entries[i].vertexOffset);
+            write(model.Meshes[i].vertices.data(), entries[i].vertexSize);
+            pad(entries[i].indexOffset);
+            write(model.Meshes[i].indices.data(), entries[i].indexSize);
+            pad(entries[i].meshletOffset);
+            write(model.Meshes[i].meshlets.data(), entries[i].meshletCount * sizeof(Mesh::Meshlet));
+         }
+         pad(header.dependencyOffset);
+         for (const auto& [entry, path] : dependencies) {
+            write(&entry, sizeof(DependencyEntry));
+            write(path.data(), path.size());
+            pad(AlignUp(position));
+         }
+      });
+   }
+
+}
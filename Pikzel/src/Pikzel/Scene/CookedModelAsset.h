@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Scene/ModelAssetLoader.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+// Cooked model files: the result of ModelAssetLoader::Decode() written out in binary, so that subsequent loads can map
+// the file and upload the geometry straight from it, without going through Assimp again.
+//
+// Layout (all in native byte order):
+//    Header
+//    MeshEntry[meshCount]
+//    vertex, index, and meshlet blobs, each 16 byte aligned, at the offsets given by the mesh entries
+//    dependencies (the files that the model was cooked from), each 16 byte aligned, starting at the offset given by the header
+//
+// A cooked file is only used if its key matches, and its dependencies are unchanged.
+// The key covers the Assimp import flags, the vertex format, the mesh optimization, and the cooked file version.
+// The dependencies are the source file and every other file that Assimp read while importing it (e.g. a .gltf's .bin, or an .obj's .mtl).
+// Each is recorded with its size, last write time, and a hash of its content.  Changing any of these causes the model to be cooked again
+// (though a file whose last write time has changed is hashed again, and only counts as changed if its content has)
+namespace Pikzel::CookedModelAsset {
+
+   // The cooked file for sourcePath in the specified vertex format (alongside the source file)
+   PKZL_API std::filesystem::path GetPath(const std::filesystem::path& sourcePath, const VertexFormat format);
+
+   PKZL_API uint64_t ComputeKey(const VertexFormat format, const MeshOptimization optimization, const uint32_t importFlags);
+
+   // Does the cooked file exist, have the specified key, and are its dependencies unchanged?
+   PKZL_API bool IsUpToDate(const std::filesystem::path& cookedPath, const uint64_t key);
+
+   // Returns nullptr if the file does not exist, was cooked with a different key or from files that have since changed, or is malformed.
+   // The returned data maps the file (so the file is not read until the geometry is uploaded)
+   PKZL_API std::unique_ptr<ModelAssetData> Read(const std::filesystem::path& cookedPath, const uint64_t key);
+
+   // model.SourceFiles are recorded as the cooked file's dependencies.
+   // throws std::runtime_error if the file cannot be written (or a source file cannot be read).
+   // The file is written to a temporary and then renamed, so a reader never sees a partially written file.
+   PKZL_API void Write(const std::filesystem::path& cookedPath, const ModelAssetData& model, const uint64_t key);
+
+}
@@ -0,0 +1,209 @@
+#include "Culling.h"
+
+#include "Pikzel/Components/Model.h"
+#include "Pikzel/Scene/AssetCache.h"
+
+#if defined(__AVX__)
+   #include <immintrin.h>
+   #define PKZL_CULLING_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+   #include <emmintrin.h>
+   #define PKZL_CULLING_SSE
+#endif
+
+namespace Pikzel::Culling {
+
+   void AABBs::Clear() {
+      minX.clear();
+      minY.clear();
+      minZ.clear();
+      maxX.clear();
+      maxY.clear();
+      maxZ.clear();
+   }
+
+
+   void AABBs::Reserve(const size_t size) {
+      minX.reserve(size);
+      minY.reserve(size);
+      minZ.reserve(size);
+      maxX.reserve(size);
+      maxY.reserve(size);
+      maxZ.reserve(size);
+   }
+
+
+   void AABBs::Add(const std::pair<glm::vec3, glm::vec3>& aabb) {
+      minX.emplace_back(aabb.first.x);
+      minY.emplace_back(aabb.first.y);
+      minZ.emplace_back(aabb.first.z);
+      maxX.emplace_back(aabb.second.x);
+      maxY.emplace_back(aabb.second.y);
+      maxZ.emplace_back(aabb.second.z);
+   }
+
+
+   std::pair<glm::vec3, glm::vec3> TransformAABB(const glm::mat4& matrix, const std::pair<glm::vec3, glm::vec3>& aabb) {
+      // Transform centre, and then project the extents onto the transformed axes (Arvo)
+      const glm::vec3 centre = (aabb.first + aabb.second) * 0.5f;
+      const glm::vec3 extent = (aabb.second - aabb.first) * 0.5f;
+      const glm::vec3 transformedCentre = glm::vec3 {matrix * glm::vec4 {centre, 1.0f}};
+      const glm::vec3 transformedExtent = {
+         glm::abs(matrix[0][0]) * extent.x + glm::abs(matrix[1][0]) * extent.y + glm::abs(matrix[2][0]) * extent.z,
+         glm::abs(matrix[0][1]) * extent.x + glm::abs(matrix[1][1]) * extent.y + glm::abs(matrix[2][1]) * extent.z,
+         glm::abs(matrix[0][2]) * extent.x + glm::abs(matrix[1][2]) * extent.y + glm::abs(matrix[2][2]) * extent.z
+      };
+      return {transformedCentre - transformedExtent, transformedCentre + transformedExtent};
+   }
+
+
+   void TestAABBsScalar(const Frustum& frustum, const AABBs& aabbs, const size_t begin, const size_t end, uint8_t* visible) {
+      for (size_t i = begin; i < end; ++i) {
+         uint8_t isVisible = 1;
+         for (const auto& plane : frustum.Planes) {
+            const float x = plane.x >= 0.0f ? aabbs.maxX[i] : aabbs.minX[i];
+            const float y = plane.y >= 0.0f ? aabbs.maxY[i] : aabbs.minY[i];
+            const float z = plane.z >= 0.0f ? aabbs.maxZ[i] : aabbs.minZ[i];
+            // same order of operations as the SIMD version, so that results are identical
+            if (((plane.x * x + plane.w) + plane.y * y) + plane.z * z < 0.0f) {
+               isVisible = 0;
+               break;
+            }
+         }
+         visible[i - begin] = isVisible;
+      }
+   }
+
+
+   // The "positive vertex" of each box with respect to a plane depends only on the signs of the plane normal components,
+   // which are the same for all boxes.  So for each plane we can just pick which of the min or max arrays to read from,
+   // and then the test for several boxes at once is a straightforward multiply-add and compare.
+   void TestAABBs(const Frustum& frustum, const AABBs& aabbs, const size_t begin, const size_t end, uint8_t* visible) {
+      size_t i = begin;
+
+#if defined(PKZL_CULLING_AVX)
+      for (; i + 8 <= end; i += 8) {
+         __m256 outside = _mm256_setzero_ps();
+         for (const auto& plane : frustum.Planes) {
+            const __m256 x = _mm256_loadu_ps((plane.x >= 0.0f ? aabbs.maxX.data() : aabbs.minX.data()) + i);
+            const __m256 y = _mm256_loadu_ps((plane.y >= 0.0f ? aabbs.maxY.data() : aabbs.minY.data()) + i);
+            const __m256 z = _mm256_loadu_ps((plane.z >= 0.0f ? aabbs.maxZ.data() : aabbs.minZ.data()) + i);
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(plane.y)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(plane.z)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+         }
+         const int mask = _mm256_movemask_ps(outside);
+         for (int j = 0; j < 8; ++j) {
+            visible[i - begin + j] = ((mask >> j) & 1) ? 0 : 1;
+         }
+      }
+#elif defined(PKZL_CULLING_SSE)
+      for (; i + 4 <= end; i += 4) {
+         __m128 outside = _mm_setzero_ps();
+         for (const auto& plane : frustum.Planes) {
+            const __m128 x = _mm_loadu_ps((plane.x >= 0.0f ? aabbs.maxX.data() : aabbs.minX.data()) + i);
+            const __m128 y = _mm_loadu_ps((plane.y >= 0.0f ? aabbs.maxY.data() : aabbs.minY.data()) + i);
+            const __m128 z = _mm_loadu_ps((plane.z >= 0.0f ? aabbs.maxZ.data() : aabbs.minZ.data()) + i);
+            __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+         }
+         const int mask = _mm_movemask_ps(outside);
+         for (int j = 0; j < 4; ++j) {
+            visible[i - begin + j] = ((mask >> j) & 1) ? 0 : 1;
+         }
+      }
+#endif
+
+      // remainder (or everything, if no SIMD available)
+      if (i < end) {
+         TestAABBsScalar(frustum, aabbs, i, end, visible + (i - begin));
+      }
+   }
+
+
+   const char* GetSIMDName() {
+#if defined(PKZL_CULLING_AVX)
+      return "AVX";
+#elif defined(PKZL_CULLING_SSE)
+      return "SSE";
+#else
+      return "none";
+#endif
+   }
+
+
+   void CullScene(Scene& scene, const glm::mat4& vp, std::vector<VisibleList>& lists, ThreadPool& pool) {
+      PKZL_PROFILE_FUNCTION();
+
+      auto group = scene.GetGroup<const glm::mat4, const Model>();
+      const size_t count = group.size();
+
+      // Make sure there is a list for every chunk before dispatching work so that the worker threads never
+      // resize the vector (they only ever touch their own element)
+      const size_t maxChunks = static_cast<size_t>(pool.GetThreadCount()) + 1;
+      if (lists.size() < maxChunks) {
+         lists.resize(maxChunks);
+      }
+      for (auto& list : lists) {
+         list.Clear();
+      }
+
+      // world space frustum, for testing the world space bounds of whole objects
+      const Frustum frustum {vp};
+
+      pool.ParallelFor(count, MinObjectsPerChunk, [&group, &vp, &frustum, &lists](size_t chunk, size_t begin, size_t end) {
+         PKZL_PROFILE_SCOPE("Culling::CullScene chunk");
+         VisibleList& list = lists[chunk];
+         const auto entities = group.begin();
+
+         // 1) gather world space bounds of each object
+         list.candidates.clear();
+         list.bounds.Clear();
+         list.bounds.Reserve(end - begin);
+         for (size_t i = begin; i < end; ++i) {
+            const auto [transform, model] = group.get<const glm::mat4, const Model>(entities[i]);
+            auto modelAsset = AssetCache::GetModelAsset(model.id);
+            if (!modelAsset || glm::any(glm::greaterThan(modelAsset->AABB.first, modelAsset->AABB.second))) {
+               continue;
+            }
+            list.candidates.emplace_back(i, &*modelAsset);
+            list.bounds.Add(TransformAABB(transform, modelAsset->AABB));
+         }
+
+         // 2) test them all against the frustum, several at a time
+         list.visibility.resize(list.candidates.size());
+         TestAABBs(frustum, list.bounds, 0, list.bounds.Size(), list.visibility.data());
+
+         // 3) for the objects that are visible, test the individual meshes
+         for (size_t i = 0; i < list.candidates.size(); ++i) {
+            if (!list.visibility[i]) {
+               continue;
+            }
+            const auto& [index, modelAsset] = list.candidates[i];
+            const glm::mat4 mvp = vp * group.get<const glm::mat4>(entities[index]);
+            const uint32_t firstMesh = static_cast<uint32_t>(list.meshes.size());
+            if (modelAsset->Meshes.size() == 1) {
+               // the object bounds are the mesh bounds, and have already been tested
+               list.meshes.emplace_back(&modelAsset->Meshes.front());
+            } else {
+               // Frustum planes extracted from mvp are in object space, so the object space mesh bounds can be tested directly
+               // without having to transform them.
+               const Frustum objectFrustum {mvp};
+               for (const auto& mesh : modelAsset->Meshes) {
+                  if (objectFrustum.Intersects(mesh.AABB)) {
+                     list.meshes.emplace_back(&mesh);
+                  }
+               }
+            }
+            const uint32_t meshCount = static_cast<uint32_t>(list.meshes.size()) - firstMesh;
+            if (meshCount > 0) {
+               list.objects.emplace_back(mvp, firstMesh, meshCount);
+            }
+         }
+      });
+   }
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Pikzel/Core/ThreadPool.h"
+#include "Pikzel/Scene/Frustum.h"
+#include "Pikzel/Scene/Mesh.h"
+#include "Pikzel/Scene/ModelAsset.h"
+#include "Pikzel/Scene/Scene.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Pikzel::Culling {
+
+   // Axis aligned boxes stored as structure-of-arrays, so that they can be tested against a frustum several at a time
+   struct PKZL_API AABBs {
+      std::vector<float> minX;
+      std::vector<float> minY;
+      std::vector<float> minZ;
+      std::vector<float> maxX;
+      std::vector<float> maxY;
+      std::vector<float> maxZ;
+
+      size_t Size() const { return minX.size(); }
+
+      void Clear();
+      void Reserve(const size_t size);
+      void Add(const std::pair<glm::vec3, glm::vec3>& aabb);
+   };
+
+
+   // Returns the axis aligned box (in transformed space) that encloses the given box after transformation by matrix
+   PKZL_API std::pair<glm::vec3, glm::vec3> TransformAABB(const glm::mat4& matrix, const std::pair<glm::vec3, glm::vec3>& aabb);
+
+
+   // Test boxes [begin, end) against the frustum, one box at a time.
+   // visible[i - begin] is set to 1 if box i intersects the frustum, 0 otherwise.
+   // Boxes must not be empty (i.e. min <= max).
+   PKZL_API void TestAABBsScalar(const Frustum& frustum, const AABBs& aabbs, const size_t begin, const size_t end, uint8_t* visible);
+
+   // As for TestAABBsScalar(), but tests 8 (AVX) or 4 (SSE) boxes at a time.
+   // Which instruction set is used is decided at compile time.  Falls back to the scalar version if neither is available.
+   PKZL_API void TestAABBs(const Frustum& frustum, const AABBs& aabbs, const size_t begin, const size_t end, uint8_t* visible);
+
+   // Name of the instruction set used by TestAABBs()
+   PKZL_API const char* GetSIMDName();
+
+
+   // Compact list of the objects (and their meshes) that survived culling.
+   // objects[i] owns the meshes in range [firstMesh, firstMesh + meshCount) of meshes
+   struct VisibleList {
+      struct VisibleObject {
+         glm::mat4 mvp;
+         uint32_t firstMesh = 0;
+         uint32_t meshCount = 0;
+      };
+
+      std::vector<VisibleObject> objects;
+      std::vector<const Mesh*> meshes;
+
+      void Clear() {
+         objects.clear();
+         meshes.clear();
+      }
+
+      // scratch space used during culling.  Kept here so that storage is reused from frame to frame
+      struct Candidate {
+         size_t index;
+         const ModelAsset* modelAsset;
+      };
+      std::vector<Candidate> candidates;
+      AABBs bounds;
+      std::vector<uint8_t> visibility;
+   };
+
+   // Number of objects below which it is not worth handing culling work to another thread
+   inline constexpr size_t MinObjectsPerChunk = 1024;
+
+   // Cull all objects in the scene that have both a transform and a Model component against the view frustum defined by vp.
+   // Objects are split into chunks, and the chunks are culled in parallel on the specified thread pool.
+   // Each chunk writes its visible objects to lists[chunk].  Previous contents of lists are discarded, and any lists not needed for
+   // a chunk are left empty (the lists are not shrunk so that their storage can be reused next frame).
+   // Concatenating the lists in order gives the visible objects in the same order as the scene group.
+   // The Mesh pointers are valid for as long as the corresponding ModelAsset remains in the AssetCache
+   PKZL_API void CullScene(Scene& scene, const glm::mat4& vp, std::vector<VisibleList>& lists, ThreadPool& pool = ThreadPool::Get());
+
+}
@@ -0,0 +1,45 @@
+#include "Frustum.h"
+
+namespace Pikzel {
+
+   Frustum::Frustum(const glm::mat4& matrix) {
+      // Gribb-Hartmann plane extraction.  Pikzel clip space has depth in range [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE),
+      // so the depth planes are z >= 0 and z <= w.  (with reverse-Z these are the far and near planes respectively)
+      const glm::vec4 row0 = {matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]};
+      const glm::vec4 row1 = {matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]};
+      const glm::vec4 row2 = {matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]};
+      const glm::vec4 row3 = {matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]};
+
+      Planes = {
+         row3 + row0,
+         row3 - row0,
+         row3 + row1,
+         row3 - row1,
+         row2,
+         row3 - row2
+      };
+   }
+
+
+   bool Frustum::Intersects(const std::pair<glm::vec3, glm::vec3>& aabb) const {
+      // an empty box (e.g. mesh with no vertices) is never visible
+      if (glm::any(glm::greaterThan(aabb.first, aabb.second))) {
+         return false;
+      }
+
+      // for each plane, test the box corner furthest along the plane normal (the "positive vertex").
+      // if that is behind the plane, then the whole box is outside.
+      for (const auto& plane : Planes) {
+         const glm::vec3 positive = {
+            plane.x >= 0.0f ? aabb.second.x : aabb.first.x,
+            plane.y >= 0.0f ? aabb.second.y : aabb.first.y,
+            plane.z >= 0.0f ? aabb.second.z : aabb.first.z
+         };
+         if (glm::dot(glm::vec3 {plane}, positive) + plane.w < 0.0f) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <array>
+#include <utility>
+
+namespace Pikzel {
+
+   // View frustum, described by six planes extracted from a (model)view-projection matrix.
+   // Planes are in whatever space the matrix transforms from.  e.g. if you extract from a model-view-projection matrix,
+   // then the planes are in model (object) space, and you can test object space bounds against them directly.
+   struct PKZL_API Frustum {
+
+      Frustum(const glm::mat4& matrix);
+
+      // returns false if the axis aligned box (min, max) is definitely outside of the frustum.
+      // returns true if the box is inside, or intersects, the frustum (or is possibly outside, but near a corner of the frustum).
+      bool Intersects(const std::pair<glm::vec3, glm::vec3>& aabb) const;
+
+      std::array<glm::vec4, 6> Planes; // left, right, bottom, top, near, far.  (xyz) = plane normal (pointing into frustum), w = distance
+   };
+
+}
@@ -0,0 +1,327 @@
+#include "GeometryPool.h"
+
+#include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace Pikzel {
+
+   void GeometryPool::FreeList::Reset(const uint32_t capacity, const uint32_t used) {
+      m_Ranges.clear();
+      if (used < capacity) {
+         m_Ranges.emplace(used, capacity - used);
+      }
+   }
+
+
+   std::optional<uint32_t> GeometryPool::FreeList::Allocate(const uint32_t count) {
+      if (count == 0) {
+         return 0;
+      }
+      // first fit
+      for (auto range = m_Ranges.begin(); range != m_Ranges.end(); ++range) {
+         if (range->second >= count) {
+            const auto [offset, size] = *range;
+            m_Ranges.erase(range);
+            if (size > count) {
+               m_Ranges.emplace(offset + count, size - count);
+            }
+            return offset;
+         }
+      }
+      return {};
+   }
+
+
+   void GeometryPool::FreeList::Free(const uint32_t offset, const uint32_t count) {
+      if (count == 0) {
+         return;
+      }
+      uint32_t start = offset;
+      uint32_t size = count;
+      auto next = m_Ranges.lower_bound(offset);
+      if (next != m_Ranges.begin()) {
+         auto prev = std::prev(next);
+         if (prev->first + prev->second == offset) {
+            start = prev->first;
+            size += prev->second;
+            m_Ranges.erase(prev);
+         }
+      }
+      if ((next != m_Ranges.end()) && (offset + count == next->first)) {
+         size += next->second;
+         m_Ranges.erase(next);
+      }
+      m_Ranges.emplace(start, size);
+   }
+
+
+   GeometryPool::GeometryPool(const BufferLayout& layout, const IndexType indexType, const uint32_t initialVertexCapacity, const uint32_t initialIndexCapacity)
+   : m_Layout {layout}
+   , m_Stride {layout.GetStride()}
+   , m_IndexType {indexType}
+   , m_IndexSize {IndexTypeSize(indexType)}
+   , m_InitialVertexCapacity {initialVertexCapacity}
+   , m_InitialIndexCapacity {initialIndexCapacity}
+   {
+      PKZL_CORE_ASSERT(m_Stride > 0, "GeometryPool layout is empty!");
+      PKZL_CORE_ASSERT((initialVertexCapacity > 0) && (initialIndexCapacity > 0), "GeometryPool initial capacity must be non-zero!");
+   }
+
+
+   // Note: no attempt to clean up any GPU buffers here.  By the time this runs (during static destruction) the RenderCore
+   // has gone.  Call Release() before then.
+   GeometryPool::~GeometryPool() = default;
+
+
+   // pools are indexed by IndexType
+   GeometryPool& GeometryPool::Get(const VertexFormat format/*= VertexFormat::Full*/, const IndexType indexType/*= IndexType::UInt32*/) {
+      switch (format) {
+         case VertexFormat::Packed: {
+            static GeometryPool pools[IndexTypeCount] = {
+               {Mesh::PackedVertexBufferLayout, IndexType::UInt16, 1 << 16, 3 << 16},
+               {Mesh::PackedVertexBufferLayout, IndexType::UInt32, 1 << 16, 3 << 16}
+            };
+            return pools[static_cast<uint32_t>(indexType)];
+         }
+         case VertexFormat::Quantized: {
+            static GeometryPool pools[IndexTypeCount] = {
+               {Mesh::QuantizedVertexBufferLayout, IndexType::UInt16, 1 << 16, 3 << 16},
+               {Mesh::QuantizedVertexBufferLayout, IndexType::UInt32, 1 << 16, 3 << 16}
+            };
+            return pools[static_cast<uint32_t>(indexType)];
+         }
+         default: {
+            static GeometryPool pools[IndexTypeCount] = {
+               {Mesh::VertexBufferLayout, IndexType::UInt16, 1 << 16, 3 << 16},
+               {Mesh::VertexBufferLayout, IndexType::UInt32, 1 << 16, 3 << 16}
+            };
+            return pools[static_cast<uint32_t>(indexType)];
+         }
+      }
+   }
+
+
+   void GeometryPool::ReleaseAll() {
+      for (uint32_t format = 0; format < VertexFormatCount; ++format) {
+         for (uint32_t indexType = 0; indexType < IndexTypeCount; ++indexType) {
+            Get(static_cast<VertexFormat>(format), static_cast<IndexType>(indexType)).Release();
+         }
+      }
+   }
+
+
+   std::shared_ptr<GeometryAllocation> GeometryPool::Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const uint32_t* indices) {
+      return Allocate(vertexCount, vertices, indexCount, IndexType::UInt32, indices);
+   }
+
+
+   std::shared_ptr<GeometryAllocation> GeometryPool::Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const uint16_t* indices) {
+      return Allocate(vertexCount, vertices, indexCount, IndexType::UInt16, indices);
+   }
+
+
+   std::shared_ptr<GeometryAllocation> GeometryPool::Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const IndexType indexType, const void* indices) {
+      PKZL_PROFILE_FUNCTION();
+      PKZL_CORE_ASSERT(indexType == m_IndexType, "GeometryPool::Allocate() index type does not match the pool's index type!");
+      std::scoped_lock lock {m_Mutex};
+
+      auto vertexOffset = m_FreeVertices.Allocate(vertexCount);
+      auto firstIndex = m_FreeIndices.Allocate(indexCount);
+      bool recreateBuffers = !m_VertexBuffer;
+      if (!vertexOffset || !firstIndex) {
+         // No free range big enough.  Give back whichever half did succeed, pack the live ranges down, grow if that
+         // still is not enough room, and then the new allocation goes at the end.
+         if (vertexOffset) {
+            m_FreeVertices.Free(*vertexOffset, vertexCount);
+         }
+         if (firstIndex) {
+            m_FreeIndices.Free(*firstIndex, indexCount);
+         }
+         CompactHostData();
+         Reserve(m_UsedVertexCount + vertexCount, m_UsedIndexCount + indexCount);
+         vertexOffset = m_FreeVertices.Allocate(vertexCount);
+         firstIndex = m_FreeIndices.Allocate(indexCount);
+         PKZL_CORE_ASSERT(vertexOffset && firstIndex, "GeometryPool failed to allocate after growing!");
+         recreateBuffers = true;
+      }
+
+      if (vertexCount > 0) {
+         std::memcpy(m_VertexData.data() + static_cast<size_t>(*vertexOffset) * m_Stride, vertices, static_cast<size_t>(vertexCount) * m_Stride);
+      }
+      if (indexCount > 0) {
+         std::memcpy(m_IndexData.data() + static_cast<size_t>(*firstIndex) * m_IndexSize, indices, static_cast<size_t>(indexCount) * m_IndexSize);
+      }
+
+      if (recreateBuffers) {
+         CreateBuffers();
+      } else {
+         if (vertexCount > 0) {
+            m_VertexBuffer->CopyFromHost(static_cast<uint64_t>(*vertexOffset) * m_Stride, static_cast<uint64_t>(vertexCount) * m_Stride, vertices);
+         }
+         if (indexCount > 0) {
+            m_IndexBuffer->CopyFromHost(static_cast<uint64_t>(*firstIndex) * m_IndexSize, static_cast<uint64_t>(indexCount) * m_IndexSize, indices);
+         }
+      }
+
+      std::shared_ptr<GeometryAllocation> allocation {new GeometryAllocation {*vertexOffset, vertexCount, *firstIndex, indexCount}, [this] (GeometryAllocation* allocation) {
+         Free(allocation);
+         delete allocation;
+      }};
+      m_Allocations.emplace(allocation.get());
+      m_UsedVertexCount += vertexCount;
+      m_UsedIndexCount += indexCount;
+      return allocation;
+   }
+
+
+   void GeometryPool::Free(GeometryAllocation* allocation) {
+      std::scoped_lock lock {m_Mutex};
+      m_FreeVertices.Free(allocation->vertexOffset, allocation->vertexCount);
+      m_FreeIndices.Free(allocation->firstIndex, allocation->indexCount);
+      m_UsedVertexCount -= allocation->vertexCount;
+      m_UsedIndexCount -= allocation->indexCount;
+      m_Allocations.erase(allocation);
+   }
+
+
+   void GeometryPool::Compact() {
+      PKZL_PROFILE_FUNCTION();
+      std::scoped_lock lock {m_Mutex};
+      if (!m_VertexBuffer) {
+         return;
+      }
+      CompactHostData();
+      if (m_UsedVertexCount > 0) {
+         m_VertexBuffer->CopyFromHost(0, static_cast<uint64_t>(m_UsedVertexCount) * m_Stride, m_VertexData.data());
+      }
+      if (m_UsedIndexCount > 0) {
+         m_IndexBuffer->CopyFromHost(0, static_cast<uint64_t>(m_UsedIndexCount) * m_IndexSize, m_IndexData.data());
+      }
+   }
+
+
+   void GeometryPool::Release() {
+      std::scoped_lock lock {m_Mutex};
+      PKZL_CORE_ASSERT(m_Allocations.empty(), "GeometryPool::Release() called while there are still live allocations!");
+      m_VertexBuffer.reset();
+      m_IndexBuffer.reset();
+      m_VertexData = {};
+      m_IndexData = {};
+      m_FreeVertices.Reset(0, 0);
+      m_FreeIndices.Reset(0, 0);
+   }
+
+
+   const VertexBuffer& GeometryPool::GetVertexBuffer() const {
+      std::scoped_lock lock {m_Mutex};
+      PKZL_CORE_ASSERT(m_VertexBuffer, "GeometryPool::GetVertexBuffer() called before anything was allocated!");
+      return *m_VertexBuffer;
+   }
+
+
+   const IndexBuffer& GeometryPool::GetIndexBuffer() const {
+      std::scoped_lock lock {m_Mutex};
+      PKZL_CORE_ASSERT(m_IndexBuffer, "GeometryPool::GetIndexBuffer() called before anything was allocated!");
+      return *m_IndexBuffer;
+   }
+
+
+   IndexType GeometryPool::GetIndexType() const {
+      return m_IndexType;
+   }
+
+
+   uint32_t GeometryPool::GetAllocationCount() const {
+      std::scoped_lock lock {m_Mutex};
+      return static_cast<uint32_t>(m_Allocations.size());
+   }
+
+
+   uint32_t GeometryPool::GetUsedVertexCount() const {
+      std::scoped_lock lock {m_Mutex};
+      return m_UsedVertexCount;
+   }
+
+
+   uint32_t GeometryPool::GetUsedIndexCount() const {
+      std::scoped_lock lock {m_Mutex};
+      return m_UsedIndexCount;
+   }
+
+
+   uint32_t GeometryPool::GetVertexCapacity() const {
+      std::scoped_lock lock {m_Mutex};
+      return static_cast<uint32_t>(m_VertexData.size() / m_Stride);
+   }
+
+
+   uint32_t GeometryPool::GetIndexCapacity() const {
+      std::scoped_lock lock {m_Mutex};
+      return static_cast<uint32_t>(m_IndexData.size() / m_IndexSize);
+   }
+
+
+   // Move live ranges down to the start of the host copies (in offset order, so that each move is to a lower address),
+   // and update the allocations to match.  Caller must hold the lock, and is responsible for updating the GPU buffers.
+   void GeometryPool::CompactHostData() {
+      std::vector<GeometryAllocation*> allocations {m_Allocations.begin(), m_Allocations.end()};
+
+      std::sort(allocations.begin(), allocations.end(), [](const GeometryAllocation* a, const GeometryAllocation* b) { return a->vertexOffset < b->vertexOffset; });
+      uint32_t vertexOffset = 0;
+      for (auto allocation : allocations) {
+         if ((allocation->vertexCount > 0) && (allocation->vertexOffset != vertexOffset)) {
+            std::memmove(m_VertexData.data() + static_cast<size_t>(vertexOffset) * m_Stride, m_VertexData.data() + static_cast<size_t>(allocation->vertexOffset) * m_Stride, static_cast<size_t>(allocation->vertexCount) * m_Stride);
+         }
+         allocation->vertexOffset = vertexOffset;
+         vertexOffset += allocation->vertexCount;
+      }
+
+      std::sort(allocations.begin(), allocations.end(), [](const GeometryAllocation* a, const GeometryAllocation* b) { return a->firstIndex < b->firstIndex; });
+      uint32_t firstIndex = 0;
+      for (auto allocation : allocations) {
+         if ((allocation->indexCount > 0) && (allocation->firstIndex != firstIndex)) {
+            std::memmove(m_IndexData.data() + static_cast<size_t>(firstIndex) * m_IndexSize, m_IndexData.data() + static_cast<size_t>(allocation->firstIndex) * m_IndexSize, static_cast<size_t>(allocation->indexCount) * m_IndexSize);
+         }
+         allocation->firstIndex = firstIndex;
+         firstIndex += allocation->indexCount;
+      }
+
+      m_FreeVertices.Reset(static_cast<uint32_t>(m_VertexData.size() / m_Stride), vertexOffset);
+      m_FreeIndices.Reset(static_cast<uint32_t>(m_IndexData.size() / m_IndexSize), firstIndex);
+   }
+
+
+   // Grow the host copies (doubling) so that they can hold at least the specified number of vertices and indices.
+   // Must be called on compacted data (the free space is assumed to all be at the end)
+   void GeometryPool::Reserve(const uint32_t vertexCount, const uint32_t indexCount) {
+      uint32_t vertexCapacity = std::max(static_cast<uint32_t>(m_VertexData.size() / m_Stride), m_InitialVertexCapacity);
+      while (vertexCapacity < vertexCount) {
+         vertexCapacity *= 2;
+      }
+      uint32_t indexCapacity = std::max(static_cast<uint32_t>(m_IndexData.size() / m_IndexSize), m_InitialIndexCapacity);
+      while (indexCapacity < indexCount) {
+         indexCapacity *= 2;
+      }
+      m_VertexData.resize(static_cast<size_t>(vertexCapacity) * m_Stride);
+      m_IndexData.resize(static_cast<size_t>(indexCapacity) * m_IndexSize);
+      m_FreeVertices.Reset(vertexCapacity, m_UsedVertexCount);
+      m_FreeIndices.Reset(indexCapacity, m_UsedIndexCount);
+   }
+
+
+   void GeometryPool::CreateBuffers() {
+      PKZL_PROFILE_FUNCTION();
+      m_VertexBuffer = RenderCore::CreateVertexBuffer(m_Layout, static_cast<uint32_t>(m_VertexData.size()), m_VertexData.data());
+      const uint32_t indexCapacity = static_cast<uint32_t>(m_IndexData.size() / m_IndexSize);
+      if (m_IndexType == IndexType::UInt16) {
+         m_IndexBuffer = RenderCore::CreateIndexBuffer(indexCapacity, reinterpret_cast<const uint16_t*>(m_IndexData.data()));
+      } else {
+         m_IndexBuffer = RenderCore::CreateIndexBuffer(indexCapacity, reinterpret_cast<const uint32_t*>(m_IndexData.data()));
+      }
+   }
+
+}
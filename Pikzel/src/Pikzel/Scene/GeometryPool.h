@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Renderer/Buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace Pikzel {
+
+   // The vertex layouts that mesh geometry can be stored in.  Each has its own GeometryPools (one per IndexType).
+   // See Mesh::Vertex, Mesh::PackedVertex, and Mesh::QuantizedVertex
+   enum class VertexFormat {
+      Full,
+      Packed,
+      Quantized
+   };
+   inline constexpr uint32_t VertexFormatCount = 3;
+
+
+   // A range of a GeometryPool's vertex and index buffers.
+   // Indices in the range are relative to vertexOffset (i.e. draw with vertexOffset as the base vertex).
+   // The range is returned to the pool when the last reference to the allocation is released.
+   // The offsets change if the pool is compacted (they are updated in place), so read them each time you draw.
+   struct GeometryAllocation {
+      uint32_t vertexOffset = 0;
+      uint32_t vertexCount = 0;
+      uint32_t firstIndex = 0;
+      uint32_t indexCount = 0;
+   };
+
+
+   // One large vertex buffer and one large index buffer that many meshes are suballocated from.
+   // Meshes in the pool can all be drawn without rebinding buffers, which also means that their draws can be merged
+   // into a single multi-draw indirect call.
+   //
+   // The pool keeps a host copy of its contents, so that it can grow (by creating bigger buffers) and compact itself
+   // (by moving the live ranges down to the start of the buffers) without having to read back from the GPU.
+   // Both of these replace or rewrite the GPU buffers, so they must only happen when the GPU is not drawing from the pool
+   // (in practice: between frames on the render thread).
+   class PKZL_API GeometryPool final {
+   public:
+      GeometryPool(const BufferLayout& layout, const IndexType indexType, const uint32_t initialVertexCapacity, const uint32_t initialIndexCapacity);
+      PKZL_NO_COPYMOVE(GeometryPool);
+      ~GeometryPool();
+
+      // The engine-wide pool that Mesh geometry of the specified vertex format and index type is allocated from
+      static GeometryPool& Get(const VertexFormat format = VertexFormat::Full, const IndexType indexType = IndexType::UInt32);
+
+      // Release() all of the engine-wide pools
+      static void ReleaseAll();
+
+      // Copy vertexCount vertices (each of the pool's layout stride bytes) and indexCount indices into the pool.
+      // The indices must be of the pool's index type.
+      // If there is not a large enough free range, the pool is compacted and, if necessary, grown.
+      std::shared_ptr<GeometryAllocation> Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const uint32_t* indices);
+      std::shared_ptr<GeometryAllocation> Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const uint16_t* indices);
+
+      // Move all live ranges down to the start of the buffers, so that the free space is in one range at the end.
+      // Live allocations have their offsets updated.
+      void Compact();
+
+      // Destroy the GPU buffers and host copies.  There must be no live allocations.
+      // Call this before the RenderCore is shut down.
+      void Release();
+
+      // Buffers to draw the pool's allocations from.  Only valid once something has been allocated, and
+      // may be replaced by a subsequent Allocate() (so do not hold on to them across frames)
+      const VertexBuffer& GetVertexBuffer() const;
+      const IndexBuffer& GetIndexBuffer() const;
+
+      IndexType GetIndexType() const;
+
+      uint32_t GetAllocationCount() const;
+      uint32_t GetUsedVertexCount() const;
+      uint32_t GetUsedIndexCount() const;
+      uint32_t GetVertexCapacity() const;
+      uint32_t GetIndexCapacity() const;
+
+   private:
+
+      // Free ranges of a buffer, keyed by offset.  Adjacent free ranges are always merged.
+      class FreeList {
+      public:
+         void Reset(const uint32_t capacity, const uint32_t used);
+         std::optional<uint32_t> Allocate(const uint32_t count);
+         void Free(const uint32_t offset, const uint32_t count);
+
+      private:
+         std::map<uint32_t, uint32_t> m_Ranges; // offset -> count
+      };
+
+      std::shared_ptr<GeometryAllocation> Allocate(const uint32_t vertexCount, const void* vertices, const uint32_t indexCount, const IndexType indexType, const void* indices);
+      void Free(GeometryAllocation* allocation);
+
+      void CompactHostData();
+      void Reserve(const uint32_t vertexCount, const uint32_t indexCount);
+      void CreateBuffers();
+
+   private:
+      BufferLayout m_Layout;
+      uint32_t m_Stride;
+      IndexType m_IndexType;
+      uint32_t m_IndexSize;
+      uint32_t m_InitialVertexCapacity;
+      uint32_t m_InitialIndexCapacity;
+
+      std::vector<std::byte> m_VertexData;  // host copy of the vertex buffer contents.  Size is the vertex capacity (in bytes)
+      std::vector<std::byte> m_IndexData;   // host copy of the index buffer contents.  Size is the index capacity (in bytes)
+      FreeList m_FreeVertices;
+      FreeList m_FreeIndices;
+      uint32_t m_UsedVertexCount = 0;
+      uint32_t m_UsedIndexCount = 0;
+      std::unordered_set<GeometryAllocation*> m_Allocations;
+
+      std::unique_ptr<VertexBuffer> m_VertexBuffer;
+      std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+      mutable std::mutex m_Mutex;
+   };
+
+}
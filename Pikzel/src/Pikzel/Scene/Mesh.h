@@ -1,16 +1,24 @@
 #pragma once
 
 #include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Scene/GeometryPool.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+#include <cfloat>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace Pikzel {
 
    struct PKZL_API Mesh final {
       PKZL_NO_COPY(Mesh);
 
+      // VertexFormat::Full (44 bytes)
       struct Vertex {
          Vertex(glm::vec3 pos, glm::vec3 normal, glm::vec3 tangent, glm::vec2 uv) : Pos{ pos }, Normal{ normal }, Tangent{ tangent }, UV{ uv } {}
          glm::vec3 Pos;
@@ -19,6 +27,26 @@ namespace Pikzel {
          glm::vec2 UV;
       };
 
+      // VertexFormat::Packed (24 bytes)
+      // Normal and tangent are octahedral encoded into 2 x 16-bit snorm each, UV is 2 x half float.
+      // See VertexPacking.h
+      struct PackedVertex {
+         glm::vec3 Pos;
+         uint32_t Normal;
+         uint32_t Tangent;
+         uint32_t UV;
+      };
+
+      // VertexFormat::Quantized (20 bytes)
+      // As for PackedVertex, but position is also quantized to 16-bit unorm within the mesh bounds (w is unused).
+      // Mesh::dequantize transforms the quantized position back to object space.
+      struct QuantizedVertex {
+         glm::u16vec4 Pos;
+         uint32_t Normal;
+         uint32_t Tangent;
+         uint32_t UV;
+      };
+
       inline static BufferLayout VertexBufferLayout = {
          { "inPos",     Pikzel::DataType::Vec3 },
          { "inNormal",  Pikzel::DataType::Vec3 },
@@ -26,29 +54,107 @@ namespace Pikzel {
          { "inUV",      Pikzel::DataType::Vec2 },
       };
 
+      inline static BufferLayout PackedVertexBufferLayout = {
+         { "inPos",     Pikzel::DataType::Vec3 },
+         { "inNormal",  Pikzel::DataType::SNorm16Vec2 },
+         { "inTangent", Pikzel::DataType::SNorm16Vec2 },
+         { "inUV",      Pikzel::DataType::HVec2 },
+      };
+
+      inline static BufferLayout QuantizedVertexBufferLayout = {
+         { "inPos",     Pikzel::DataType::UNorm16Vec4 },
+         { "inNormal",  Pikzel::DataType::SNorm16Vec2 },
+         { "inTangent", Pikzel::DataType::SNorm16Vec2 },
+         { "inUV",      Pikzel::DataType::HVec2 },
+      };
+
+      // A level of detail: a range of the mesh's indices (relative to geometry->firstIndex) drawing a simplified version of the mesh.
+      // error is (an estimate of) how far, in object space, the simplified surface is from the full detail one.
+      struct LOD {
+         uint32_t firstIndex;
+         uint32_t indexCount;
+         float error;
+      };
+
+      static constexpr uint32_t MaxLODCount = 5; // including the full detail mesh
+
+      // A cluster of (at most MaxMeshletVertices distinct vertices and MaxMeshletTriangles) triangles of the full detail LOD, with bounds
+      // that allow the whole cluster to be culled at once.
+      // Laid out to match the cull shader (std430).
+      struct Meshlet {
+         glm::vec3 center;        // } object space bounding sphere of the meshlet's triangles
+         float radius;            // }
+         glm::vec3 coneAxis;      // } the triangles' normals all lie within the cone around coneAxis.  Every triangle is back facing if
+         float coneCutoff;        // } dot(center - eye, coneAxis) >= coneCutoff * length(center - eye) + radius.  (1 if the cone is too wide to ever cull)
+         uint32_t firstIndex;     // relative to geometry->firstIndex
+         uint32_t triangleCount;
+         uint32_t padding[2];
+      };
+
+      static constexpr uint32_t MaxMeshletVertices = 64;
+      static constexpr uint32_t MaxMeshletTriangles = 124;
+
+      static const BufferLayout& GetVertexBufferLayout(const VertexFormat format) {
+         switch (format) {
+            case VertexFormat::Packed:    return PackedVertexBufferLayout;
+            case VertexFormat::Quantized: return QuantizedVertexBufferLayout;
+            default:                      return VertexBufferLayout;
+         }
+      }
+
       Mesh() = default;
       ~Mesh() = default;
 
-      Mesh(std::unique_ptr<VertexBuffer> vb, std::unique_ptr<IndexBuffer> ib)
-      : vertexBuffer { std::move(vb) }
-      , indexBuffer { std::move(ib) }
-      {}
+      // If meshLODs is empty, the mesh has just the one (full detail) LOD, which is all of the allocation's indices
+      Mesh(std::shared_ptr<GeometryAllocation> allocation, std::pair<glm::vec3, glm::vec3> aabb, const VertexFormat vertexFormat = VertexFormat::Full, const IndexType geometryIndexType = IndexType::UInt32, const glm::mat4& dequantizeTransform = glm::identity<glm::mat4>(), std::vector<LOD> meshLODs = {}, std::vector<Meshlet> meshMeshlets = {})
+      : geometry { std::move(allocation) }
+      , AABB { aabb }
+      , format { vertexFormat }
+      , indexType { geometryIndexType }
+      , dequantize { dequantizeTransform }
+      , lods { std::move(meshLODs) }
+      , meshlets { std::move(meshMeshlets) }
+      {
+         if (lods.empty()) {
+            lods.emplace_back(0, geometry->indexCount, 0.0f);
+         }
+      }
 
       Mesh(Mesh&& mesh) noexcept
-      : vertexBuffer { std::move(mesh.vertexBuffer) }
-      , indexBuffer { std::move(mesh.indexBuffer) }
+      : geometry { std::move(mesh.geometry) }
+      , AABB { mesh.AABB }
+      , format { mesh.format }
+      , indexType { mesh.indexType }
+      , dequantize { mesh.dequantize }
+      , lods { std::move(mesh.lods) }
+      , meshlets { std::move(mesh.meshlets) }
       {}
 
       Mesh& operator=(Mesh&& mesh) noexcept {
          if (this != &mesh) {
-            vertexBuffer = std::move(mesh.vertexBuffer);
-            indexBuffer = std::move(mesh.indexBuffer);
+            geometry = std::move(mesh.geometry);
+            AABB = mesh.AABB;
+            format = mesh.format;
+            indexType = mesh.indexType;
+            dequantize = mesh.dequantize;
+            lods = std::move(mesh.lods);
+            meshlets = std::move(mesh.meshlets);
          }
          return *this;
       }
 
-      std::unique_ptr<VertexBuffer> vertexBuffer;
-      std::unique_ptr<IndexBuffer> indexBuffer;
+      // The pool that this mesh's geometry is allocated from
+      GeometryPool& GetGeometryPool() const {
+         return GeometryPool::Get(format, indexType);
+      }
+
+      std::shared_ptr<GeometryAllocation> geometry; // this mesh's range of GetGeometryPool()'s vertex and index buffers
+      std::pair<glm::vec3, glm::vec3> AABB = { glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX} }; // object space bounds (min, max) of the mesh vertices
+      VertexFormat format = VertexFormat::Full;
+      IndexType indexType = IndexType::UInt32; // UInt16 when the mesh has few enough vertices
+      glm::mat4 dequantize = glm::identity<glm::mat4>(); // vertex position space -> object space.  Identity unless format is VertexFormat::Quantized
+      std::vector<LOD> lods;                             // lods[0] is the full detail mesh, then progressively simpler (and larger error) ones
+      std::vector<Meshlet> meshlets;                     // lods[0]'s triangles, split into meshlets (in index order).  Empty if the mesh has not been split
    };
 
 }
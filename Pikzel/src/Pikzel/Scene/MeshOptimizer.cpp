@@ -0,0 +1,582 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
+namespace Pikzel::MeshOptimizer {
+
+   // Tuning values from Forsyth's paper.  The cache size used for scoring is deliberately bigger than a real cache,
+   // as the scores only need to rank vertices relative to each other.
+   static constexpr uint32_t ForsythCacheSize = 32;
+   static constexpr float ForsythCacheDecayPower = 1.5f;
+   static constexpr float ForsythLastTriangleScore = 0.75f;
+   static constexpr float ForsythValenceBoostScale = 2.0f;
+   static constexpr float ForsythValenceBoostPower = 0.5f;
+
+   static constexpr uint32_t NoTriangle = std::numeric_limits<uint32_t>::max();
+
+
+   // Symmetric 4x4 matrix of a quadric error metric.  Evaluate(p) is the sum of squared distances from p to the planes that
+   // have been added to the quadric
+   struct Quadric {
+      double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+      double b2 = 0.0, bc = 0.0, bd = 0.0;
+      double c2 = 0.0, cd = 0.0;
+      double d2 = 0.0;
+
+      // plane is dot(normal, p) + distance = 0, normal must be unit length
+      void AddPlane(const glm::vec3& normal, const float distance) {
+         const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+         a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+         b2 += b * b; bc += b * c; bd += b * d;
+         c2 += c * c; cd += c * d;
+         d2 += d * d;
+      }
+
+      Quadric& operator+=(const Quadric& q) {
+         a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+         b2 += q.b2; bc += q.bc; bd += q.bd;
+         c2 += q.c2; cd += q.cd;
+         d2 += q.d2;
+         return *this;
+      }
+
+      double Evaluate(const glm::vec3& p) const {
+         const double x = p.x, y = p.y, z = p.z;
+         const double error =
+            a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+            b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+            c2 * z * z + 2.0 * cd * z +
+            d2;
+         return std::max(error, 0.0); // (can come out slightly negative due to rounding)
+      }
+   };
+
+
+   static float ForsythVertexScore(const int cachePosition, const uint32_t remainingTriangles) {
+      if (remainingTriangles == 0) {
+         return -1.0f; // no triangles left to use this vertex, so no point keeping it in the cache
+      }
+      float score = 0.0f;
+      if (cachePosition >= 0) {
+         if (cachePosition < 3) {
+            // vertices of the triangle just emitted get a fixed score, so that the next triangle does not just use the
+            // same edge (which tends to produce long thin strips)
+            score = ForsythLastTriangleScore;
+         } else {
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (ForsythCacheSize - 3), ForsythCacheDecayPower);
+         }
+      }
+
+      // boost vertices with few triangles left, so that lone triangles are not left behind (to be picked up later with a cold cache)
+      score += ForsythValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ForsythValenceBoostPower);
+      return score;
+   }
+
+
+   VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize/*= 16*/) {
+      // A vertex is in the FIFO if fewer than cacheSize misses have happened since it was last (missed and) put in.
+      std::vector<uint32_t> cacheTime(vertexCount, 0);
+      uint32_t time = cacheSize + 1;
+      uint32_t misses = 0;
+      for (const auto index : indices) {
+         if (time - cacheTime[index] > cacheSize) {
+            cacheTime[index] = time++;
+            ++misses;
+         }
+      }
+
+      VertexCacheStatistics statistics;
+      statistics.transformedVertices = misses;
+      statistics.ACMR = indices.empty() ? 0.0f : static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+      statistics.ATVR = vertexCount == 0 ? 0.0f : static_cast<float>(misses) / static_cast<float>(vertexCount);
+      return statistics;
+   }
+
+
+   std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount) {
+      PKZL_PROFILE_FUNCTION();
+      const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+      // triangles that use each vertex, and have not been emitted yet.
+      // Vertex v's triangles are adjacency[adjacencyOffset[v]] to adjacency[adjacencyOffset[v] + remaining[v] - 1]
+      std::vector<uint32_t> remaining(vertexCount, 0);
+      for (const auto index : indices) {
+         ++remaining[index];
+      }
+      std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+      std::inclusive_scan(remaining.begin(), remaining.end(), adjacencyOffset.begin() + 1);
+      std::vector<uint32_t> adjacency(indices.size());
+      {
+         std::vector<uint32_t> next(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+         for (uint32_t i = 0; i < indices.size(); ++i) {
+            adjacency[next[indices[i]]++] = i / 3;
+         }
+      }
+
+      std::vector<int> cachePosition(vertexCount, -1);
+      std::vector<float> vertexScore(vertexCount);
+      for (uint32_t v = 0; v < vertexCount; ++v) {
+         vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+      }
+      std::vector<float> triangleScore(triangleCount);
+      for (uint32_t t = 0; t < triangleCount; ++t) {
+         triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+      }
+      std::vector<bool> emitted(triangleCount, false);
+
+      std::vector<uint32_t> cache;
+      std::vector<uint32_t> newCache;
+      cache.reserve(ForsythCacheSize + 3);
+      newCache.reserve(ForsythCacheSize + 3);
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      uint32_t bestTriangle = NoTriangle;
+      uint32_t nextUnemitted = 0;
+      for (uint32_t i = 0; i < triangleCount; ++i) {
+         if (bestTriangle == NoTriangle) {
+            // nothing in the cache has any triangles left, so carry on from wherever the input got up to
+            while (emitted[nextUnemitted]) {
+               ++nextUnemitted;
+            }
+            bestTriangle = nextUnemitted;
+         }
+
+         const uint32_t triangle = bestTriangle;
+         emitted[triangle] = true;
+         newCache.clear();
+         for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = indices[3 * triangle + k];
+            result.emplace_back(v);
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+               newCache.emplace_back(v);
+            }
+            const auto begin = adjacency.begin() + adjacencyOffset[v];
+            const auto end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, triangle), end - 1);
+            --remaining[v];
+         }
+         const size_t triangleVertexCount = newCache.size(); // less than 3 if the triangle is degenerate
+         for (const auto v : cache) {
+            if (std::find(newCache.begin(), newCache.begin() + triangleVertexCount, v) == newCache.begin() + triangleVertexCount) {
+               newCache.emplace_back(v);
+            }
+         }
+
+         // rescore the vertices in the cache, and those that have just dropped out of it, and then the triangles that use them
+         for (uint32_t j = 0; j < newCache.size(); ++j) {
+            const uint32_t v = newCache[j];
+            cachePosition[v] = (j < ForsythCacheSize) ? static_cast<int>(j) : -1;
+            vertexScore[v] = ForsythVertexScore(cachePosition[v], remaining[v]);
+         }
+         bestTriangle = NoTriangle;
+         float bestScore = -std::numeric_limits<float>::max();
+         for (const auto v : newCache) {
+            for (uint32_t j = adjacencyOffset[v]; j < adjacencyOffset[v] + remaining[v]; ++j) {
+               const uint32_t t = adjacency[j];
+               triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+               if ((cachePosition[v] >= 0) && (triangleScore[t] > bestScore)) {
+                  bestScore = triangleScore[t];
+                  bestTriangle = t;
+               }
+            }
+         }
+
+         newCache.resize(std::min<size_t>(newCache.size(), ForsythCacheSize));
+         std::swap(cache, newCache);
+      }
+      return result;
+   }
+
+
+   std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const float threshold/*= 1.05f*/) {
+      PKZL_PROFILE_FUNCTION();
+      constexpr uint32_t cacheSize = 16;
+      const size_t triangleCount = indices.size() / 3;
+      if (triangleCount == 0) {
+         return indices;
+      }
+
+      // FIFO cache simulation, as in AnalyzeVertexCache().  Advancing time by more than cacheSize empties the cache.
+      std::vector<uint32_t> cacheTime(vertices.size(), 0);
+      uint32_t time = cacheSize + 1;
+      const auto countMisses = [&indices, &cacheTime, &time] (const size_t triangle) {
+         uint32_t misses = 0;
+         for (size_t k = 0; k < 3; ++k) {
+            const uint32_t index = indices[3 * triangle + k];
+            if (time - cacheTime[index] > cacheSize) {
+               cacheTime[index] = time++;
+               ++misses;
+            }
+         }
+         return misses;
+      };
+
+      // hard boundaries: triangles that miss the cache on all three vertices.  The cache is cold there anyway, so
+      // splitting the mesh at these costs nothing
+      std::vector<uint32_t> misses(triangleCount);
+      std::vector<size_t> hardClusters;
+      for (size_t t = 0; t < triangleCount; ++t) {
+         misses[t] = countMisses(t);
+         if ((t == 0) || (misses[t] == 3)) {
+            hardClusters.emplace_back(t);
+         }
+      }
+      hardClusters.emplace_back(triangleCount);
+
+      // soft boundaries: split hard clusters further wherever the cluster so far (starting from a cold cache) has an
+      // ACMR no worse than threshold times that of the whole hard cluster
+      std::vector<size_t> clusters;
+      for (size_t i = 0; i + 1 < hardClusters.size(); ++i) {
+         const size_t begin = hardClusters[i];
+         const size_t end = hardClusters[i + 1];
+         const uint32_t hardMisses = std::accumulate(misses.begin() + begin, misses.begin() + end, 0u);
+         const float limit = threshold * static_cast<float>(hardMisses) / static_cast<float>(end - begin);
+
+         clusters.emplace_back(begin);
+         time += cacheSize + 1;
+         size_t softBegin = begin;
+         uint32_t softMisses = 0;
+         for (size_t t = begin; t < end; ++t) {
+            softMisses += countMisses(t);
+            if ((t + 1 < end) && (static_cast<float>(softMisses) <= limit * static_cast<float>(t + 1 - softBegin))) {
+               clusters.emplace_back(t + 1);
+               time += cacheSize + 1;
+               softBegin = t + 1;
+               softMisses = 0;
+            }
+         }
+      }
+      clusters.emplace_back(triangleCount);
+
+      // sort clusters so that those furthest out from the mesh centre, and facing away from it, come first
+      const size_t clusterCount = clusters.size() - 1;
+      std::vector<glm::vec3> clusterCentroid(clusterCount, glm::vec3 {0.0f});
+      std::vector<glm::vec3> clusterNormal(clusterCount, glm::vec3 {0.0f});
+      glm::vec3 meshCentroid {0.0f};
+      float meshArea = 0.0f;
+      for (size_t c = 0; c < clusterCount; ++c) {
+         float clusterArea = 0.0f;
+         for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[3 * t]].Pos;
+            const glm::vec3& p1 = vertices[indices[3 * t + 1]].Pos;
+            const glm::vec3& p2 = vertices[indices[3 * t + 2]].Pos;
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0); // length is twice the area
+            const float area = glm::length(normal);
+            clusterCentroid[c] += (p0 + p1 + p2) * (area / 3.0f);
+            clusterNormal[c] += normal;
+            clusterArea += area;
+         }
+         meshCentroid += clusterCentroid[c];
+         meshArea += clusterArea;
+         clusterCentroid[c] = clusterArea > 0.0f ? clusterCentroid[c] / clusterArea : vertices[indices[3 * clusters[c]]].Pos;
+      }
+      meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3 {0.0f};
+
+      std::vector<float> sortKey(clusterCount);
+      for (size_t c = 0; c < clusterCount; ++c) {
+         const float length = glm::length(clusterNormal[c]);
+         sortKey[c] = length > 0.0f ? glm::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c] / length) : 0.0f;
+      }
+      std::vector<size_t> order(clusterCount);
+      std::iota(order.begin(), order.end(), size_t {0});
+      std::stable_sort(order.begin(), order.end(), [&sortKey](const size_t a, const size_t b) { return sortKey[a] > sortKey[b]; });
+
+      std::vector<uint32_t> result;
+      result.reserve(indices.size());
+      for (const auto c : order) {
+         result.insert(result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+      }
+      return result;
+   }
+
+
+   std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const size_t targetIndexCount, const float targetError, float* resultError/*= nullptr*/) {
+      PKZL_PROFILE_FUNCTION();
+      const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+      std::vector<uint32_t> result = indices;
+
+      // vertices that share their position with another vertex are on an attribute (e.g. UV) seam.  Moving them would tear the seam open.
+      // position[v] is the first vertex with the same position as v.
+      std::vector<uint32_t> position(vertexCount);
+      std::vector<bool> locked(vertexCount, false);
+      {
+         std::vector<uint32_t> order(vertexCount);
+         std::iota(order.begin(), order.end(), 0u);
+         std::sort(order.begin(), order.end(), [&vertices](const uint32_t a, const uint32_t b) {
+            const glm::vec3& p = vertices[a].Pos;
+            const glm::vec3& q = vertices[b].Pos;
+            return std::tie(p.x, p.y, p.z) < std::tie(q.x, q.y, q.z);
+         });
+         for (uint32_t i = 0; i < vertexCount;) {
+            uint32_t j = i;
+            while ((j < vertexCount) && (vertices[order[j]].Pos == vertices[order[i]].Pos)) {
+               position[order[j++]] = order[i];
+            }
+            for (uint32_t k = i; (j - i > 1) && (k < j); ++k) {
+               locked[order[k]] = true;
+            }
+            i = j;
+         }
+      }
+
+      // edges used by only one triangle are on a border of the mesh, and those used by more than two are not manifold.
+      // Either way, vertices on them are not moved.
+      {
+         const auto edgeKey = [&position](const uint32_t a, const uint32_t b) {
+            const uint64_t pa = position[a];
+            const uint64_t pb = position[b];
+            return pa < pb ? (pa << 32) | pb : (pb << 32) | pa;
+         };
+         std::unordered_map<uint64_t, uint32_t> edgeUseCount;
+         edgeUseCount.reserve(result.size());
+         for (size_t i = 0; i < result.size(); ++i) {
+            ++edgeUseCount[edgeKey(result[i], result[i - i % 3 + (i + 1) % 3])];
+         }
+         std::vector<bool> lockedPosition(vertexCount, false);
+         for (size_t i = 0; i < result.size(); ++i) {
+            const uint32_t a = result[i];
+            const uint32_t b = result[i - i % 3 + (i + 1) % 3];
+            if (edgeUseCount[edgeKey(a, b)] != 2) {
+               lockedPosition[position[a]] = true;
+               lockedPosition[position[b]] = true;
+            }
+         }
+         for (uint32_t v = 0; v < vertexCount; ++v) {
+            locked[v] = locked[v] || lockedPosition[position[v]];
+         }
+      }
+
+      std::vector<Quadric> quadrics(vertexCount);
+      for (size_t t = 0; t < result.size() / 3; ++t) {
+         const glm::vec3& p0 = vertices[result[3 * t]].Pos;
+         const glm::vec3 normal = glm::cross(vertices[result[3 * t + 1]].Pos - p0, vertices[result[3 * t + 2]].Pos - p0);
+         const float length = glm::length(normal);
+         if (length > 0.0f) {
+            for (size_t k = 0; k < 3; ++k) {
+               quadrics[result[3 * t + k]].AddPlane(normal / length, -glm::dot(normal / length, p0));
+            }
+         }
+      }
+
+      // Each pass collapses the cheapest edges first, each vertex being involved in at most one collapse per pass
+      // (so that the costs and flip tests of the other collapses in the pass remain valid)
+      struct Collapse {
+         uint32_t from;
+         uint32_t to;
+         double cost;
+      };
+      std::vector<Collapse> collapses;
+      std::vector<uint32_t> adjacencyOffset;
+      std::vector<uint32_t> adjacency;
+      std::vector<uint32_t> remap(vertexCount);
+      std::vector<bool> touched;
+      const double maxCost = static_cast<double>(targetError) * targetError;
+      double error = 0.0;
+      while (result.size() > targetIndexCount) {
+         // triangles around each vertex
+         adjacencyOffset.assign(vertexCount + 1, 0);
+         for (const auto index : result) {
+            ++adjacencyOffset[index + 1];
+         }
+         std::partial_sum(adjacencyOffset.begin(), adjacencyOffset.end(), adjacencyOffset.begin());
+         adjacency.resize(result.size());
+         {
+            std::vector<uint32_t> next(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for (uint32_t i = 0; i < result.size(); ++i) {
+               adjacency[next[result[i]]++] = i / 3;
+            }
+         }
+
+         collapses.clear();
+         for (size_t i = 0; i < result.size(); ++i) {
+            const uint32_t a = result[i];
+            const uint32_t b = result[i - i % 3 + (i + 1) % 3];
+            if (a == b) {
+               continue;
+            }
+            const double cost = quadrics[a].Evaluate(vertices[b].Pos) + quadrics[b].Evaluate(vertices[b].Pos);
+            if (!locked[a]) {
+               collapses.emplace_back(a, b, cost);
+            }
+            if (!locked[b]) {
+               collapses.emplace_back(b, a, quadrics[a].Evaluate(vertices[a].Pos) + quadrics[b].Evaluate(vertices[a].Pos));
+            }
+         }
+         std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+         std::iota(remap.begin(), remap.end(), 0u);
+         touched.assign(vertexCount, false);
+         size_t triangleCount = result.size() / 3;
+         bool collapsed = false;
+         for (const auto& collapse : collapses) {
+            if ((collapse.cost > maxCost) || (3 * triangleCount <= targetIndexCount)) {
+               break;
+            }
+            if (touched[collapse.from] || touched[collapse.to]) {
+               continue;
+            }
+
+            // triangles that use both vertices disappear, the rest must not flip over (or become degenerate)
+            bool flips = false;
+            uint32_t removed = 0;
+            for (uint32_t j = adjacencyOffset[collapse.from]; !flips && (j < adjacencyOffset[collapse.from + 1]); ++j) {
+               const uint32_t* triangle = &result[3 * adjacency[j]];
+               if ((triangle[0] == collapse.to) || (triangle[1] == collapse.to) || (triangle[2] == collapse.to)) {
+                  ++removed;
+                  continue;
+               }
+               glm::vec3 p[3] = {vertices[triangle[0]].Pos, vertices[triangle[1]].Pos, vertices[triangle[2]].Pos};
+               const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+               for (uint32_t k = 0; k < 3; ++k) {
+                  if (triangle[k] == collapse.from) {
+                     p[k] = vertices[collapse.to].Pos;
+                  }
+               }
+               const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+               flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips) {
+               continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32_t j = adjacencyOffset[collapse.from]; j < adjacencyOffset[collapse.from + 1]; ++j) {
+               for (uint32_t k = 0; k < 3; ++k) {
+                  touched[result[3 * adjacency[j] + k]] = true;
+               }
+            }
+            error = std::max(error, collapse.cost);
+            triangleCount -= removed;
+            collapsed = true;
+         }
+         if (!collapsed) {
+            break;
+         }
+
+         size_t count = 0;
+         for (size_t t = 0; t < result.size() / 3; ++t) {
+            const uint32_t a = remap[result[3 * t]];
+            const uint32_t b = remap[result[3 * t + 1]];
+            const uint32_t c = remap[result[3 * t + 2]];
+            if ((a != b) && (b != c) && (c != a)) {
+               result[count++] = a;
+               result[count++] = b;
+               result[count++] = c;
+            }
+         }
+         result.resize(count);
+      }
+
+      if (resultError) {
+         *resultError = static_cast<float>(std::sqrt(error));
+      }
+      return result;
+   }
+
+
+   // Bounding sphere and normal cone of triangles [firstTriangle, firstTriangle + triangleCount)
+   static Mesh::Meshlet MakeMeshlet(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const uint32_t firstTriangle, const uint32_t triangleCount) {
+      Mesh::Meshlet meshlet = {};
+      meshlet.firstIndex = 3 * firstTriangle;
+      meshlet.triangleCount = triangleCount;
+
+      // sphere is centred on the centre of the triangles' bounding box.  Not minimal, but close enough.
+      glm::vec3 aabbMin {std::numeric_limits<float>::max()};
+      glm::vec3 aabbMax {-std::numeric_limits<float>::max()};
+      for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + 3 * triangleCount; ++i) {
+         aabbMin = glm::min(aabbMin, vertices[indices[i]].Pos);
+         aabbMax = glm::max(aabbMax, vertices[indices[i]].Pos);
+      }
+      meshlet.center = (aabbMin + aabbMax) * 0.5f;
+      for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + 3 * triangleCount; ++i) {
+         meshlet.radius = std::max(meshlet.radius, glm::length(vertices[indices[i]].Pos - meshlet.center));
+      }
+
+      // cone axis is the average of the triangle normals, and cone half angle is the largest angle between that and any of the normals
+      std::vector<glm::vec3> normals;
+      normals.reserve(triangleCount);
+      glm::vec3 axis {0.0f};
+      for (uint32_t t = firstTriangle; t < firstTriangle + triangleCount; ++t) {
+         const glm::vec3& p0 = vertices[indices[3 * t]].Pos;
+         const glm::vec3 normal = glm::cross(vertices[indices[3 * t + 1]].Pos - p0, vertices[indices[3 * t + 2]].Pos - p0);
+         const float length = glm::length(normal);
+         if (length > 0.0f) {
+            axis += normals.emplace_back(normal / length);
+         }
+      }
+      const float axisLength = glm::length(axis);
+      meshlet.coneCutoff = 1.0f;
+      if (axisLength > 0.0f) {
+         meshlet.coneAxis = axis / axisLength;
+         float minDot = 1.0f;
+         for (const auto& normal : normals) {
+            minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+         }
+         if (minDot > 0.0f) {
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot); // sine of the cone half angle
+         }
+      }
+      return meshlet;
+   }
+
+
+   std::vector<Mesh::Meshlet> BuildMeshlets(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const uint32_t maxVertices/*= Mesh::MaxMeshletVertices*/, const uint32_t maxTriangles/*= Mesh::MaxMeshletTriangles*/) {
+      PKZL_PROFILE_FUNCTION();
+      std::vector<Mesh::Meshlet> meshlets;
+      const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+      // meshlet[v] is the number of the last meshlet that used vertex v
+      constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+      std::vector<uint32_t> meshlet(vertices.size(), none);
+      uint32_t firstTriangle = 0;
+      uint32_t vertexCount = 0;
+      for (uint32_t t = 0; t < triangleCount; ++t) {
+         const auto newVertexCount = [&] {
+            const uint32_t* triangle = &indices[3 * t];
+            const uint32_t current = static_cast<uint32_t>(meshlets.size());
+            return
+               (meshlet[triangle[0]] != current ? 1u : 0u) +
+               ((meshlet[triangle[1]] != current) && (triangle[1] != triangle[0]) ? 1u : 0u) +
+               ((meshlet[triangle[2]] != current) && (triangle[2] != triangle[0]) && (triangle[2] != triangle[1]) ? 1u : 0u);
+         };
+         if ((t - firstTriangle == maxTriangles) || (vertexCount + newVertexCount() > maxVertices)) {
+            meshlets.emplace_back(MakeMeshlet(indices, vertices, firstTriangle, t - firstTriangle));
+            firstTriangle = t;
+            vertexCount = 0;
+         }
+         vertexCount += newVertexCount();
+         for (uint32_t k = 0; k < 3; ++k) {
+            meshlet[indices[3 * t + k]] = static_cast<uint32_t>(meshlets.size());
+         }
+      }
+      if (firstTriangle < triangleCount) {
+         meshlets.emplace_back(MakeMeshlet(indices, vertices, firstTriangle, triangleCount - firstTriangle));
+      }
+      return meshlets;
+   }
+
+
+   void OptimizeVertexFetch(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) {
+      PKZL_PROFILE_FUNCTION();
+      constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+      std::vector<uint32_t> remap(vertices.size(), unused);
+      std::vector<Mesh::Vertex> reordered;
+      reordered.reserve(vertices.size());
+      for (auto& index : indices) {
+         if (remap[index] == unused) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.emplace_back(vertices[index]);
+         }
+         index = remap[index];
+      }
+      vertices = std::move(reordered);
+   }
+
+}
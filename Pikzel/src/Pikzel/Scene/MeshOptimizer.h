@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Pikzel {
+
+   // How much effort ModelAssetLoader puts into reordering mesh indices and vertices for the GPU.
+   // None leaves them in the order the model file has them.
+   enum class MeshOptimization {
+      None,
+      VertexCache,   // reorder triangles for post-transform vertex cache hits, and vertices for fetch locality
+      Full           // as VertexCache, and also order clusters of triangles to reduce overdraw
+   };
+
+}
+
+
+// Reordering of triangle list meshes for better GPU vertex cache, overdraw, and vertex fetch behaviour.
+// None of these change what is drawn, only the order in which it is drawn.
+// All functions operate on triangle lists (three indices per triangle).
+namespace Pikzel::MeshOptimizer {
+
+   struct VertexCacheStatistics {
+      uint32_t transformedVertices = 0; // number of vertex shader invocations
+      float ACMR = 0.0f;                // average cache miss ratio: transformed vertices per triangle (0.5 is ideal, 3.0 is worst)
+      float ATVR = 0.0f;                // average transform to vertex ratio: transformed vertices per vertex (1.0 is ideal)
+   };
+
+   // Simulate a FIFO post-transform vertex cache of the specified size
+   PKZL_API VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount, const uint32_t cacheSize = 16);
+
+   // Reorder triangles to improve vertex cache hit rate (Tom Forsyth's "Linear-Speed Vertex Cache Optimisation")
+   PKZL_API std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, const uint32_t vertexCount);
+
+   // Reorder clusters of triangles so that those facing outward from the mesh centre are drawn first, and so are more
+   // likely to occlude the rest (Sander, Nehab, Barczak: "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+   // indices should already be optimized for the vertex cache.  Clusters are split where the cache would be cold
+   // anyway, or where doing so makes the ACMR no worse than threshold times that of the input.
+   PKZL_API std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const float threshold = 1.05f);
+
+   // Simplify a mesh by collapsing edges (Garland, Heckbert: "Surface Simplification Using Quadric Error Metrics"), returning
+   // new indices into the same vertices.  Stops when the index count is at most targetIndexCount, or when the next collapse would
+   // move the surface by more than targetError (in the same units as the vertex positions).
+   // Vertices on mesh borders and on attribute seams (i.e. that share their position with another vertex) are never moved, so the
+   // result may have more than targetIndexCount indices.
+   // If resultError is not null, it is set to (an estimate of) the largest distance that the surface has moved.
+   PKZL_API std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const size_t targetIndexCount, const float targetError, float* resultError = nullptr);
+
+   // Split a mesh into meshlets of consecutive triangles (so indices are not reordered, and the mesh should already be
+   // optimized for the vertex cache for the meshlets to be compact), each with bounds for culling.
+   // Meshlet firstIndex is relative to the start of indices.
+   PKZL_API std::vector<Mesh::Meshlet> BuildMeshlets(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices, const uint32_t maxVertices = Mesh::MaxMeshletVertices, const uint32_t maxTriangles = Mesh::MaxMeshletTriangles);
+
+   // Reorder vertices into the order in which indices first reference them, and update indices to match.
+   // Vertices that are not referenced are removed.
+   PKZL_API void OptimizeVertexFetch(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+}
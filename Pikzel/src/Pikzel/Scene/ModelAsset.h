@@ -12,6 +12,7 @@ namespace Pikzel {
       ModelAsset() noexcept = default;
 
       std::vector<Mesh> Meshes;
+      std::pair<glm::vec3, glm::vec3> AABB = { glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX} }; // union of the bounds of all meshes
    };
 
 }
@@ -1,14 +1,22 @@
 #include "ModelAssetLoader.h"
 
-#include "Pikzel/Renderer/RenderCore.h"
+#include "Pikzel/Scene/CookedModelAsset.h"
+#include "Pikzel/Scene/GeometryPool.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
+#include "Pikzel/Scene/VertexPacking.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+#include <cfloat>
+
 #include <filesystem>
 #include <format>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
@@ -28,6 +36,30 @@ namespace Pikzel {
    ;
 
 
+   // Records the files that Assimp opens while importing a model (the model file itself, and any that it refers to,
+   // e.g. a .gltf's buffers, or an .obj's material library), so that the cooked model can depend on all of them
+   class RecordingIOSystem final : public Assimp::DefaultIOSystem {
+   public:
+      RecordingIOSystem(std::vector<std::filesystem::path>& files)
+      : m_Files {files}
+      {}
+
+      Assimp::IOStream* Open(const char* file, const char* mode = "rb") override {
+         Assimp::IOStream* stream = DefaultIOSystem::Open(file, mode);
+         if (stream) {
+            const std::filesystem::path path = std::filesystem::path {file}.lexically_normal();
+            if (std::none_of(m_Files.begin(), m_Files.end(), [&path](const std::filesystem::path& recorded) { return recorded.lexically_normal() == path; })) {
+               m_Files.emplace_back(path);
+            }
+         }
+         return stream;
+      }
+
+   private:
+      std::vector<std::filesystem::path>& m_Files;
+   };
+
+
    glm::mat4 AssimpMat4ToGLMMat4(const aiMatrix4x4& matrix) {
       return {
          matrix.a1, matrix.b1, matrix.c1, matrix.d1,
@@ -72,12 +104,42 @@ namespace Pikzel {
    //}
 
 
-   Mesh ProcessMesh(aiMesh* pmesh, const aiMatrix4x4& transform, const aiScene* pscene, const std::filesystem::path& modelDir, size_t indentAmount) {
+   // LODs are simplified to roughly this fraction of the previous LOD's triangles.  A LOD chain stops at Mesh::MaxLODCount, or when
+   // simplification stops making much difference (the mesh is down to a few triangles, or the rest are locked on borders and seams),
+   // or when it would move the surface by more than LODMaxError of the mesh's size
+   static constexpr float LODReduction = 0.5f;
+   static constexpr float LODMinReduction = 0.8f;
+   static constexpr size_t LODMinTriangles = 64;
+   static constexpr float LODMaxError = 0.05f;
+
+
+   // Totals over all meshes of a model, for reporting the effect of mesh optimization
+   struct OptimizationStatistics {
+      uint64_t triangles = 0;
+      uint64_t verticesBefore = 0;
+      uint64_t verticesAfter = 0;
+      uint64_t transformedBefore = 0;
+      uint64_t transformedAfter = 0;
+   };
+
+
+   // Copy data into a new blob owned by model, and return a view of it
+   template<typename T>
+   std::span<const std::byte> AddBlob(ModelAssetData& model, const std::vector<T>& data) {
+      const auto bytes = std::as_bytes(std::span {data});
+      return model.Blobs.emplace_back(bytes.begin(), bytes.end());
+   }
+
+
+   ModelAssetData::MeshData ProcessMesh(ModelAssetData& model, aiMesh* pmesh, const aiMatrix4x4& transform, const aiScene* pscene, const std::filesystem::path& modelDir, const VertexFormat format, const MeshOptimization optimization, OptimizationStatistics& statistics, size_t indentAmount) {
 //      std::string indent(indentAmount, ' ');
 
       std::vector<Mesh::Vertex> vertices;
       std::vector<uint32_t> indices;
 
+      glm::vec3 aabbMin {FLT_MAX};
+      glm::vec3 aabbMax {-FLT_MAX};
+
       vertices.reserve(pmesh->mNumVertices);
       for (unsigned int i = 0; i < pmesh->mNumVertices; ++i) {
          vertices.emplace_back(
@@ -86,6 +148,8 @@ namespace Pikzel {
             glm::vec3{ pmesh->mTangents[i].x, pmesh->mTangents[i].y, pmesh->mTangents[i].z },
             pmesh->mTextureCoords[0] ? glm::vec2{ pmesh->mTextureCoords[0][i].x, pmesh->mTextureCoords[0][i].y } : glm::vec2{}
          );
+         aabbMin = glm::min(aabbMin, vertices.back().Pos);
+         aabbMax = glm::max(aabbMax, vertices.back().Pos);
       }
 
       indices.reserve(pmesh->mNumFaces * 3);
@@ -96,6 +160,24 @@ namespace Pikzel {
          }
       }
 
+      // (only for pure triangle lists.  Anything else has escaped aiProcess_Triangulate, and is left alone)
+      if ((optimization != MeshOptimization::None) && (pmesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)) {
+         const auto before = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+         statistics.verticesBefore += vertices.size();
+         statistics.transformedBefore += before.transformedVertices;
+
+         indices = MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+         if (optimization == MeshOptimization::Full) {
+            indices = MeshOptimizer::OptimizeOverdraw(indices, vertices);
+         }
+         MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+         const auto after = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+         statistics.triangles += indices.size() / 3;
+         statistics.verticesAfter += vertices.size();
+         statistics.transformedAfter += after.transformedVertices;
+      }
+
 //      if (pmesh->mMaterialIndex >= 0) {
 //         aiMaterial* material = pscene->mMaterials[pmesh->mMaterialIndex];
 //
@@ -160,16 +242,61 @@ namespace Pikzel {
 //         mesh.HeightTexture = LoadMaterialTexture(material, aiTextureType_HEIGHT, modelDir);                      // There is no height map in the bistro model data, this will just create a default one
 //      }
 
-      return {
-         //AssimpMat4ToGLMMat4(transform),
-         RenderCore::CreateVertexBuffer(Mesh::VertexBufferLayout, vertices.size() * sizeof(Mesh::Vertex), vertices.data()),
-         RenderCore::CreateIndexBuffer(indices.size(), indices.data())
-      };
+      ModelAssetData::MeshData mesh;
+      mesh.lods.emplace_back(0, static_cast<uint32_t>(indices.size()), 0.0f);
+      if (pmesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+         mesh.meshlets = MeshOptimizer::BuildMeshlets(indices, vertices);
+
+         const float maxError = LODMaxError * glm::length(aabbMax - aabbMin);
+         std::vector<uint32_t> lodIndices = indices;
+         while ((mesh.lods.size() < Mesh::MaxLODCount) && (lodIndices.size() >= 3 * LODMinTriangles)) {
+            float error = 0.0f;
+            const size_t targetIndexCount = 3 * static_cast<size_t>(LODReduction * static_cast<float>(lodIndices.size() / 3));
+            auto simplified = MeshOptimizer::Simplify(lodIndices, vertices, targetIndexCount, maxError - mesh.lods.back().error, &error);
+            if (static_cast<float>(simplified.size()) > LODMinReduction * static_cast<float>(lodIndices.size())) {
+               break;
+            }
+            if (optimization != MeshOptimization::None) {
+               simplified = MeshOptimizer::OptimizeVertexCache(simplified, static_cast<uint32_t>(vertices.size()));
+            }
+
+            // each LOD is simplified from the previous one, so errors accumulate
+            mesh.lods.emplace_back(static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(simplified.size()), mesh.lods.back().error + error);
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+            lodIndices = std::move(simplified);
+         }
+      }
 
+      mesh.format = format;
+      mesh.vertexCount = static_cast<uint32_t>(vertices.size());
+      mesh.indexCount = static_cast<uint32_t>(indices.size());
+      mesh.AABB = {aabbMin, aabbMax};
+      switch (format) {
+         case VertexFormat::Packed:
+            mesh.vertices = AddBlob(model, VertexPacking::Pack(vertices));
+            break;
+         case VertexFormat::Quantized:
+            mesh.vertices = AddBlob(model, VertexPacking::Quantize(vertices, mesh.AABB));
+            mesh.dequantize = VertexPacking::DequantizeTransform(mesh.AABB);
+            break;
+         default:
+            mesh.vertices = AddBlob(model, vertices);
+            break;
+      }
+
+      // If every index fits in 16 bits then narrow them (halving their size).  The mesh then goes in the 16-bit index pool.
+      if (mesh.vertexCount <= 0x10000) {
+         mesh.indexType = IndexType::UInt16;
+         mesh.indices = AddBlob(model, std::vector<uint16_t> {indices.begin(), indices.end()});
+      } else {
+         mesh.indexType = IndexType::UInt32;
+         mesh.indices = AddBlob(model, indices);
+      }
+      return mesh;
    }
 
 
-   void ProcessNode(ModelAsset& model, aiMatrix4x4 transform, aiNode* node, const aiScene* scene, const std::filesystem::path& modelDir, size_t indentAmount) {
+   void ProcessNode(ModelAssetData& model, aiMatrix4x4 transform, aiNode* node, const aiScene* scene, const std::filesystem::path& modelDir, const VertexFormat format, const MeshOptimization optimization, OptimizationStatistics& statistics, size_t indentAmount) {
       //std::string indent(indentAmount, ' ');
       //PKZL_CORE_LOG_TRACE("{0} {1}", indent, node->mName.C_Str());
       //PKZL_CORE_LOG_TRACE("{0} Transform = {{", indent);
@@ -186,24 +313,65 @@ namespace Pikzel {
       //PKZL_CORE_LOG_TRACE("{0} Meshes {{", indent);
       for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
          aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-         model.Meshes.emplace_back(ProcessMesh(mesh, transform, scene, modelDir, indentAmount + 3));
+         model.Meshes.emplace_back(ProcessMesh(model, mesh, transform, scene, modelDir, format, optimization, statistics, indentAmount + 3));
          //model.Meshes.back().Index = model.Meshes.size() - 1;
-         //model.AABB = { glm::min(model.AABB.first, model.Meshes.back().AABB.first), glm::max(model.AABB.second, model.Meshes.back().AABB.second) };
       }
       //PKZL_CORE_LOG_TRACE("{0} }}", indent);
       //PKZL_CORE_LOG_TRACE("{0} Children {{", indent);
       for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-         ProcessNode(model, transform, node->mChildren[i], scene, modelDir, indentAmount + 3);
+         ProcessNode(model, transform, node->mChildren[i], scene, modelDir, format, optimization, statistics, indentAmount + 3);
       }
       //PKZL_CORE_LOG_TRACE("{0} }}", indent);
    }
 
 
-   std::shared_ptr<ModelAsset> ModelAssetLoader::operator()(const std::filesystem::path& path) const {
+   std::shared_ptr<ModelAsset> ModelAssetLoader::operator()(const std::filesystem::path& path, const VertexFormat format/*= VertexFormat::Full*/, const MeshOptimization optimization/*= MeshOptimization::Full*/) const {
+      return Upload(*Decode(path, format, optimization));
+   }
+
+
+   std::unique_ptr<ModelAssetData> ModelAssetLoader::Decode(const std::filesystem::path& path, const VertexFormat format/*= VertexFormat::Full*/, const MeshOptimization optimization/*= MeshOptimization::Full*/) {
+      PKZL_PROFILE_FUNCTION();
+      const auto cookedPath = CookedModelAsset::GetPath(path, format);
+      const auto key = CookedModelAsset::ComputeKey(format, optimization, g_AssimpProcessFlags);
+      if (auto model = CookedModelAsset::Read(cookedPath, key)) {
+         PKZL_CORE_LOG_INFO("Loading model from path '{}' (cooked).", path);
+         return model;
+      }
+
+      auto model = Import(path, format, optimization);
+
+      // failing to write the cooked file is not fatal, it just means the next load has to import again
+      try {
+         CookedModelAsset::Write(cookedPath, *model, key);
+      } catch (const std::exception& err) {
+         PKZL_CORE_LOG_WARN("Could not write cooked model for '{}': {}", path, err.what());
+      }
+      return model;
+   }
+
+
+   bool ModelAssetLoader::Cook(const std::filesystem::path& path, const VertexFormat format/*= VertexFormat::Full*/, const MeshOptimization optimization/*= MeshOptimization::Full*/) {
+      PKZL_PROFILE_FUNCTION();
+      const auto cookedPath = CookedModelAsset::GetPath(path, format);
+      const auto key = CookedModelAsset::ComputeKey(format, optimization, g_AssimpProcessFlags);
+      if (CookedModelAsset::IsUpToDate(cookedPath, key)) {
+         return false;
+      }
+      CookedModelAsset::Write(cookedPath, *Import(path, format, optimization), key);
+      return true;
+   }
+
+
+   std::unique_ptr<ModelAssetData> ModelAssetLoader::Import(const std::filesystem::path& path, const VertexFormat format/*= VertexFormat::Full*/, const MeshOptimization optimization/*= MeshOptimization::Full*/) {
+      PKZL_PROFILE_FUNCTION();
       PKZL_CORE_LOG_INFO("Loading model from path '{}'.", path);
-      std::shared_ptr<ModelAsset> model = std::make_shared<ModelAsset>();
+      std::unique_ptr<ModelAssetData> model = std::make_unique<ModelAssetData>();
+
+      model->SourceFiles.emplace_back(path);
 
       Assimp::Importer importer;
+      importer.SetIOHandler(new RecordingIOSystem {model->SourceFiles});  // importer takes ownership
       const aiScene* scene = importer.ReadFile(path.string(), g_AssimpProcessFlags);
 
       if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
@@ -237,9 +405,33 @@ namespace Pikzel {
 
       std::filesystem::path modelDir = path;
       modelDir.remove_filename();
-      ProcessNode(*model, mat, scene->mRootNode, scene, modelDir, 0);
+      OptimizationStatistics statistics;
+      ProcessNode(*model, mat, scene->mRootNode, scene, modelDir, format, optimization, statistics, 0);
+      if (statistics.triangles > 0) {
+         PKZL_CORE_LOG_INFO(
+            "Optimized meshes of '{}': ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", path,
+            static_cast<double>(statistics.transformedBefore) / statistics.triangles, static_cast<double>(statistics.transformedAfter) / statistics.triangles,
+            static_cast<double>(statistics.transformedBefore) / statistics.verticesBefore, static_cast<double>(statistics.transformedAfter) / statistics.verticesAfter
+         );
+      }
 
       return model;
    }
 
+
+   std::shared_ptr<ModelAsset> ModelAssetLoader::Upload(const ModelAssetData& data) {
+      PKZL_PROFILE_FUNCTION();
+      std::shared_ptr<ModelAsset> model = std::make_shared<ModelAsset>();
+      model->Meshes.reserve(data.Meshes.size());
+      for (const auto& mesh : data.Meshes) {
+         auto& pool = GeometryPool::Get(mesh.format, mesh.indexType);
+         auto geometry = (mesh.indexType == IndexType::UInt16)
+            ? pool.Allocate(mesh.vertexCount, mesh.vertices.data(), mesh.indexCount, reinterpret_cast<const uint16_t*>(mesh.indices.data()))
+            : pool.Allocate(mesh.vertexCount, mesh.vertices.data(), mesh.indexCount, reinterpret_cast<const uint32_t*>(mesh.indices.data()));
+         model->Meshes.emplace_back(std::move(geometry), mesh.AABB, mesh.format, mesh.indexType, mesh.dequantize, mesh.lods, mesh.meshlets);
+         model->AABB = { glm::min(model->AABB.first, mesh.AABB.first), glm::max(model->AABB.second, mesh.AABB.second) };
+      }
+      return model;
+   }
+
 }
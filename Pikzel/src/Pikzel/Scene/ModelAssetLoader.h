@@ -1,17 +1,84 @@
 #pragma once
 
+#include "Pikzel/Core/MappedFile.h"
+#include "Pikzel/Scene/MeshOptimizer.h"
 #include "Pikzel/Scene/ModelAsset.h"
 
+#include <cstddef>
 #include <filesystem>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace Pikzel {
 
+   // Model geometry that has been read from file and converted to the vertex format that it is to be stored in,
+   // but has not yet been copied into the GeometryPools (and so is not drawable yet)
+   struct PKZL_API ModelAssetData final {
+      PKZL_NO_COPY(ModelAssetData);
+
+      ModelAssetData() = default;
+      ModelAssetData(ModelAssetData&&) = default;
+      ModelAssetData& operator=(ModelAssetData&&) = default;
+
+      struct MeshData {
+         VertexFormat format = VertexFormat::Full;
+         IndexType indexType = IndexType::UInt32;
+         uint32_t vertexCount = 0;
+         uint32_t indexCount = 0;
+         std::span<const std::byte> vertices; // vertexCount vertices, in format's layout
+         std::span<const std::byte> indices;  // indexCount indices, of indexType.  The indices of all of the LODs, one after another
+         std::vector<Mesh::LOD> lods;
+         std::vector<Mesh::Meshlet> meshlets;
+         std::pair<glm::vec3, glm::vec3> AABB = { glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX} };
+         glm::mat4 dequantize = glm::identity<glm::mat4>();
+      };
+
+      std::vector<MeshData> Meshes;
+
+      // The memory that the meshes' vertices and indices are views of.  Either blobs built by decoding a source file,
+      // or a cooked model file mapped straight into memory (see CookedModelAsset.h)
+      std::vector<std::vector<std::byte>> Blobs;
+      std::unique_ptr<MappedFile> File;
+
+      // The files that the model was imported from: the model file, followed by any others that it refers to.
+      // Empty if the model was read from a cooked file
+      std::vector<std::filesystem::path> SourceFiles;
+   };
+
+
    struct ModelAssetLoader {
       using result_type = std::shared_ptr<ModelAsset>;
 
-      result_type operator()(const std::filesystem::path& path) const;
+      // Load a model asset from file.  Mesh geometry is stored in the specified vertex format, and its indices and vertices
+      // are reordered as per optimization (see MeshOptimizer.h)
+      // (this is just Upload(*Decode(path, format, optimization)))
+      result_type operator()(const std::filesystem::path& path, const VertexFormat format = VertexFormat::Full, const MeshOptimization optimization = MeshOptimization::Full) const;
+
+      // "load" a model asset that has already been constructed elsewhere
+      result_type operator()(std::shared_ptr<ModelAsset> modelAsset) const {
+         return modelAsset;
+      }
+
+      // Read a model from file, optimize its meshes, and convert their geometry to the specified vertex format.
+      // Uses the model's cooked file (see CookedModelAsset.h) if there is an up to date one, otherwise Import()s the model
+      // and writes the cooked file for next time.
+      // Does not touch the GPU, so can be called from any thread.
+      static std::unique_ptr<ModelAssetData> Decode(const std::filesystem::path& path, const VertexFormat format = VertexFormat::Full, const MeshOptimization optimization = MeshOptimization::Full);
+
+      // As for Decode(), but always imports the model via Assimp (ignoring, and not writing, any cooked file)
+      static std::unique_ptr<ModelAssetData> Import(const std::filesystem::path& path, const VertexFormat format = VertexFormat::Full, const MeshOptimization optimization = MeshOptimization::Full);
+
+      // Bring the model's cooked file up to date (importing the model and writing the file if necessary), without loading it.
+      // Returns true if the cooked file was written, false if it was already up to date.
+      // Does not touch the GPU, so can be called from any thread (and without a RenderCore)
+      static bool Cook(const std::filesystem::path& path, const VertexFormat format = VertexFormat::Full, const MeshOptimization optimization = MeshOptimization::Full);
+
+      // Copy decoded geometry into the GeometryPools, giving a drawable model asset.
+      // Render thread only (between frames)
+      static std::shared_ptr<ModelAsset> Upload(const ModelAssetData& data);
 
    };
 
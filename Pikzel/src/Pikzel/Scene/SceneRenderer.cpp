@@ -2,51 +2,540 @@
 
 #include "Pikzel/Components/Model.h"
 #include "Pikzel/Components/Transform.h"
+#include "Pikzel/Renderer/RenderCore.h"
 #include "Pikzel/Scene/AssetCache.h"
+#include "Pikzel/Scene/GeometryPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <utility>
 
 namespace Pikzel {
 
-   std::unique_ptr<SceneRenderer> CreateSceneRenderer(const GraphicsContext& gc) {
-      return std::make_unique<SceneRenderer>(gc);
+   // Meshes are drawn grouped by the geometry pool that they are in.  Pools are ordered by vertex format first,
+   // so that pools that share a pipeline are adjacent.
+   static constexpr uint32_t GeometryPoolCount = VertexFormatCount * IndexTypeCount;
+
+   static uint32_t GeometryPoolIndex(const Mesh& mesh) {
+      return static_cast<uint32_t>(mesh.format) * IndexTypeCount + static_cast<uint32_t>(mesh.indexType);
    }
 
 
-   SceneRenderer::SceneRenderer(const GraphicsContext& gc) {
+   // The simplest LOD of mesh whose error, projected on screen, is at most maxError (as a fraction of the viewport height).
+   // Error is projected at the depth of the nearest corner of the mesh bounds, so it is never under-estimated.
+   static const Mesh::LOD& SelectLOD(const Mesh& mesh, const glm::mat4& mvp, const float maxError) {
+      if ((mesh.lods.size() < 2) || (maxError <= 0.0f)) {
+         return mesh.lods.front();
+      }
 
-      // HACK: This needs to change,  obviously...
-      //       We will want to be able to render with different "materials"
-      m_Pipeline = gc.CreatePipeline({
-         .shaders = {
-            { Pikzel::ShaderType::Vertex, "Renderer/Triangle.vert.spv" },
-            { Pikzel::ShaderType::Fragment, "Renderer/Triangle.frag.spv" }
-         },
-         .bufferLayout = Mesh::VertexBufferLayout
-      });
+      const glm::vec3 row3 = {mvp[0][3], mvp[1][3], mvp[2][3]};
+      const glm::vec3 nearest = glm::mix(mesh.AABB.second, mesh.AABB.first, glm::greaterThan(row3, glm::vec3 {0.0f}));
+      const float w = glm::dot(row3, nearest) + mvp[3][3];
+      if (w <= 0.0f) {
+         return mesh.lods.front(); // bounds reach behind the camera
+      }
 
+      // object space length -> fraction of viewport height (which is 2 in normalized device coordinates)
+      const float scale = glm::length(glm::vec3 {mvp[0][1], mvp[1][1], mvp[2][1]}) / (2.0f * w);
+      for (auto lod = mesh.lods.rbegin(); lod != mesh.lods.rend(); ++lod) {
+         if (lod->error * scale <= maxError) {
+            return *lod;
+         }
+      }
+      return mesh.lods.front();
    }
 
 
-   void SceneRenderer::Render(GraphicsContext& gc, Camera& camera, Scene& scene) {
-      gc.Bind(*m_Pipeline);
+   // buffer, grown (if necessary) to hold at least count elements of elementSize bytes.  capacity is the number of elements that buffer holds
+   static StorageBuffer& ReserveStorageBuffer(std::unique_ptr<StorageBuffer>& buffer, uint32_t& capacity, const uint32_t count, const uint32_t elementSize) {
+      if (!buffer || (capacity < count)) {
+         capacity = std::max(count, 2 * capacity);
+         buffer = RenderCore::CreateStorageBuffer(capacity * elementSize);
+      }
+      return *buffer;
+   }
 
+
+   std::unique_ptr<SceneRenderer> CreateSceneRenderer(const GraphicsContext& gc, const SceneRendererSettings& settings) {
+      return std::make_unique<SceneRenderer>(gc, settings);
+   }
+
+
+   SceneRenderer::SceneRenderer(const GraphicsContext&, const SceneRendererSettings& settings)
+   : m_Settings {settings}
+   {
+      // Every indirect path draws its batches from one buffer of transforms, with each command's firstInstance saying where its batch starts.
+      // Direct instanced draws can always set firstInstance, so those are used instead if indirect commands cannot.
+      if ((m_Settings.useIndirectDraws || m_Settings.useGPUCulling || m_Settings.useClusterCulling) && !RenderCore::SupportsIndirectFirstInstance()) {
+         PKZL_CORE_LOG_WARN("Indirect draws with non-zero first instance are not supported.  Falling back to instanced draws");
+         m_Settings.useIndirectDraws = false;
+         m_Settings.useGPUCulling = false;
+         m_Settings.useClusterCulling = false;
+         m_Settings.useInstancing = true;
+      }
+      // GPU culling decides how many draws there are on the GPU
+      if ((m_Settings.useGPUCulling || m_Settings.useClusterCulling) && !RenderCore::SupportsIndirectCount()) {
+         PKZL_CORE_LOG_WARN("Indirect draw counts are not supported.  Falling back to culling on the CPU");
+         m_Settings.useGPUCulling = false;
+         m_Settings.useClusterCulling = false;
+         m_Settings.useIndirectDraws = true;
+      }
+      if (m_Settings.useGPUCulling) {
+         m_Settings.useClusterCulling = false;
+         m_Settings.useIndirectDraws = true;
+         m_ComputeContext = RenderCore::CreateComputeContext();
+         m_CullPipeline = m_ComputeContext->CreatePipeline({
+            .shaders = {
+               { Pikzel::ShaderType::Compute, "Scene/Shaders/Cull.comp.spv" }
+            }
+         });
+      }
+      if (m_Settings.useClusterCulling) {
+         m_Settings.useIndirectDraws = true;
+         m_ComputeContext = RenderCore::CreateComputeContext();
+         m_ClusterCullPipeline = m_ComputeContext->CreatePipeline({
+            .shaders = {
+               { Pikzel::ShaderType::Compute, "Scene/Shaders/ClusterCull.comp.spv" }
+            }
+         });
+      }
+      if (m_Settings.useIndirectDraws) {
+         m_Settings.useInstancing = true;
+      }
+   }
+
+
+   // HACK: This needs to change,  obviously...
+   //       We will want to be able to render with different "materials"
+   //       For now there is one pipeline per vertex format, created the first time a mesh of that format is drawn
+   Pipeline& SceneRenderer::GetPipeline(const GraphicsContext& gc, const VertexFormat format) {
+      auto& pipeline = m_Pipelines[static_cast<uint32_t>(format)];
+      if (!pipeline) {
+         const bool isPacked = format != VertexFormat::Full;
+         const char* vertexShader = m_Settings.useInstancing ?
+            (isPacked ? "Scene/Shaders/InstancedPacked.vert.spv" : "Scene/Shaders/Instanced.vert.spv") :
+            (isPacked ? "Scene/Shaders/Packed.vert.spv" : "Renderer/Triangle.vert.spv");
+         pipeline = gc.CreatePipeline({
+            .shaders = {
+               { Pikzel::ShaderType::Vertex, vertexShader },
+               { Pikzel::ShaderType::Fragment, "Renderer/Triangle.frag.spv" }
+            },
+            .bufferLayout = Mesh::GetVertexBufferLayout(format)
+         });
+      }
+      return *pipeline;
+   }
+
+
+   void SceneRenderer::Render(GraphicsContext& gc, Camera& camera, Scene& scene) {
       glm::mat4 vp = camera.projection * glm::lookAt(camera.position, camera.position + camera.direction, camera.upVector);
 
+      if (m_FrameBuffers.size() < gc.GetMaxFramesInFlight()) {
+         m_FrameBuffers.resize(gc.GetMaxFramesInFlight());
+      }
+      m_FrameIndex = gc.GetFrameIndex();
+
+      if (m_Settings.useGPUCulling) {
+         RenderGPUCulled(gc, vp, scene);
+         return;
+      }
+
+      Culling::CullScene(scene, vp, m_VisibleLists);
+
+      if (m_Settings.useClusterCulling) {
+         RenderClusterCulled(gc, vp);
+      } else if (m_Settings.useIndirectDraws) {
+         RenderIndirect(gc);
+      } else if (m_Settings.useInstancing) {
+         RenderInstanced(gc);
+      } else {
+         RenderDirect(gc);
+      }
+   }
+
+
+   void SceneRenderer::RenderDirect(GraphicsContext& gc) {
+      PKZL_PROFILE_FUNCTION();
+
+      // Queue up the visible meshes.  The key sorts by geometry pool (and hence by pipeline, i.e. vertex format), then by mesh (meshes do not yet have materials),
+      // then front-to-back by the view depth of the object's origin (w of the object origin in clip space)
+      m_RenderQueue.Clear();
+      m_DirectDraws.clear();
+      m_MeshIds.clear();
+      for (const auto& list : m_VisibleLists) {
+         for (const auto& object : list.objects) {
+            for (uint32_t i = object.firstMesh; i < object.firstMesh + object.meshCount; ++i) {
+               // the mesh id only groups draws of the same mesh together (nothing is rebound by it), so it can wrap around if there are more meshes than the key holds
+               const auto [meshId, inserted] = m_MeshIds.try_emplace(list.meshes[i], static_cast<uint32_t>(m_MeshIds.size()) % (RenderQueue::MaxMesh + 1));
+               m_RenderQueue.Add(RenderQueue::MakeKey(GeometryPoolIndex(*list.meshes[i]), 0, meshId->second, object.mvp[3][3]), static_cast<uint32_t>(m_DirectDraws.size()));
+               m_DirectDraws.emplace_back(list.meshes[i], &SelectLOD(*list.meshes[i], object.mvp, m_Settings.lodError), &object.mvp);
+            }
+         }
+      }
+      m_RenderQueue.Sort();
+
       // something like this.. only more complicated.. (e.g need materials, shadows, animation, ...)
-      for (auto&& [object, transform, model] : scene.GetGroup<const glm::mat4, const Model>().each()) {
-         gc.PushConstant("constants.mvp"_hs, vp * transform);
+      const GeometryPool* pool = nullptr;
+      const glm::mat4* mvp = nullptr;
+      for (const auto& item : m_RenderQueue.GetItems()) {
+         const auto& draw = m_DirectDraws[item.index];
+         const VertexFormat format = draw.mesh->format;
+         if (pool != &draw.mesh->GetGeometryPool()) {
+            pool = &draw.mesh->GetGeometryPool();
+            gc.Bind(GetPipeline(gc, format));
+            mvp = nullptr;
+         }
+         if (format == VertexFormat::Quantized) {
+            // dequantize transform is different for every mesh
+            gc.PushConstant("constants.mvp"_hs, *draw.mvp * draw.mesh->dequantize);
+            mvp = nullptr;
+         } else if (draw.mvp != mvp) {
+            mvp = draw.mvp;
+            gc.PushConstant("constants.mvp"_hs, *mvp);
+         }
+         //gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
+         //gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
+         //gc.Bind("uNormals"_hs, *mesh.NormalTexture);
+         //gc.Bind("uAmbientOcclusion"_hs, *mesh.AmbientOcclusionTexture);
+         //gc.Bind("uHeightMap"_hs, *mesh.HeightTexture);
+         const auto& geometry = *draw.mesh->geometry;
+         gc.DrawIndexed(pool->GetVertexBuffer(), pool->GetIndexBuffer(), draw.lod->indexCount, geometry.vertexOffset, geometry.firstIndex + draw.lod->firstIndex);
+      }
+   }
 
-         auto modelAsset = AssetCache::GetModelAsset(model.id);
 
+   void SceneRenderer::RenderInstanced(GraphicsContext& gc) {
+      PKZL_PROFILE_FUNCTION();
+
+      BuildInstanceBatches();
+      if (m_Batches.empty()) {
+         return;
+      }
+
+      // batches are sorted by geometry pool, so the buffers and pipeline only need to change when the pool does
+      const StorageBuffer& transformBuffer = *m_FrameBuffers[m_FrameIndex].transforms;
+      const GeometryPool* pool = nullptr;
+      for (const auto& batch : m_Batches) {
+         if (pool != &batch.mesh->GetGeometryPool()) {
+            pool = &batch.mesh->GetGeometryPool();
+            gc.Bind(GetPipeline(gc, batch.mesh->format));
+            gc.Bind("SSBOTransforms"_hs, transformBuffer);
+         }
+         const auto& geometry = *batch.mesh->geometry;
+         gc.DrawIndexedInstanced(pool->GetVertexBuffer(), pool->GetIndexBuffer(), batch.instanceCount, batch.firstInstance, batch.lod->indexCount, geometry.vertexOffset, geometry.firstIndex + batch.lod->firstIndex);
+      }
+   }
+
+
+   void SceneRenderer::RenderIndirect(GraphicsContext& gc) {
+      PKZL_PROFILE_FUNCTION();
+
+      BuildInstanceBatches();
+      if (m_Batches.empty()) {
+         return;
+      }
+
+      m_Commands.clear();
+      m_Commands.reserve(m_Batches.size());
+      for (const auto& batch : m_Batches) {
+         const auto& geometry = *batch.mesh->geometry;
+         m_Commands.emplace_back(batch.lod->indexCount, batch.instanceCount, geometry.firstIndex + batch.lod->firstIndex, static_cast<int32_t>(geometry.vertexOffset), batch.firstInstance);
+      }
+
+      const uint32_t commandCount = static_cast<uint32_t>(m_Commands.size());
+      IndirectBuffer& indirectBuffer = ReserveCommands(commandCount);
+      indirectBuffer.CopyFromHost(0, commandCount * sizeof(DrawIndexedIndirectCommand), m_Commands.data());
+      const StorageBuffer& transformBuffer = *m_FrameBuffers[m_FrameIndex].transforms;
+
+      // Meshes of the same vertex format and index type share a geometry pool's buffers, and batches are sorted by pool,
+      // so all of the batches in each pool are drawn with one call
+      for (uint32_t firstCommand = 0; firstCommand < commandCount;) {
+         const auto& pool = m_Batches[firstCommand].mesh->GetGeometryPool();
+         uint32_t drawCount = 1;
+         while ((firstCommand + drawCount < commandCount) && (&m_Batches[firstCommand + drawCount].mesh->GetGeometryPool() == &pool)) {
+            ++drawCount;
+         }
+         gc.Bind(GetPipeline(gc, m_Batches[firstCommand].mesh->format));
+         gc.Bind("SSBOTransforms"_hs, transformBuffer);
+         gc.MultiDrawIndexedIndirect(pool.GetVertexBuffer(), pool.GetIndexBuffer(), indirectBuffer, drawCount, firstCommand);
+         firstCommand += drawCount;
+      }
+   }
+
+
+   void SceneRenderer::RenderGPUCulled(GraphicsContext& gc, const glm::mat4& vp, Scene& scene) {
+      PKZL_PROFILE_FUNCTION();
+
+      // Gather every mesh of every object as an instance.  Nothing is culled here, that is left to the compute shader.
+      // LODs are selected here though, and instances are batched by mesh LOD.  Each batch gets a region of the indirect buffer
+      // big enough to hold a command for every one of its instances.
+      m_GPUInstances.clear();
+      m_Batches.clear();
+      m_BatchIndices.clear();
+      auto group = scene.GetGroup<const glm::mat4, const Model>();
+      for (const auto entity : group) {
+         const auto [transform, model] = group.get<const glm::mat4, const Model>(entity);
+         auto modelAsset = AssetCache::GetModelAsset(model.id);
+         if (!modelAsset) {
+            continue;
+         }
+         const glm::mat4 mvp = vp * transform;
          for (const auto& mesh : modelAsset->Meshes) {
-            //gc.PushConstant("constants.mvp"_hs, transform * mesh.Transform);
-            //gc.Bind("uAlbedo"_hs, *mesh.AlbedoTexture);
-            //gc.Bind("uMetallicRoughness"_hs, *mesh.MetallicRoughnessTexture);
-            //gc.Bind("uNormals"_hs, *mesh.NormalTexture);
-            //gc.Bind("uAmbientOcclusion"_hs, *mesh.AmbientOcclusionTexture);
-            //gc.Bind("uHeightMap"_hs, *mesh.HeightTexture);
-            gc.DrawIndexed(*mesh.vertexBuffer, *mesh.indexBuffer);
+            const auto& lod = SelectLOD(mesh, mvp, m_Settings.lodError);
+            const auto [batchIndex, inserted] = m_BatchIndices.try_emplace(&lod, static_cast<uint32_t>(m_Batches.size()));
+            if (inserted) {
+               m_Batches.emplace_back(&mesh, &lod, 0, 0);
+            }
+            ++m_Batches[batchIndex->second].instanceCount;
+            const uint32_t firstIndex = mesh.geometry->firstIndex + lod.firstIndex;
+            if (mesh.format == VertexFormat::Quantized) {
+               // Fold the dequantize transform into the object transform.  The mesh bounds in quantized space are then just the unit cube.
+               m_GPUInstances.emplace_back(transform * mesh.dequantize, glm::vec4 {0.0f, 0.0f, 0.0f, 1.0f}, glm::vec4 {1.0f}, lod.indexCount, firstIndex, static_cast<int32_t>(mesh.geometry->vertexOffset), batchIndex->second, 0u);
+            } else {
+               m_GPUInstances.emplace_back(transform, glm::vec4 {mesh.AABB.first, 1.0f}, glm::vec4 {mesh.AABB.second, 1.0f}, lod.indexCount, firstIndex, static_cast<int32_t>(mesh.geometry->vertexOffset), batchIndex->second, 0u);
+            }
          }
       }
+      if (m_GPUInstances.empty()) {
+         return;
+      }
+
+      const auto& batchRemap = SortBatchesByPool();
+      for (auto& instance : m_GPUInstances) {
+         instance.group = batchRemap[instance.group];
+      }
+
+      uint32_t firstCommand = 0;
+      for (auto& batch : m_Batches) {
+         batch.firstInstance = firstCommand;
+         firstCommand += batch.instanceCount;
+      }
+      for (auto& instance : m_GPUInstances) {
+         instance.firstCommand = m_Batches[instance.group].firstInstance;
+      }
+
+      const uint32_t instanceCount = static_cast<uint32_t>(m_GPUInstances.size());
+      const uint32_t batchCount = static_cast<uint32_t>(m_Batches.size());
+
+      auto& frame = m_FrameBuffers[m_FrameIndex];
+      StorageBuffer& instanceBuffer = ReserveStorageBuffer(frame.instances, frame.instanceCapacity, instanceCount, sizeof(GPUInstance));
+      instanceBuffer.CopyFromHost(0, instanceCount * sizeof(GPUInstance), m_GPUInstances.data());
+
+      StorageBuffer& countBuffer = ReserveCounts(batchCount);
+      StorageBuffer& transformBuffer = ReserveTransforms(instanceCount);
+      IndirectBuffer& indirectBuffer = ReserveCommands(instanceCount);
+
+      // The cull shader accumulates the draw counts, so they must start from zero.
+      // They are cleared on the GPU so that the clear is ordered after earlier frames' draws that read them.
+      m_ComputeContext->Begin();
+      m_ComputeContext->Fill(countBuffer, 0);
+      m_ComputeContext->Bind(*m_CullPipeline);
+      m_ComputeContext->Bind("SSBOInstances"_hs, instanceBuffer);
+      m_ComputeContext->Bind("SSBOTransforms"_hs, transformBuffer);
+      m_ComputeContext->Bind("SSBOCommands"_hs, indirectBuffer);
+      m_ComputeContext->Bind("SSBOCounts"_hs, countBuffer);
+      m_ComputeContext->PushConstant("constants.vp"_hs, vp);
+      m_ComputeContext->PushConstant("constants.instanceCount"_hs, instanceCount);
+      m_ComputeContext->Dispatch((instanceCount + 63) / 64, 1, 1);
+      m_ComputeContext->End();
+
+      const GeometryPool* pool = nullptr;
+      for (uint32_t i = 0; i < batchCount; ++i) {
+         const auto& batch = m_Batches[i];
+         if (pool != &batch.mesh->GetGeometryPool()) {
+            pool = &batch.mesh->GetGeometryPool();
+            gc.Bind(GetPipeline(gc, batch.mesh->format));
+            gc.Bind("SSBOTransforms"_hs, transformBuffer);
+         }
+         gc.DrawIndexedIndirectCount(pool->GetVertexBuffer(), pool->GetIndexBuffer(), indirectBuffer, countBuffer, batch.instanceCount, batch.firstInstance, i);
+      }
+   }
+
+
+   void SceneRenderer::RenderClusterCulled(GraphicsContext& gc, const glm::mat4& vp) {
+      PKZL_PROFILE_FUNCTION();
+
+      // Meshes drawn at full detail contribute a cluster per meshlet.  Meshes drawn at a simpler LOD (or that have no meshlets)
+      // are a single cluster that is always drawn (the object has already passed frustum culling)
+      for (auto& clusters : m_PoolClusters) {
+         clusters.clear();
+      }
+      m_ClusterInstances.clear();
+      m_Transforms.clear();
+      const bool isViewMirrored = glm::determinant(vp) < 0.0f;
+      for (const auto& list : m_VisibleLists) {
+         for (const auto& object : list.objects) {
+            // The eye, in object space, is the point that projects to clip space (0, 0, z, 0).  There is no such point for an orthographic projection.
+            // Cone culling also has to be skipped if the object transform is a mirroring one, as that swaps front and back faces.
+            glm::vec4 eye = glm::inverse(object.mvp) * glm::vec4 {0.0f, 0.0f, 1.0f, 0.0f};
+            const bool isMirrored = (glm::determinant(object.mvp) < 0.0f) != isViewMirrored;
+            eye = (isMirrored || (glm::abs(eye.w) < FLT_EPSILON)) ? glm::vec4 {0.0f} : glm::vec4 {glm::vec3 {eye} / eye.w, 1.0f};
+
+            for (uint32_t i = object.firstMesh; i < object.firstMesh + object.meshCount; ++i) {
+               const Mesh& mesh = *list.meshes[i];
+               const auto& lod = SelectLOD(mesh, object.mvp, m_Settings.lodError);
+               const uint32_t instance = static_cast<uint32_t>(m_ClusterInstances.size());
+               m_ClusterInstances.emplace_back(object.mvp, eye);
+               m_Transforms.emplace_back((mesh.format == VertexFormat::Quantized) ? object.mvp * mesh.dequantize : object.mvp);
+
+               const uint32_t pool = GeometryPoolIndex(mesh);
+               const auto& geometry = *mesh.geometry;
+               auto& clusters = m_PoolClusters[pool];
+               if ((&lod == &mesh.lods.front()) && !mesh.meshlets.empty()) {
+                  for (const auto& meshlet : mesh.meshlets) {
+                     clusters.emplace_back(glm::vec4 {meshlet.center, meshlet.radius}, glm::vec4 {meshlet.coneAxis, meshlet.coneCutoff}, geometry.firstIndex + meshlet.firstIndex, 3 * meshlet.triangleCount, static_cast<int32_t>(geometry.vertexOffset), instance, pool, 0u);
+                  }
+               } else {
+                  clusters.emplace_back(glm::vec4 {0.0f, 0.0f, 0.0f, -1.0f}, glm::vec4 {0.0f}, geometry.firstIndex + lod.firstIndex, lod.indexCount, static_cast<int32_t>(geometry.vertexOffset), instance, pool, 0u);
+               }
+            }
+         }
+      }
+      if (m_ClusterInstances.empty()) {
+         return;
+      }
+
+      // each pool's clusters get a region of the indirect buffer big enough to hold a command for every one of them
+      std::array<uint32_t, GeometryPoolCount> firstCommand = {};
+      m_Clusters.clear();
+      for (uint32_t pool = 0; pool < GeometryPoolCount; ++pool) {
+         firstCommand[pool] = static_cast<uint32_t>(m_Clusters.size());
+         for (auto& cluster : m_PoolClusters[pool]) {
+            cluster.firstCommand = firstCommand[pool];
+         }
+         m_Clusters.insert(m_Clusters.end(), m_PoolClusters[pool].begin(), m_PoolClusters[pool].end());
+      }
+
+      const uint32_t clusterCount = static_cast<uint32_t>(m_Clusters.size());
+      const uint32_t instanceCount = static_cast<uint32_t>(m_ClusterInstances.size());
+
+      auto& frame = m_FrameBuffers[m_FrameIndex];
+      StorageBuffer& clusterBuffer = ReserveStorageBuffer(frame.clusters, frame.clusterCapacity, clusterCount, sizeof(GPUCluster));
+      clusterBuffer.CopyFromHost(0, clusterCount * sizeof(GPUCluster), m_Clusters.data());
+      StorageBuffer& clusterInstanceBuffer = ReserveStorageBuffer(frame.clusterInstances, frame.clusterInstanceCapacity, instanceCount, sizeof(GPUClusterInstance));
+      clusterInstanceBuffer.CopyFromHost(0, instanceCount * sizeof(GPUClusterInstance), m_ClusterInstances.data());
+
+      StorageBuffer& countBuffer = ReserveCounts(GeometryPoolCount);
+      StorageBuffer& transformBuffer = ReserveTransforms(instanceCount);
+      transformBuffer.CopyFromHost(0, instanceCount * sizeof(glm::mat4), m_Transforms.data());
+      IndirectBuffer& indirectBuffer = ReserveCommands(clusterCount);
+
+      // the cull shader accumulates the draw counts, so they must start from zero (see RenderGPUCulled())
+      m_ComputeContext->Begin();
+      m_ComputeContext->Fill(countBuffer, 0);
+      m_ComputeContext->Bind(*m_ClusterCullPipeline);
+      m_ComputeContext->Bind("SSBOClusters"_hs, clusterBuffer);
+      m_ComputeContext->Bind("SSBOClusterInstances"_hs, clusterInstanceBuffer);
+      m_ComputeContext->Bind("SSBOCommands"_hs, indirectBuffer);
+      m_ComputeContext->Bind("SSBOCounts"_hs, countBuffer);
+      m_ComputeContext->PushConstant("constants.clusterCount"_hs, clusterCount);
+      m_ComputeContext->Dispatch((clusterCount + 63) / 64, 1, 1);
+      m_ComputeContext->End();
+
+      for (uint32_t pool = 0; pool < GeometryPoolCount; ++pool) {
+         const uint32_t poolClusterCount = static_cast<uint32_t>(m_PoolClusters[pool].size());
+         if (poolClusterCount == 0) {
+            continue;
+         }
+         const auto format = static_cast<VertexFormat>(pool / IndexTypeCount);
+         const auto& geometryPool = GeometryPool::Get(format, static_cast<IndexType>(pool % IndexTypeCount));
+         gc.Bind(GetPipeline(gc, format));
+         gc.Bind("SSBOTransforms"_hs, transformBuffer);
+         gc.DrawIndexedIndirectCount(geometryPool.GetVertexBuffer(), geometryPool.GetIndexBuffer(), indirectBuffer, countBuffer, poolClusterCount, firstCommand[pool], pool);
+      }
+   }
+
+
+   void SceneRenderer::BuildInstanceBatches() {
+      // Batch the visible meshes by mesh LOD, and upload their transforms so that each batch's transforms are contiguous.
+      // (first pass selects LODs and counts the instances in each batch, second pass places the transforms)
+      m_Batches.clear();
+      m_BatchIndices.clear();
+      m_LODs.clear();
+      for (const auto& list : m_VisibleLists) {
+         for (const auto& object : list.objects) {
+            for (uint32_t i = object.firstMesh; i < object.firstMesh + object.meshCount; ++i) {
+               const auto& lod = m_LODs.emplace_back(&SelectLOD(*list.meshes[i], object.mvp, m_Settings.lodError));
+               const auto [batchIndex, inserted] = m_BatchIndices.try_emplace(lod, static_cast<uint32_t>(m_Batches.size()));
+               if (inserted) {
+                  m_Batches.emplace_back(list.meshes[i], lod, 0, 0);
+               }
+               ++m_Batches[batchIndex->second].instanceCount;
+            }
+         }
+      }
+      if (m_Batches.empty()) {
+         return;
+      }
+
+      for (const auto& batchRemap = SortBatchesByPool(); auto& [lod, batchIndex] : m_BatchIndices) {
+         batchIndex = batchRemap[batchIndex];
+      }
+
+      uint32_t instanceCount = 0;
+      for (auto& batch : m_Batches) {
+         batch.firstInstance = instanceCount;
+         instanceCount += batch.instanceCount;
+         batch.instanceCount = 0;
+      }
+
+      m_Transforms.resize(instanceCount);
+      auto lod = m_LODs.begin();
+      for (const auto& list : m_VisibleLists) {
+         for (const auto& object : list.objects) {
+            for (uint32_t i = object.firstMesh; i < object.firstMesh + object.meshCount; ++i) {
+               auto& batch = m_Batches[m_BatchIndices.at(*lod++)];
+               m_Transforms[batch.firstInstance + batch.instanceCount++] = (batch.mesh->format == VertexFormat::Quantized) ? object.mvp * batch.mesh->dequantize : object.mvp;
+            }
+         }
+      }
+
+      ReserveTransforms(instanceCount).CopyFromHost(0, instanceCount * sizeof(glm::mat4), m_Transforms.data());
+   }
+
+
+   // Stable sort m_Batches by geometry pool, so that batches in the same pool can be drawn together.
+   // Returns the mapping from old batch index to new
+   const std::vector<uint32_t>& SceneRenderer::SortBatchesByPool() {
+      std::array<uint32_t, GeometryPoolCount> firstBatch = {};
+      for (const auto& batch : m_Batches) {
+         ++firstBatch[GeometryPoolIndex(*batch.mesh)];
+      }
+      for (uint32_t pool = 0, offset = 0; pool < GeometryPoolCount; ++pool) {
+         offset += std::exchange(firstBatch[pool], offset);
+      }
+
+      m_BatchRemap.resize(m_Batches.size());
+      m_SortedBatches.resize(m_Batches.size());
+      for (uint32_t i = 0; i < m_Batches.size(); ++i) {
+         m_BatchRemap[i] = firstBatch[GeometryPoolIndex(*m_Batches[i].mesh)]++;
+         m_SortedBatches[m_BatchRemap[i]] = m_Batches[i];
+      }
+      std::swap(m_Batches, m_SortedBatches);
+      return m_BatchRemap;
+   }
+
+
+   // Reserve...() return the current frame's buffer, grown to hold at least count elements
+   StorageBuffer& SceneRenderer::ReserveTransforms(const uint32_t count) {
+      auto& frame = m_FrameBuffers[m_FrameIndex];
+      return ReserveStorageBuffer(frame.transforms, frame.transformCapacity, count, sizeof(glm::mat4));
+   }
+
+
+   IndirectBuffer& SceneRenderer::ReserveCommands(const uint32_t count) {
+      auto& frame = m_FrameBuffers[m_FrameIndex];
+      if (!frame.commands || (frame.commands->GetCount() < count)) {
+         frame.commands = RenderCore::CreateIndirectBuffer(std::max(count, frame.commands ? 2 * frame.commands->GetCount() : 0));
+      }
+      return *frame.commands;
+   }
+
+
+   StorageBuffer& SceneRenderer::ReserveCounts(const uint32_t count) {
+      auto& frame = m_FrameBuffers[m_FrameIndex];
+      return ReserveStorageBuffer(frame.counts, frame.countCapacity, count, sizeof(uint32_t));
    }
 
-}
\ No newline at end of file
+}
@@ -1,24 +1,143 @@
 #pragma once
 
+#include "Pikzel/Renderer/Buffer.h"
+#include "Pikzel/Renderer/ComputeContext.h"
 #include "Pikzel/Renderer/GraphicsContext.h"
 #include "Pikzel/Renderer/Pipeline.h"
+#include "Pikzel/Renderer/RenderQueue.h"
 #include "Pikzel/Scene/Camera.h"
+#include "Pikzel/Scene/Culling.h"
 #include "Pikzel/Scene/Scene.h"
 
+#include <array>
+#include <unordered_map>
+
 namespace Pikzel {
 
+   struct SceneRendererSettings {
+      bool useInstancing = false;     // if true, visible meshes are grouped by mesh (and so by ModelAsset), and each group is drawn with one DrawIndexedInstanced()
+      bool useIndirectDraws = false;  // if true, as for useInstancing but each group is an indirect draw command (implies useInstancing)
+      bool useGPUCulling = false;     // if true, meshes are culled by a compute shader which writes the indirect draw commands (implies useIndirectDraws)
+      bool useClusterCulling = false; // if true, visible meshes drawn at full detail are further culled meshlet by meshlet (against the frustum, and by normal cone) by a compute shader which writes an indirect draw command per visible meshlet (implies useIndirectDraws, ignored if useGPUCulling)
+      float lodError = 0.001f;        // each mesh is drawn with its simplest LOD whose error, projected on screen, is at most this fraction of the viewport height.  0 => always full detail
+   };
+
+
    class PKZL_API SceneRenderer {
    public:
 
-      SceneRenderer(const GraphicsContext& gc);
+      SceneRenderer(const GraphicsContext& gc, const SceneRendererSettings& settings = {});
       virtual ~SceneRenderer() = default;
 
       void Render(GraphicsContext& gc, Camera& camera, Scene& scene);
 
    private:
-      std::unique_ptr<Pipeline> m_Pipeline;
+      void RenderDirect(GraphicsContext& gc);
+      void RenderInstanced(GraphicsContext& gc);
+      void RenderIndirect(GraphicsContext& gc);
+      void RenderGPUCulled(GraphicsContext& gc, const glm::mat4& vp, Scene& scene);
+      void RenderClusterCulled(GraphicsContext& gc, const glm::mat4& vp);
+
+      Pipeline& GetPipeline(const GraphicsContext& gc, const VertexFormat format);
+
+      void BuildInstanceBatches();
+      const std::vector<uint32_t>& SortBatchesByPool();
+      StorageBuffer& ReserveTransforms(const uint32_t count);
+      IndirectBuffer& ReserveCommands(const uint32_t count);
+      StorageBuffer& ReserveCounts(const uint32_t count);
+
+   private:
+      SceneRendererSettings m_Settings;
+      std::array<std::unique_ptr<Pipeline>, VertexFormatCount> m_Pipelines; // m_Pipelines[format] = pipeline for drawing meshes of that vertex format
+      std::vector<Culling::VisibleList> m_VisibleLists; // kept from frame to frame so that the lists' storage is reused
+
+      // Direct drawing.  Visible meshes are put into a render queue, sorted by mesh and then front-to-back
+      struct DirectDraw {
+         const Mesh* mesh;
+         const Mesh::LOD* lod;
+         const glm::mat4* mvp;
+      };
+      RenderQueue m_RenderQueue;
+      std::vector<DirectDraw> m_DirectDraws;
+      std::unordered_map<const Mesh*, uint32_t> m_MeshIds;
+
+      // Buffers that draws read, and that are rewritten every frame.
+      // There is a set for each frame that the graphics context may have in flight (see GraphicsContext::GetFrameIndex()),
+      // so that a frame never overwrites buffers that an earlier frame's draws are still reading.
+      // Buffers grow as required, and are never shrunk
+      struct FrameBuffers {
+         std::unique_ptr<StorageBuffer> transforms;
+         uint32_t transformCapacity = 0;  // number of transforms that transforms can hold
+         std::unique_ptr<IndirectBuffer> commands;
+         std::unique_ptr<StorageBuffer> counts;
+         uint32_t countCapacity = 0;      // number of draw counts that counts can hold
+         std::unique_ptr<StorageBuffer> instances;
+         uint32_t instanceCapacity = 0;   // number of GPUInstances that instances can hold
+         std::unique_ptr<StorageBuffer> clusters;
+         uint32_t clusterCapacity = 0;    // number of GPUClusters that clusters can hold
+         std::unique_ptr<StorageBuffer> clusterInstances;
+         uint32_t clusterInstanceCapacity = 0;  // number of GPUClusterInstances that clusterInstances can hold
+      };
+      std::vector<FrameBuffers> m_FrameBuffers;
+      uint32_t m_FrameIndex = 0;          // m_FrameBuffers[m_FrameIndex] is the set that the current frame uses
+
+      // Instanced and indirect drawing.
+      // Visible meshes are batched by mesh LOD, batch i is instances [firstInstance, firstInstance + instanceCount) of m_Transforms.
+      // Batches are sorted by geometry pool.
+      struct InstanceBatch {
+         const Mesh* mesh;
+         const Mesh::LOD* lod;
+         uint32_t firstInstance;
+         uint32_t instanceCount;
+      };
+      std::vector<InstanceBatch> m_Batches;
+      std::unordered_map<const Mesh::LOD*, uint32_t> m_BatchIndices;
+      std::vector<const Mesh::LOD*> m_LODs;        // LOD selected for each visible mesh, in visible list order (scratch space for BuildInstanceBatches())
+      std::vector<InstanceBatch> m_SortedBatches;  // } scratch space for SortBatchesByPool()
+      std::vector<uint32_t> m_BatchRemap;          // }
+      std::vector<glm::mat4> m_Transforms;
+      std::vector<DrawIndexedIndirectCommand> m_Commands;
+
+      // GPU culling.  Every mesh of every object is an "instance" that the cull shader tests.
+      // Instances of the same mesh LOD form a batch (in m_Batches), and each batch has its own region of the indirect buffer and its own draw count
+      struct GPUInstance {
+         glm::mat4 transform;
+         glm::vec4 aabbMin;
+         glm::vec4 aabbMax;
+         uint32_t indexCount;
+         uint32_t firstIndex;
+         int32_t vertexOffset;
+         uint32_t group;
+         uint32_t firstCommand;
+         uint32_t padding[3];
+      };
+      std::unique_ptr<ComputeContext> m_ComputeContext;
+      std::unique_ptr<Pipeline> m_CullPipeline;
+      std::vector<GPUInstance> m_GPUInstances;
+
+      // Cluster culling.  Every visible mesh is an instance, and each meshlet of an instance is a cluster that the cluster cull shader tests.
+      // Clusters are grouped by geometry pool, and each pool has its own region of the indirect buffer and its own draw count
+      struct GPUCluster {
+         glm::vec4 sphere;
+         glm::vec4 cone;
+         uint32_t firstIndex;
+         uint32_t indexCount;
+         int32_t vertexOffset;
+         uint32_t instance;
+         uint32_t pool;
+         uint32_t firstCommand;
+         uint32_t padding[2];
+      };
+      struct GPUClusterInstance {
+         glm::mat4 mvp;
+         glm::vec4 eye;
+      };
+      std::unique_ptr<Pipeline> m_ClusterCullPipeline;
+      std::array<std::vector<GPUCluster>, VertexFormatCount * IndexTypeCount> m_PoolClusters;
+      std::vector<GPUCluster> m_Clusters;
+      std::vector<GPUClusterInstance> m_ClusterInstances;
    };
 
-   std::unique_ptr<SceneRenderer> PKZL_API CreateSceneRenderer(const GraphicsContext& gc);
+   std::unique_ptr<SceneRenderer> PKZL_API CreateSceneRenderer(const GraphicsContext& gc, const SceneRendererSettings& settings = {});
 
 }
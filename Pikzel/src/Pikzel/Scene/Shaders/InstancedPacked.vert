@@ -0,0 +1,20 @@
+#version 450 core
+
+// As for Instanced.vert, but for VertexFormat::Packed and VertexFormat::Quantized vertices (see Packed.vert)
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inNormal;    // octahedral encoded
+layout(location = 2) in vec2 inTangent;   // octahedral encoded
+layout(location = 3) in vec2 inTexCoords;
+
+// One mvp per instance.  Instances of a draw (or indirect draw command) start at firstInstance
+layout(std430, set = 0, binding = 0) readonly buffer SSBOTransforms {
+   mat4 mvp[];
+} transforms;
+
+layout (location = 0) out vec3 outColor;
+
+
+void main() {
+   outColor = vec3(inTexCoords, 0);
+   gl_Position = transforms.mvp[gl_InstanceIndex] * vec4(inPos, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 450 core
+
+// As for Renderer/Triangle.vert, but for VertexFormat::Packed and VertexFormat::Quantized vertices.
+// Quantized positions are read as [0, 1] (unorm) and the mesh's dequantize transform is already folded into mvp,
+// so both formats are handled the same way.
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inNormal;    // octahedral encoded
+layout(location = 2) in vec2 inTangent;   // octahedral encoded
+layout(location = 3) in vec2 inTexCoords;
+
+layout(push_constant) uniform PC {
+   mat4 mvp;
+} constants;
+
+layout (location = 0) out vec3 outColor;
+
+
+void main() {
+   outColor = vec3(inTexCoords, 0);
+   gl_Position = constants.mvp * vec4(inPos, 1.0);
+}
@@ -0,0 +1,72 @@
+#include "VertexPacking.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cfloat>
+
+namespace Pikzel::VertexPacking {
+
+   glm::vec2 OctahedralEncode(const glm::vec3& v) {
+      // project onto the octahedron |x| + |y| + |z| = 1, and then fold the lower hemisphere out over the diagonals
+      const glm::vec3 n = v / (glm::abs(v.x) + glm::abs(v.y) + glm::abs(v.z));
+      if (n.z >= 0.0f) {
+         return {n.x, n.y};
+      }
+      return {
+         (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+         (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f)
+      };
+   }
+
+
+   // Inverse of OctahedralEncode().  Shaders that read packed normals or tangents must decode them in the same way
+   glm::vec3 OctahedralDecode(const glm::vec2& e) {
+      glm::vec3 n = {e.x, e.y, 1.0f - glm::abs(e.x) - glm::abs(e.y)};
+      const float t = glm::max(-n.z, 0.0f);
+      n.x += n.x >= 0.0f ? -t : t;
+      n.y += n.y >= 0.0f ? -t : t;
+      return glm::normalize(n);
+   }
+
+
+   uint32_t PackUnitVector(const glm::vec3& v) {
+      if (glm::dot(v, v) == 0.0f) {
+         return glm::packSnorm2x16(glm::vec2 {0.0f, 0.0f});
+      }
+      return glm::packSnorm2x16(OctahedralEncode(v));
+   }
+
+
+   uint32_t PackUV(const glm::vec2& uv) {
+      return glm::packHalf2x16(uv);
+   }
+
+
+   glm::mat4 DequantizeTransform(const std::pair<glm::vec3, glm::vec3>& aabb) {
+      return glm::scale(glm::translate(glm::identity<glm::mat4>(), aabb.first), aabb.second - aabb.first);
+   }
+
+
+   std::vector<Mesh::PackedVertex> Pack(const std::vector<Mesh::Vertex>& vertices) {
+      std::vector<Mesh::PackedVertex> packed;
+      packed.reserve(vertices.size());
+      for (const auto& vertex : vertices) {
+         packed.emplace_back(vertex.Pos, PackUnitVector(vertex.Normal), PackUnitVector(vertex.Tangent), PackUV(vertex.UV));
+      }
+      return packed;
+   }
+
+
+   std::vector<Mesh::QuantizedVertex> Quantize(const std::vector<Mesh::Vertex>& vertices, const std::pair<glm::vec3, glm::vec3>& aabb) {
+      // guard against flat meshes (zero extent on some axis).  All positions quantize to 0 on that axis.
+      const glm::vec3 extent = glm::max(aabb.second - aabb.first, glm::vec3 {FLT_MIN});
+      std::vector<Mesh::QuantizedVertex> quantized;
+      quantized.reserve(vertices.size());
+      for (const auto& vertex : vertices) {
+         const glm::vec3 q = glm::round(glm::clamp((vertex.Pos - aabb.first) / extent, 0.0f, 1.0f) * 65535.0f);
+         quantized.emplace_back(glm::u16vec4 {q, 0.0f}, PackUnitVector(vertex.Normal), PackUnitVector(vertex.Tangent), PackUV(vertex.UV));
+      }
+      return quantized;
+   }
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Pikzel/Core/Core.h"
+#include "Pikzel/Scene/Mesh.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Conversion of Mesh::Vertex to the smaller vertex formats
+namespace Pikzel::VertexPacking {
+
+   // Octahedral encoding of a unit vector into two components in range [-1, 1]
+   PKZL_API glm::vec2 OctahedralEncode(const glm::vec3& v);
+   PKZL_API glm::vec3 OctahedralDecode(const glm::vec2& e);
+
+   // Unit vector, octahedral encoded and then packed as 2 x 16-bit snorm (x in the low 16 bits)
+   PKZL_API uint32_t PackUnitVector(const glm::vec3& v);
+
+   // 2 x half float (x in the low 16 bits)
+   PKZL_API uint32_t PackUV(const glm::vec2& uv);
+
+   // Transform from quantized position (each component in [0, 1]) back to a position within aabb
+   PKZL_API glm::mat4 DequantizeTransform(const std::pair<glm::vec3, glm::vec3>& aabb);
+
+   PKZL_API std::vector<Mesh::PackedVertex> Pack(const std::vector<Mesh::Vertex>& vertices);
+
+   // Positions are quantized within aabb, which must enclose all of the vertices
+   PKZL_API std::vector<Mesh::QuantizedVertex> Quantize(const std::vector<Mesh::Vertex>& vertices, const std::pair<glm::vec3, glm::vec3>& aabb);
+
+}
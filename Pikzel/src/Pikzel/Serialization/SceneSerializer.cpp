@@ -81,8 +81,11 @@ namespace Pikzel {
          auto path = node["Path"].as<std::string>();
          if (path != "<unknown>") {
             model.id = entt::hashed_string(path.data());
-            if (!AssetCache::GetModelAsset(model.id)) {
-               AssetCache::LoadModelAsset(path);
+            // Models are loaded in the background, so opening a scene does not wait for them.  Each object's model is
+            // drawn once it has been loaded.  (GetPath() is checked, rather than GetModelAsset(), to catch models that are
+            // already being loaded for some other object)
+            if (!AssetCache::GetPath(model.id)) {
+               AssetCache::LoadModelAssetAsync(path);
             }
          }
       }
@@ -0,0 +1,162 @@
+// Headless offline asset cooker.
+// Walks a directory tree and brings the cooked (runtime ready) file of every model and texture in it up to date.
+// Cooked files are written alongside their sources, and are then picked up automatically when the engine loads the source.
+// Sources whose cooked file is already up to date (by source content hash) are skipped.
+// Assets are cooked in parallel on the engine thread pool.
+// Does not need a window or a render core.
+//
+// Usage: pikzel-cook <asset directory> [-format full|packed|quantized] [-optimize none|vertexcache|full]
+//
+// Exit code is non-zero if any asset failed to cook.
+
+#include "Pikzel/Core/ThreadPool.h"
+#include "Pikzel/Renderer/Texture.h"
+#include "Pikzel/Scene/ModelAssetLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace Pikzel;
+
+
+enum class AssetType {
+   Model,
+   Texture
+};
+
+
+struct CookJob {
+   std::filesystem::path path;
+   AssetType type;
+   uintmax_t size;
+};
+
+
+// extensions that the engine imports via Assimp (models) or stb_image (textures).  .dds/.ktx textures are already GPU ready.
+const std::unordered_set<std::string> g_ModelExtensions = {".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".blend", ".ply", ".stl"};
+const std::unordered_set<std::string> g_TextureExtensions = {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif", ".hdr", ".pic", ".pnm"};
+
+
+std::vector<CookJob> FindAssets(const std::filesystem::path& root) {
+   std::vector<CookJob> jobs;
+   for (const auto& entry : std::filesystem::recursive_directory_iterator {root, std::filesystem::directory_options::skip_permission_denied}) {
+      if (!entry.is_regular_file()) {
+         continue;
+      }
+      std::string extension = entry.path().extension().string();
+      std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      if (g_ModelExtensions.contains(extension)) {
+         jobs.emplace_back(entry.path(), AssetType::Model, entry.file_size());
+      } else if (g_TextureExtensions.contains(extension)) {
+         jobs.emplace_back(entry.path(), AssetType::Texture, entry.file_size());
+      }
+   }
+
+   // biggest first, so that the long jobs are not left until last
+   std::sort(jobs.begin(), jobs.end(), [](const CookJob& a, const CookJob& b) { return a.size > b.size; });
+   return jobs;
+}
+
+
+void ShowUsage(const char* argv0) {
+   PKZL_LOG_INFO("Usage: {0} <asset directory> [options]", std::filesystem::path {argv0}.filename().string());
+   PKZL_LOG_INFO("\tOptions:");
+   PKZL_LOG_INFO("\t\t-h,--help\t\t\tShow this help message");
+   PKZL_LOG_INFO("\t\t-format [full | packed | quantized]\tVertex format to cook models in (default full)");
+   PKZL_LOG_INFO("\t\t-optimize [none | vertexcache | full]\tMesh optimization to cook models with (default full)");
+}
+
+
+int main(int argc, const char* argv[]) {
+   Log::Init(argc, argv);
+
+   std::filesystem::path root;
+   VertexFormat format = VertexFormat::Full;
+   MeshOptimization optimization = MeshOptimization::Full;
+   for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if ((arg == "-h") || (arg == "--help")) {
+         ShowUsage(argv[0]);
+         return EXIT_SUCCESS;
+      } else if (arg == "-format") {
+         const std::string value = (i + 1 < argc) ? argv[++i] : "";
+         if (value == "full") {
+            format = VertexFormat::Full;
+         } else if (value == "packed") {
+            format = VertexFormat::Packed;
+         } else if (value == "quantized") {
+            format = VertexFormat::Quantized;
+         } else {
+            PKZL_LOG_ERROR("Unknown vertex format '{}'", value);
+            ShowUsage(argv[0]);
+            return EXIT_FAILURE;
+         }
+      } else if (arg == "-optimize") {
+         const std::string value = (i + 1 < argc) ? argv[++i] : "";
+         if (value == "none") {
+            optimization = MeshOptimization::None;
+         } else if (value == "vertexcache") {
+            optimization = MeshOptimization::VertexCache;
+         } else if (value == "full") {
+            optimization = MeshOptimization::Full;
+         } else {
+            PKZL_LOG_ERROR("Unknown mesh optimization '{}'", value);
+            ShowUsage(argv[0]);
+            return EXIT_FAILURE;
+         }
+      } else if (root.empty()) {
+         root = arg;
+      } else {
+         PKZL_LOG_ERROR("Unexpected argument '{}'", arg);
+         ShowUsage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   if (root.empty() || !std::filesystem::is_directory(root)) {
+      PKZL_LOG_ERROR("Asset directory not specified, or is not a directory");
+      ShowUsage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   const auto startTime = std::chrono::steady_clock::now();
+   const std::vector<CookJob> jobs = FindAssets(root);
+   PKZL_LOG_INFO("Cooking {} assets in '{}' with {} worker threads", jobs.size(), root, ThreadPool::Get().GetThreadCount());
+
+   std::atomic<uint32_t> cooked = 0;
+   std::atomic<uint32_t> upToDate = 0;
+   std::atomic<uint32_t> failed = 0;
+   std::vector<std::future<void>> futures;
+   futures.reserve(jobs.size());
+   for (const auto& job : jobs) {
+      futures.emplace_back(ThreadPool::Get().Submit([&job, format, optimization, &cooked, &upToDate, &failed] {
+         try {
+            const bool wasCooked = (job.type == AssetType::Model) ? ModelAssetLoader::Cook(job.path, format, optimization) : TextureLoader::Cook(job.path);
+            if (wasCooked) {
+               PKZL_LOG_INFO("Cooked '{}'", job.path);
+               ++cooked;
+            } else {
+               ++upToDate;
+            }
+         } catch (const std::exception& err) {
+            PKZL_LOG_ERROR("Failed to cook '{}': {}", job.path, err.what());
+            ++failed;
+         }
+      }));
+   }
+   for (auto& future : futures) {
+      future.get();
+   }
+
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+   PKZL_LOG_INFO("{} cooked, {} up to date, {} failed, in {:.2f}s", cooked.load(), upToDate.load(), failed.load(), elapsed.count());
+   return (failed > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}